@@ -12,6 +12,8 @@ import 'src/regular_window.dart';
 import 'src/popup_window.dart';
 
 void main() {
+  // MultiViewApp applies the state create replies carry.
+  replyWithWindow = true;
   runWidget(ChangeNotifierProvider(
       create: (context) => AppModel(),
       child: MultiViewApp(
@@ -6,6 +6,19 @@ import 'flutter_view_positioner.dart';
 
 const channel = MethodChannel('flw/window');
 
+/// Whether windows created through this API are announced by the reply that
+/// creates them rather than by `onWindowCreated` and `onWindowResized` events,
+/// which saves two platform messages per window. Only set it when something,
+/// such as MultiViewApp, listens to [windowCreatedListeners]. Off by default.
+bool replyWithWindow = false;
+
+/// Called with the state of each window created through this API while
+/// [replyWithWindow] is set, carried by the reply that created it in the form
+/// of a [getWindowsSnapshot] entry plus its `sequence`. The runner sends no
+/// `onWindowCreated` or `onWindowResized` for these windows.
+final List<void Function(Map<String, Object?> window)> windowCreatedListeners =
+    [];
+
 enum FlutterViewArchetype {
   regular,
   floatingRegular,
@@ -15,29 +28,113 @@ enum FlutterViewArchetype {
   tip,
 }
 
-Future<FlutterView> createRegularWindow(Size size) async {
+/// Whether a window can be seen, or what hides it.
+enum FlutterViewVisibility {
+  visible,
+  minimized,
+  cloaked,
+  occluded,
+}
+
+/// Where a new top-level window goes on the monitor of the main window.
+enum WindowPlacement {
+  /// In free space if there is any, cascaded otherwise.
+  automatic,
+
+  /// Where it overlaps the fewest windows.
+  tile,
+
+  /// Offset from the last window placed.
+  cascade,
+
+  /// Centered on the main window.
+  centered,
+}
+
+/// Creates a top-level window of [size], titled [title] if given and placed
+/// as [placement] says.
+Future<FlutterView> createRegularWindow(Size size,
+    {String? title,
+    WindowPlacement placement = WindowPlacement.automatic}) async {
   int clampToZeroInt(double value) => value < 0 ? 0 : value.toInt();
   final int width = clampToZeroInt(size.width);
   final int height = clampToZeroInt(size.height);
-  final viewId = await channel
-      .invokeMethod('createRegularWindow', {'width': width, 'height': height});
-  return WidgetsBinding.instance.platformDispatcher.views.firstWhere(
-    (view) => view.viewId == viewId,
-    orElse: () {
-      throw Exception('No matching view found for viewId: $viewId');
-    },
-  );
+  return _viewFor(await channel.invokeMethod('createRegularWindow', {
+    'width': width,
+    'height': height,
+    if (title != null) 'title': title,
+    'placement': placement.index,
+    if (replyWithWindow) 'replyWithWindow': true,
+  }));
 }
 
 Future<FlutterView> createPopupWindow(FlutterView parent, Size size,
+    Rect anchorRect, FlutterViewPositioner positioner) {
+  return _createAnchoredWindow(
+      'createPopupWindow', parent, size, anchorRect, positioner);
+}
+
+/// A popup drawn within its parent view, at [rect] in the logical coordinates
+/// of [parent], rather than in a window of its own.
+class PopupOverlay {
+  const PopupOverlay(this.parent, this.rect);
+
+  final FlutterView parent;
+  final Rect rect;
+}
+
+/// Positions a popup like [createPopupWindow]. If the popup fits inside the
+/// client area of [parent], no window is created and a [PopupOverlay] is
+/// returned for the caller to draw within [parent]. Otherwise the popup gets
+/// its own window and its [FlutterView] is returned.
+Future<Object> createPopupWindowOrOverlay(FlutterView parent, Size size,
     Rect anchorRect, FlutterViewPositioner positioner) async {
+  final reply = await _invokeAnchoredWindow(
+      'createPopupWindow', parent, size, anchorRect, positioner,
+      allowOverlay: true);
+  if (reply is Map && reply['overlay'] is List) {
+    final rect = (reply['overlay'] as List).cast<int>();
+    return PopupOverlay(
+        parent,
+        Rect.fromLTWH(rect[0].toDouble(), rect[1].toDouble(),
+            rect[2].toDouble(), rect[3].toDouble()));
+  }
+  return _viewFor(reply);
+}
+
+/// Creates a tooltip window positioned like a popup. Tips never take
+/// activation or focus, so the popups of [parent] stay open, and hidden tips
+/// are reused rather than recreated.
+Future<FlutterView> createTipWindow(FlutterView parent, Size size,
+    Rect anchorRect, FlutterViewPositioner positioner) {
+  return _createAnchoredWindow(
+      'createTipWindow', parent, size, anchorRect, positioner);
+}
+
+/// Creates a tool window positioned like a popup that then keeps its offset
+/// from [parent] as [parent] moves.
+Future<FlutterView> createSatelliteWindow(FlutterView parent, Size size,
+    Rect anchorRect, FlutterViewPositioner positioner) {
+  return _createAnchoredWindow(
+      'createSatelliteWindow', parent, size, anchorRect, positioner);
+}
+
+Future<FlutterView> _createAnchoredWindow(String method, FlutterView parent,
+    Size size, Rect anchorRect, FlutterViewPositioner positioner) async {
+  return _viewFor(await _invokeAnchoredWindow(
+      method, parent, size, anchorRect, positioner));
+}
+
+Future<Object?> _invokeAnchoredWindow(String method, FlutterView parent,
+    Size size, Rect anchorRect, FlutterViewPositioner positioner,
+    {bool allowOverlay = false}) {
   int clampToZeroInt(double value) => value < 0 ? 0 : value.toInt();
   int constraintAdjustmentBitmask = 0;
   for (var adjustment in positioner.constraintAdjustment) {
     constraintAdjustmentBitmask |= 1 << adjustment.index;
   }
 
-  final viewId = await channel.invokeMethod('createPopupWindow', {
+  return channel.invokeMethod(method, {
     'parent': parent.viewId,
     'size': [clampToZeroInt(size.width), clampToZeroInt(size.height)],
     'anchorRect': [
@@ -52,8 +149,23 @@ Future<FlutterView> createPopupWindow(FlutterView parent, Size size,
       positioner.offset.dx.toInt(),
       positioner.offset.dy.toInt()
     ],
-    'positionerConstraintAdjustment': constraintAdjustmentBitmask
+    'positionerConstraintAdjustment': constraintAdjustmentBitmask,
+    if (allowOverlay) 'allowOverlay': true,
+    if (replyWithWindow) 'replyWithWindow': true,
   });
+}
+
+// Returns the view of the window a create call replied with, either its view
+// ID or its state, which is passed on to windowCreatedListeners.
+FlutterView _viewFor(Object? reply) {
+  Object? viewId = reply;
+  if (reply is Map) {
+    final Map<String, Object?> window = Map<String, Object?>.from(reply);
+    for (final listener in List.of(windowCreatedListeners)) {
+      listener(window);
+    }
+    viewId = window['viewId'];
+  }
   return WidgetsBinding.instance.platformDispatcher.views.firstWhere(
     (view) => view.viewId == viewId,
     orElse: () {
@@ -65,3 +177,89 @@ Future<FlutterView> createPopupWindow(FlutterView parent, Size size,
 void destroyWindow(FlutterView window) {
   channel.invokeMethod('destroyWindow', [window.viewId]);
 }
+
+/// Returns the runner's window message latency histograms, one entry per
+/// archetype, message and dispatch phase. Clears them afterwards if [reset].
+///
+/// The `surfaceResize` phase counts the resizes of the Flutter surfaces and
+/// the `resizeFrame` phase times the first frame rendered after each of them.
+/// The `show` and `hide` phases time showing and hiding pooled tips. Resetting
+/// also clears the counts returned by [getSatelliteTrail].
+Future<List<Map<String, Object?>>> getStats({bool reset = false}) async {
+  final List<Object?>? stats =
+      await channel.invokeMethod('getStats', {'reset': reset});
+  return [
+    for (final entry in stats ?? const [])
+      Map<String, Object?>.from(entry as Map)
+  ];
+}
+
+/// Returns how closely satellites follow their parents. Every move of a window
+/// with satellites adds one of the `samples` per satellite; `trailingSamples`
+/// counts those in which the satellite was out of place, and
+/// `maxTrailingMoves` is the longest run of consecutive parent moves a
+/// satellite trailed.
+Future<Map<String, Object?>> getSatelliteTrail() async {
+  final Map<Object?, Object?>? trail =
+      await channel.invokeMethod('getSatelliteTrail');
+  return Map<String, Object?>.from(trail ?? const {});
+}
+
+/// Configures how windows follow interactive resizes. When [enabled], the
+/// Flutter surface of a window being resized is resized at most once every
+/// [intervalMs] milliseconds and, if [bucket] is non-zero, to sizes rounded up
+/// to a multiple of [bucket] physical pixels. The surface always gets the exact
+/// window size once the resize ends.
+Future<void> configureLiveResize(
+    {required bool enabled, int intervalMs = 0, int bucket = 0}) async {
+  await channel.invokeMethod('configureLiveResize',
+      {'enabled': enabled, 'intervalMs': intervalMs, 'bucket': bucket});
+}
+
+/// Returns the memory charged to each window: `runnerBytes` and
+/// `runnerAllocations` count the live native allocations the runner made for
+/// it, and `surfaceBytes` estimates its Flutter surface. Allocations are only
+/// counted in runners built with `FLW_ENABLE_ALLOCATION_ACCOUNTING`.
+Future<List<Map<String, Object?>>> getMemoryStats() async {
+  final List<Object?>? stats = await channel.invokeMethod('getMemoryStats');
+  return [
+    for (final entry in stats ?? const [])
+      Map<String, Object?>.from(entry as Map)
+  ];
+}
+
+/// Sets how many bytes the windows may be charged in total. Past the budget,
+/// hidden popups are destroyed, least recently visible first. A budget of 0
+/// disables reclamation.
+Future<void> setMemoryBudget(int bytes) async {
+  await channel.invokeMethod('setMemoryBudget', {'bytes': bytes});
+}
+
+/// Creates the views of the windows the runner created with their view
+/// deferred, such as windows restored in the background, and returns their
+/// view IDs. They are announced with `onWindowCreated` like any other window.
+Future<List<int>> realizeWindows() async {
+  final List<Object?>? viewIds = await channel.invokeMethod('realizeWindows');
+  return [for (final viewId in viewIds ?? const []) viewId as int];
+}
+
+/// Returns every window of this engine the runner has announced, as maps with
+/// its `viewId`, `archetype`, `parentViewId`, logical frame (`x`, `y`, `width`
+/// and `height`), `devicePixelRatio` and `visibility`.
+///
+/// The runner numbers the events it sends, in their `sequence` argument. The
+/// snapshot reflects every event numbered up to its `sequence` and none after,
+/// so after a hot restart, or when handlers attach late, events up to it can
+/// be dropped.
+Future<({int sequence, List<Map<String, Object?>> windows})>
+    getWindowsSnapshot() async {
+  final Map<Object?, Object?> snapshot =
+      await channel.invokeMethod('getWindowsSnapshot');
+  return (
+    sequence: snapshot['sequence'] as int,
+    windows: [
+      for (final entry in snapshot['windows'] as List<Object?>)
+        Map<String, Object?>.from(entry as Map)
+    ],
+  );
+}
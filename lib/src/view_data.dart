@@ -9,7 +9,9 @@ class ViewData {
   FlutterViewArchetype? archetype;
   FlutterView? parentView;
   Size? size;
+  double? devicePixelRatio;
+  FlutterViewVisibility visibility = FlutterViewVisibility.visible;
 
   ViewData(this.view, this.widget,
-      [this.archetype, this.parentView, this.size]);
+      [this.archetype, this.parentView, this.size, this.devicePixelRatio]);
 }
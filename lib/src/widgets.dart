@@ -30,13 +30,26 @@ class _MultiViewAppState extends State<MultiViewApp>
 
   Map<int, ViewData> _views = <int, ViewData>{};
 
+  // The sequence number of the last snapshot or create reply. The events
+  // numbered up to it are already reflected in _views, and dropped.
+  int _sequence = 0;
+
+  // The events received while a snapshot is requested, handled once it is in.
+  List<MethodCall>? _pendingCalls;
+
+  // The state of windows whose view is not in _views yet.
+  final Map<int, Map<String, Object?>> _pendingWindows = {};
+
   @override
   void initState() {
     super.initState();
     WidgetsBinding.instance.addObserver(this);
     log('setMethodCallHandler');
     channel.setMethodCallHandler(_methodCallHandler);
+    windowCreatedListeners.add(_onWindowCreatedReply);
     _updateViews();
+    // After a hot restart, the windows were announced to the previous isolate.
+    _resync();
   }
 
   @override
@@ -61,12 +74,91 @@ class _MultiViewAppState extends State<MultiViewApp>
           ViewData(view, Builder(builder: widget.viewBuilder));
       newViews[view.viewId] = viewData;
     }
+    for (final int viewId in _pendingWindows.keys.toList()) {
+      if (newViews.containsKey(viewId)) {
+        _applyWindow(newViews, _pendingWindows.remove(viewId)!);
+      }
+    }
     setState(() {
       _views = newViews;
     });
   }
 
+  // Rebuilds _views from a snapshot of the runner's windows. The events received
+  // meanwhile are held back, then handled unless the snapshot reflects them.
+  Future<void> _resync() async {
+    _pendingCalls = <MethodCall>[];
+    try {
+      final snapshot = await getWindowsSnapshot();
+      if (mounted) {
+        _applySnapshot(snapshot.sequence, snapshot.windows);
+      }
+    } finally {
+      final List<MethodCall> pendingCalls = _pendingCalls!;
+      _pendingCalls = null;
+      for (final MethodCall call in pendingCalls) {
+        await _methodCallHandler(call);
+      }
+    }
+  }
+
+  void _applySnapshot(int sequence, List<Map<String, Object?>> windows) {
+    log('applySnapshot - # of windows: ${windows.length} - [sequence: $sequence]');
+
+    setState(() {
+      for (final Map<String, Object?> window in windows) {
+        _applyWindow(_views, window);
+      }
+      _sequence = sequence;
+    });
+  }
+
+  // Stands in for the onWindowCreated and onWindowResized of a window created
+  // through the windowing API. The reply is current as of its sequence, so the
+  // events numbered up to it are dropped like those a snapshot reflects. Among
+  // them is the onWindowDestroyed of a reused tip's previous use.
+  void _onWindowCreatedReply(Map<String, Object?> window) {
+    final int? sequence = window['sequence'] as int?;
+    log('onWindowCreatedReply - [id: ${window['viewId']}] - [sequence: $sequence]');
+    setState(() {
+      _applyWindow(_views, window);
+      if (sequence != null && sequence > _sequence) {
+        _sequence = sequence;
+      }
+    });
+  }
+
+  // Applies the state of a window, as in a snapshot, to its entry in |views|,
+  // or keeps it for when its view is added.
+  void _applyWindow(Map<int, ViewData> views, Map<String, Object?> window) {
+    final int viewId = window['viewId'] as int;
+    final ViewData? viewData = views[viewId];
+    if (viewData == null) {
+      _pendingWindows[viewId] = window;
+      return;
+    }
+    final int? parentViewId = window['parentViewId'] as int?;
+    viewData.archetype =
+        FlutterViewArchetype.values[window['archetype'] as int];
+    viewData.parentView =
+        parentViewId != null ? views[parentViewId]?.view : null;
+    viewData.size = Size((window['width'] as int).toDouble(),
+        (window['height'] as int).toDouble());
+    viewData.devicePixelRatio = window['devicePixelRatio'] as double;
+    viewData.visibility =
+        FlutterViewVisibility.values[window['visibility'] as int];
+  }
+
   Future<void> _methodCallHandler(MethodCall call) async {
+    if (_pendingCalls != null) {
+      _pendingCalls!.add(call);
+      return;
+    }
+    final int? sequence = call.arguments['sequence'];
+    if (sequence != null && sequence <= _sequence) {
+      log('${call.method} - [sequence: $sequence] - stale, dropped');
+      return;
+    }
     switch (call.method) {
       case 'onWindowCreated':
         final int viewId = call.arguments['viewId'];
@@ -88,18 +180,34 @@ class _MultiViewAppState extends State<MultiViewApp>
       case 'onWindowDestroyed':
         final int viewId = call.arguments['viewId'];
         log('onWindowDestroyed - [id: $viewId] - [${_views[viewId]?.archetype}] - [parent: ${_views[viewId]?.parentView}]');
+        _pendingWindows.remove(viewId);
         break;
       case 'onWindowResized':
         final int viewId = call.arguments['viewId'];
         final int width = call.arguments['width'];
         final int height = call.arguments['height'];
+        final double? devicePixelRatio = call.arguments['devicePixelRatio'];
         final Size size = Size(width.toDouble(), height.toDouble());
-        log('onWindowResized - [id: $viewId] - [size: (${size.width}, ${size.height})]');
+        log('onWindowResized - [id: $viewId] - [size: (${size.width}, ${size.height})] - [dpr: $devicePixelRatio]');
 
         setState(() {
           ViewData? viewData = _views[viewId];
           if (viewData != null) {
             viewData.size = size;
+            viewData.devicePixelRatio = devicePixelRatio;
+          }
+        });
+        break;
+      case 'onWindowVisibilityChanged':
+        final int viewId = call.arguments['viewId'];
+        final FlutterViewVisibility visibility =
+            FlutterViewVisibility.values[call.arguments['visibility']];
+        log('onWindowVisibilityChanged - [id: $viewId] - [$visibility]');
+
+        setState(() {
+          ViewData? viewData = _views[viewId];
+          if (viewData != null) {
+            viewData.visibility = visibility;
           }
         });
     }
@@ -107,6 +215,7 @@ class _MultiViewAppState extends State<MultiViewApp>
 
   @override
   void dispose() {
+    windowCreatedListeners.remove(_onWindowCreatedReply);
     WidgetsBinding.instance.removeObserver(this);
     super.dispose();
   }
@@ -0,0 +1,65 @@
+#ifndef RUNNER_EVENT_QUEUE_H_
+#define RUNNER_EVENT_QUEUE_H_
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace flw {
+
+// Unbounded lock-free queue with any number of producers and one consumer.
+//
+// Push links a node with a single atomic exchange and never waits, so
+// producers never block each other or the consumer. Pop may only be called by
+// one thread at a time. A Push that has not finished linking its node is not
+// yet visible to Pop; it becomes visible once Push returns.
+template <typename T> class MpscQueue {
+public:
+  MpscQueue() = default;
+  ~MpscQueue() {
+    while (Pop()) {
+    }
+    if (tail_ != &stub_) {
+      delete tail_;
+    }
+  }
+
+  MpscQueue(MpscQueue const &) = delete;
+  MpscQueue &operator=(MpscQueue const &) = delete;
+
+  void Push(T value) {
+    auto *const node{new Node{.value = std::move(value)}};
+    auto *const prev{head_.exchange(node, std::memory_order_acq_rel)};
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  auto Pop() -> std::optional<T> {
+    auto *const tail{tail_};
+    auto *const next{tail->next.load(std::memory_order_acquire)};
+    if (!next) {
+      return std::nullopt;
+    }
+    // |next| becomes the new stub; its value is moved out.
+    tail_ = next;
+    if (tail != &stub_) {
+      delete tail;
+    }
+    return std::move(next->value);
+  }
+
+private:
+  struct Node {
+    std::atomic<Node *> next{nullptr};
+    T value{};
+  };
+
+  Node stub_;
+  // The last pushed node, exchanged by producers.
+  std::atomic<Node *> head_{&stub_};
+  // The last popped node, owned by the consumer.
+  Node *tail_{&stub_};
+};
+
+} // namespace flw
+
+#endif // RUNNER_EVENT_QUEUE_H_
@@ -0,0 +1,71 @@
+#include "flutter_engine_host.h"
+
+#include <utility>
+
+void FlutterEngineHost::AddNextFrameCallback(std::function<void()> callback) {
+  next_frame_callbacks_.push_back(std::move(callback));
+  if (next_frame_callbacks_.size() > 1) {
+    // The engine already calls back for the pending ones.
+    return;
+  }
+  SetNextFrameCallback([this] {
+    for (auto const &callback : std::exchange(next_frame_callbacks_, {})) {
+      callback();
+    }
+  });
+}
+
+#if defined(_WIN32)
+
+namespace {
+
+class DesktopFlutterViewHost : public FlutterViewHost {
+public:
+  DesktopFlutterViewHost(int width, int height,
+                         std::shared_ptr<flutter::FlutterEngine> engine)
+      : controller_(width, height, std::move(engine)),
+        view_id_(controller_.view_id()) {}
+
+  auto view_id() const -> flutter::FlutterViewId override { return view_id_; }
+
+  auto GetNativeWindow() -> HWND override {
+    return controller_.view() ? controller_.view()->GetNativeWindow()
+                              : nullptr;
+  }
+
+  auto HandleTopLevelWindowProc(HWND hwnd, UINT message, WPARAM wparam,
+                                LPARAM lparam)
+      -> std::optional<LRESULT> override {
+    return controller_.HandleTopLevelWindowProc(hwnd, message, wparam, lparam);
+  }
+
+private:
+  flutter::FlutterViewController controller_;
+  flutter::FlutterViewId const view_id_;
+};
+
+} // namespace
+
+DesktopFlutterEngineHost::DesktopFlutterEngineHost(
+    std::shared_ptr<flutter::FlutterEngine> engine)
+    : engine_(std::move(engine)) {}
+
+auto DesktopFlutterEngineHost::CreateView(int width, int height)
+    -> std::unique_ptr<FlutterViewHost> {
+  return std::make_unique<DesktopFlutterViewHost>(width, height, engine_);
+}
+
+auto DesktopFlutterEngineHost::messenger() -> flutter::BinaryMessenger * {
+  return engine_->messenger();
+}
+
+void DesktopFlutterEngineHost::ReloadSystemFonts() {
+  engine_->ReloadSystemFonts();
+}
+
+void DesktopFlutterEngineHost::SetNextFrameCallback(
+    std::function<void()> callback) {
+  engine_->SetNextFrameCallback(std::move(callback));
+}
+
+#endif // defined(_WIN32)
@@ -0,0 +1,123 @@
+#ifndef RUNNER_FLUTTER_ENGINE_HOST_H_
+#define RUNNER_FLUTTER_ENGINE_HOST_H_
+
+#include <flutter/binary_messenger.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "platform_window_types.h"
+
+#if defined(_WIN32)
+#include <flutter/flutter_engine.h>
+#include <flutter/flutter_view_controller.h>
+#else
+namespace flutter {
+// Matches the definition in flutter/flutter_view.h, which is Windows-only.
+typedef int64_t FlutterViewId;
+} // namespace flutter
+#endif
+
+// Identifies one of the engines the runner hosts, in the order they were added
+// to FlutterWindowManager. Engine 0 is the first one.
+using EngineId = uint32_t;
+
+// The runner identifies windows across engines by a window ID holding the
+// engine in its high bits and the view ID the engine assigned in its low bits.
+// The views of engine 0 keep their view IDs as window IDs. Dart only ever sees
+// the view IDs of its own engine.
+inline constexpr int kEngineIdShift{48};
+
+constexpr auto WindowIdFor(EngineId engine, flutter::FlutterViewId view_id)
+    -> flutter::FlutterViewId {
+  return (static_cast<flutter::FlutterViewId>(engine) << kEngineIdShift) |
+         view_id;
+}
+
+constexpr auto EngineIdOf(flutter::FlutterViewId window_id) -> EngineId {
+  return static_cast<EngineId>(window_id >> kEngineIdShift);
+}
+
+// Engines number their views from 0 up, so view IDs from this bit up are free
+// for the windows whose view is not created yet, see ViewCreation.
+inline constexpr int kDeferredViewIdShift{40};
+
+constexpr auto ViewIdOf(flutter::FlutterViewId window_id)
+    -> flutter::FlutterViewId {
+  return window_id &
+         ((static_cast<flutter::FlutterViewId>(1) << kEngineIdShift) - 1);
+}
+
+// A Flutter view hosted by a FlutterWindow.
+class FlutterViewHost {
+public:
+  virtual ~FlutterViewHost() = default;
+
+  virtual auto view_id() const -> flutter::FlutterViewId = 0;
+
+  // Returns the native window the view renders into, or nullptr if the view
+  // could not be set up.
+  virtual auto GetNativeWindow() -> HWND = 0;
+
+  // Gives Flutter, including plugins, an opportunity to handle a message sent
+  // to the top-level window hosting the view.
+  virtual auto HandleTopLevelWindowProc(HWND hwnd, UINT message, WPARAM wparam,
+                                        LPARAM lparam)
+      -> std::optional<LRESULT> = 0;
+};
+
+// The Flutter engine FlutterWindows render through, abstracted so that the
+// window manager can run against a fake engine in headless builds.
+class FlutterEngineHost {
+public:
+  virtual ~FlutterEngineHost() = default;
+
+  // Creates a view of |width| x |height| physical pixels.
+  virtual auto CreateView(int width, int height)
+      -> std::unique_ptr<FlutterViewHost> = 0;
+
+  virtual auto messenger() -> flutter::BinaryMessenger * = 0;
+
+  virtual void ReloadSystemFonts() = 0;
+
+  // Calls |callback| once the engine has rendered its next frame, along with
+  // the other callbacks added since the last frame.
+  void AddNextFrameCallback(std::function<void()> callback);
+
+protected:
+  // Sets the engine's next-frame callback, replacing any pending one. Only
+  // AddNextFrameCallback calls it, so that callbacks never replace each other.
+  virtual void SetNextFrameCallback(std::function<void()> callback) = 0;
+
+private:
+  std::vector<std::function<void()>> next_frame_callbacks_;
+};
+
+#if defined(_WIN32)
+
+// FlutterEngineHost backed by a flutter::FlutterEngine; its views are
+// flutter::FlutterViewControllers.
+class DesktopFlutterEngineHost : public FlutterEngineHost {
+public:
+  explicit DesktopFlutterEngineHost(
+      std::shared_ptr<flutter::FlutterEngine> engine);
+
+  // FlutterEngineHost:
+  auto CreateView(int width, int height)
+      -> std::unique_ptr<FlutterViewHost> override;
+  auto messenger() -> flutter::BinaryMessenger * override;
+  void ReloadSystemFonts() override;
+
+protected:
+  void SetNextFrameCallback(std::function<void()> callback) override;
+
+private:
+  std::shared_ptr<flutter::FlutterEngine> engine_;
+};
+
+#endif // defined(_WIN32)
+
+#endif // RUNNER_FLUTTER_ENGINE_HOST_H_
@@ -6,35 +6,100 @@
 
 #include <flutter/encodable_value.h>
 
-#include <windows.h>
-
 #include "flutter_window_manager.h"
+#include "message_stats.h"
+#include "trace_event.h"
+
+namespace {
+
+// The next placeholder view ID of a deferred view.
+flutter::FlutterViewId g_next_deferred_id{flutter::FlutterViewId{1}
+                                          << kDeferredViewIdShift};
+
+} // namespace
+
+FlutterWindow::FlutterWindow(std::shared_ptr<FlutterEngineHost> engine,
+                             EngineId engine_id, ViewCreation view_creation,
+                             FlutterWindow *parent)
+    : engine_(std::move(engine)), engine_id_(engine_id), parent_(parent) {
+  SetMessageFilter(&FilterMessage);
+  if (view_creation == ViewCreation::deferred) {
+    deferred_id_ = g_next_deferred_id++;
+  }
+}
 
-FlutterWindow::FlutterWindow(std::shared_ptr<flutter::FlutterEngine> engine)
-    : engine_(std::move(engine)) {}
+FlutterWindow::~FlutterWindow() {
+  // ~Win32Window destroys the native window, whose last messages must not
+  // reach the members destroyed by now.
+  SetMessageFilter(nullptr);
+}
 
-auto FlutterWindow::flutter_controller()
-    -> std::unique_ptr<flutter::FlutterViewController> const & {
-  return flutter_controller_;
+auto FlutterWindow::flutter_view() -> std::unique_ptr<FlutterViewHost> const & {
+  return flutter_view_;
 }
 
 bool FlutterWindow::OnCreate() {
   if (!Win32Window::OnCreate()) {
     return false;
   }
+  created_ = true;
+  if (deferred()) {
+    ProbeVisibility();
+    return true;
+  }
+  return CreateView();
+}
+
+auto FlutterWindow::CreateDeferredView() -> bool {
+  if (!deferred()) {
+    return flutter_view_ != nullptr;
+  }
+  deferred_id_.reset();
+  if (!CreateView()) {
+    // Leave the window closed rather than half set up.
+    flutter_view_ = nullptr;
+    return false;
+  }
+  return true;
+}
 
+auto FlutterWindow::CreateView() -> bool {
   RECT const frame = GetClientArea();
 
   // The size here must match the window dimensions to avoid unnecessary surface
   // creation / destruction in the startup path.
-  flutter_controller_ = std::make_unique<flutter::FlutterViewController>(
-      frame.right - frame.left, frame.bottom - frame.top, engine_);
+  FLW_TRACE_SCOPE_NAMED(create_controller, "FlutterViewController");
+  {
+    // The view and its surface live exactly as long as this window.
+    flw::memory::ScopedAllocationOwner const allocation_owner(
+        memory_counters());
+    flutter_view_ = engine_->CreateView(frame.right - frame.left,
+                                        frame.bottom - frame.top);
+  }
+  FLW_TRACE_SCOPE_END(create_controller);
   // Ensure that basic setup of the controller was successful.
-  if (!flutter_controller_->view()) {
+  if (!flutter_view_->GetNativeWindow()) {
     return false;
   }
 
-  SetChildContent(flutter_controller_->view()->GetNativeWindow());
+#if defined(FLW_ENABLE_TRACING)
+  auto const view_id{window_id()};
+  auto const track{flw::trace::ViewTrack(view_id)};
+  FLW_TRACE_NAME_TRACK(track, "view " + std::to_string(view_id));
+  FLW_TRACE_FLOW_STEP(track);
+  // Closes the flow of the request that created this view on its first frame.
+  engine_->AddNextFrameCallback(
+      [track, flow = flw::trace::TraceLog::CurrentFlow()]() {
+        flw::trace::TraceScope const first_frame("first frame", track);
+        flw::trace::TraceLog::instance().EndFlow(flow, track);
+      });
+#endif
+
+  {
+    FLW_TRACE_SCOPE_ON("SetChildContent",
+                       FLW_TRACE_VIEW_TRACK(window_id()));
+    SetChildContent(flutter_view_->GetNativeWindow());
+  }
 
   // TODO(loicsharma): Hide the window until the first frame is rendered.
   // Single window apps use the engine's next frame callback to show the window.
@@ -45,43 +110,81 @@ bool FlutterWindow::OnCreate() {
 }
 
 void FlutterWindow::OnDestroy() {
-  if (flutter_controller_) {
-    FlutterWindowManager::instance().destroyWindow(
-        flutter_controller_->view_id(), false);
-    if (flutter_controller_) {
-      flutter_controller_ = nullptr;
+  // Dart never learnt of a window destroyed before its view was created. The
+  // handle is already cleared when the system closes the window, so it cannot
+  // tell this apart from the Destroy at the start of Create.
+  if (created_) {
+    deferred_id_.reset();
+  }
+  if (flutter_view_) {
+    FlutterWindowManager::instance().destroyWindow(window_id(), false);
+    if (flutter_view_) {
+      flutter_view_ = nullptr;
     }
   }
 
   Win32Window::OnDestroy();
 }
 
-LRESULT
-FlutterWindow::MessageHandler(HWND hwnd, UINT const message,
-                              WPARAM const wparam, LPARAM const lparam) {
-  // Give Flutter, including plugins, an opportunity to handle window messages.
-  if (flutter_controller_) {
-    std::optional<LRESULT> result =
-        flutter_controller_->HandleTopLevelWindowProc(hwnd, message, wparam,
-                                                      lparam);
-    if (result) {
-      return *result;
+void FlutterWindow::OnContentResized() {
+  if (!flutter_view_) {
+    return;
+  }
+  FlutterWindowManager::instance().sendOnWindowResized(window_id());
+  FlutterWindowManager::instance().flushEvents();
+
+  // Measure how long the engine takes to render at the new size, from the
+  // first of the resizes the next frame catches up with.
+  if (*resize_frame_pending_) {
+    return;
+  }
+  *resize_frame_pending_ = true;
+  engine_->AddNextFrameCallback([archetype = static_cast<int>(archetype_),
+                                 pending = resize_frame_pending_,
+                                 start = std::chrono::steady_clock::now()]() {
+    *pending = false;
+    MessageStats::instance().Record(
+        {.archetype = archetype,
+         .message = WM_SIZE,
+         .phase = MessageStats::Phase::resize_frame},
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count()));
+  });
+}
+
+void FlutterWindow::OnVisibilityChanged(flw::Visibility visibility) {
+  if (deferred() && visibility == flw::Visibility::visible) {
+    FlutterWindowManager::instance().realizeWindow(window_id());
+  } else if (flutter_view_) {
+    FlutterWindowManager::instance().sendOnWindowVisibilityChanged(
+        window_id(), visibility);
+    FlutterWindowManager::instance().flushEvents();
+    if (visibility != flw::Visibility::visible) {
+      FlutterWindowManager::instance().enforceMemoryBudget(window_id());
     }
   }
+}
 
-  switch (message) {
-  case WM_FONTCHANGE:
-    engine_->ReloadSystemFonts();
-    break;
-  case WM_SIZE:
-    if (flutter_controller_) {
-      FlutterWindowManager::instance().sendOnWindowResized(
-          flutter_controller_->view_id());
+// static
+auto FlutterWindow::FilterMessage(Win32Window &window, HWND hwnd,
+                                  UINT const message, WPARAM const wparam,
+                                  LPARAM const lparam)
+    -> std::optional<LRESULT> {
+  auto &self{static_cast<FlutterWindow &>(window)};
+  // Give Flutter, including plugins, an opportunity to handle window messages.
+  if (self.flutter_view_) {
+    ScopedMessageTimer const timer(static_cast<int>(self.archetype_), message,
+                                   MessageStats::Phase::plugin);
+    if (auto const result{self.flutter_view_->HandleTopLevelWindowProc(
+            hwnd, message, wparam, lparam)}) {
+      return result;
     }
-    break;
-  default:
-    break;
   }
 
-  return Win32Window::MessageHandler(hwnd, message, wparam, lparam);
+  if (message == WM_FONTCHANGE) {
+    self.engine_->ReloadSystemFonts();
+  }
+  return std::nullopt;
 }
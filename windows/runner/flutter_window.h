@@ -5,32 +5,93 @@
 #ifndef RUNNER_FLUTTER_WINDOW_H_
 #define RUNNER_FLUTTER_WINDOW_H_
 
-#include <flutter/flutter_view_controller.h>
+#include <memory>
+#include <optional>
+
+#include "flutter_engine_host.h"
 
 #include "win32_window.h"
 
+// When a FlutterWindow creates its Flutter view.
+enum class ViewCreation {
+  // As the window is created.
+  immediate,
+  // Once the window is first found visible, or realized by
+  // FlutterWindowManager::realizeWindow. Until then the window has no view and
+  // Dart does not know of it.
+  deferred,
+};
+
 // A window that does nothing but host a Flutter view.
 class FlutterWindow : public Win32Window {
 public:
-  // Creates a new FlutterWindow hosting a Flutter view running |engine|.
-  explicit FlutterWindow(std::shared_ptr<flutter::FlutterEngine> engine);
-  virtual ~FlutterWindow() = default;
+  // Creates a new FlutterWindow hosting a Flutter view running |engine|, the
+  // engine |engine_id| of FlutterWindowManager, created as |view_creation|
+  // says. |parent| is the window that owns this one, if any.
+  FlutterWindow(std::shared_ptr<FlutterEngineHost> engine, EngineId engine_id,
+                ViewCreation view_creation = ViewCreation::immediate,
+                FlutterWindow *parent = nullptr);
+  virtual ~FlutterWindow();
+
+  auto flutter_view() -> std::unique_ptr<FlutterViewHost> const &;
+
+  auto engine_id() const -> EngineId { return engine_id_; }
+  auto parent() const -> FlutterWindow * { return parent_; }
+
+  // Returns whether the view is deferred and not created yet.
+  auto deferred() const -> bool { return deferred_id_.has_value(); }
+  // Returns whether the window is destroyed.
+  auto closed() const -> bool { return !flutter_view_ && !deferred(); }
+
+  // Returns the ID of the window among all engines. While the view is
+  // deferred, this is a placeholder that changes once the view is created.
+  // Must not be called once the window is closed.
+  auto window_id() const -> flutter::FlutterViewId {
+    return WindowIdFor(engine_id_, deferred_id_ ? *deferred_id_
+                                                : flutter_view_->view_id());
+  }
 
-  auto flutter_controller() -> std::unique_ptr<flutter::FlutterViewController> const&;
+  // Creates the deferred view. Returns false if it could not be set up.
+  auto CreateDeferredView() -> bool;
 
 protected:
   // Win32Window:
   bool OnCreate() override;
   void OnDestroy() override;
-  LRESULT MessageHandler(HWND hwnd, UINT const message, WPARAM const wparam,
-                         LPARAM const lparam) override;
+  void OnContentResized() override;
+  void OnVisibilityChanged(flw::Visibility visibility) override;
 
 private:
+  // The message filter of every FlutterWindow, which offers each message to the
+  // view's plugins first.
+  static auto FilterMessage(Win32Window &window, HWND hwnd, UINT message,
+                            WPARAM wparam, LPARAM lparam)
+      -> std::optional<LRESULT>;
+
+  // Creates the view and inserts it into the window.
+  auto CreateView() -> bool;
+
   // The engine this window is attached to.
-  std::shared_ptr<flutter::FlutterEngine> engine_;
+  std::shared_ptr<FlutterEngineHost> engine_;
+  EngineId const engine_id_;
+
+  // The window that owns this one, kept to announce it first to Dart.
+  FlutterWindow *const parent_;
+
+  // The placeholder view ID while the view is deferred.
+  std::optional<flutter::FlutterViewId> deferred_id_;
+
+  // Whether OnCreate has run. Create destroys the window before creating it,
+  // which must not end the deferral of a window not created yet.
+  bool created_ = false;
+
+  // Whether the time to the next frame after a resize is being measured.
+  // Shared with the engine's next-frame callback, which may outlive the
+  // window.
+  std::shared_ptr<bool> resize_frame_pending_{std::make_shared<bool>(false)};
 
-  // The Flutter instance hosted by this window.
-  std::unique_ptr<flutter::FlutterViewController> flutter_controller_;
+  // The Flutter view hosted by this window.
+  std::unique_ptr<FlutterViewHost> flutter_view_;
 };
 
 #endif // RUNNER_FLUTTER_WINDOW_H_
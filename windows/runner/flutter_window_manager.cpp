@@ -3,51 +3,86 @@
 #include <flutter/encodable_value.h>
 #include <flutter/standard_method_codec.h>
 
-#include <dwmapi.h>
+#include "debug.h"
+#include "message_replay.h"
+#include "message_stats.h"
+#include "text_encoding.h"
+#include "trace_event.h"
+#include "window_backend.h"
+#include "window_layout.h"
+#include "window_placement.h"
 
 #include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+#include <utility>
 
 namespace {
 auto *const CHANNEL{"flw/window"};
-auto const base_dpi{96.0};
+
+// The number of hidden tips kept for reuse.
+constexpr size_t kTipPoolCapacity{4};
+
+// Returns the frame of |geometry| in logical pixels.
+auto logicalFrame(Win32Window::Geometry const &geometry) -> RECT {
+  auto const dpr{geometry.device_pixel_ratio()};
+  auto const &frame{geometry.extended_frame};
+  return {static_cast<LONG>(frame.left / dpr),
+          static_cast<LONG>(frame.top / dpr),
+          static_cast<LONG>(frame.right / dpr),
+          static_cast<LONG>(frame.bottom / dpr)};
+}
+
+// Encodes the parent of a window as Dart knows it: the view ID of the parent,
+// -1 for an owned window without one, or null for a regular window.
+auto encodeParentViewId(std::optional<flutter::FlutterViewId> parent_view_id)
+    -> flutter::EncodableValue {
+  if (!parent_view_id) {
+    return flutter::EncodableValue();
+  }
+  return flutter::EncodableValue(*parent_view_id < 0
+                                     ? *parent_view_id
+                                     : ViewIdOf(*parent_view_id));
+}
 
 // Returns the origin point that will center a window of size 'size' within the
-// client area of the window identified by 'handle'.
+// frame of 'window'.
 auto calculateCenteredOrigin(Win32Window::Size size,
-                             HWND handle) -> Win32Window::Point {
-  if (RECT frame; handle && GetWindowRect(handle, &frame)) {
-    POINT const target_point{frame.left, frame.top};
-    auto *const monitor{
-        MonitorFromPoint(target_point, MONITOR_DEFAULTTONEAREST)};
-    auto const dpr{FlutterDesktopGetDpiForMonitor(monitor) / base_dpi};
-    auto const centered_x{(frame.left + frame.right - size.width * dpr) / 2.0};
-    auto const centered_y{(frame.top + frame.bottom - size.height * dpr) / 2.0};
-    return {static_cast<unsigned int>(centered_x / dpr),
-            static_cast<unsigned int>(centered_y / dpr)};
-  }
-  return {0, 0};
+                             Win32Window const &window) -> Win32Window::Point {
+  auto const &geometry{window.geometry()};
+  auto const &frame{geometry.frame};
+  auto const dpr{geometry.device_pixel_ratio()};
+  auto const centered_x{(frame.left + frame.right - size.width * dpr) / 2.0};
+  auto const centered_y{(frame.top + frame.bottom - size.height * dpr) / 2.0};
+  return {static_cast<int>(centered_x / dpr),
+          static_cast<int>(centered_y / dpr)};
+}
+
+// Returns the origin flw::WindowPlacement finds for a window of |size| on the
+// monitor of |window|.
+auto calculatePlacedOrigin(Win32Window::Size size, Win32Window const &window,
+                           flw::Placement placement) -> Win32Window::Point {
+  auto const &geometry{window.geometry()};
+  auto const dpr{geometry.device_pixel_ratio()};
+  auto const origin{flw::WindowPlacement::instance().Place(
+      geometry.work_area, geometry.dpi,
+      {static_cast<LONG>(std::lround(size.width * dpr)),
+       static_cast<LONG>(std::lround(size.height * dpr))},
+      placement)};
+  return {static_cast<int>(origin.x / dpr), static_cast<int>(origin.y / dpr)};
 }
 
 std::tuple<Win32Window::Point, Win32Window::Size>
 applyPositioner(flw::Positioner const &positioner,
                 Win32Window::Size const &size,
                 flutter::FlutterViewId parent_view_id) {
+  FLW_TRACE_SCOPE("applyPositioner");
   auto const &windows{FlutterWindowManager::instance().windows()};
-  auto const &parent_window{windows.at(parent_view_id)};
-  auto const &parent_hwnd{parent_window->GetHandle()};
-  auto const dpr{FlutterDesktopGetDpiForHWND(parent_hwnd) / base_dpi};
-  auto const monitor_rect{[](HWND hwnd) -> RECT {
-    auto *monitor{MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST)};
-    MONITORINFO mi;
-    mi.cbSize = sizeof(MONITORINFO);
-    return GetMonitorInfo(monitor, &mi) ? mi.rcMonitor : RECT{0, 0, 0, 0};
-  }(parent_hwnd)};
-
-  RECT frame;
-  if (FAILED(DwmGetWindowAttribute(parent_hwnd, DWMWA_EXTENDED_FRAME_BOUNDS,
-                                   &frame, sizeof(frame)))) {
-    GetWindowRect(parent_hwnd, &frame);
-  }
+  auto const &parent_geometry{windows.at(parent_view_id)->geometry()};
+  auto const dpr{parent_geometry.device_pixel_ratio()};
+  auto const &monitor_rect{parent_geometry.monitor};
+  auto const &frame{parent_geometry.extended_frame};
 
   struct RectF {
     double left;
@@ -219,7 +254,7 @@ applyPositioner(flw::Positioner const &positioner,
                static_cast<uint32_t>(
                    flw::Positioner::ConstraintAdjustment::resize_x)) {
       if (origin_dc.x < 0) {
-        auto const diff{std::clamp(abs(origin_dc.x), 1.0, child_size.x - 1)};
+        auto const diff{std::clamp(std::abs(origin_dc.x), 1.0, child_size.x - 1)};
         origin_dc.x += diff;
         child_size.x -= diff;
       }
@@ -304,7 +339,7 @@ applyPositioner(flw::Positioner const &positioner,
                static_cast<uint32_t>(
                    flw::Positioner::ConstraintAdjustment::resize_y)) {
       if (origin_dc.y < 0) {
-        auto const diff{std::clamp(abs(origin_dc.y), 1.0, child_size.y - 1)};
+        auto const diff{std::clamp(std::abs(origin_dc.y), 1.0, child_size.y - 1)};
         origin_dc.y += diff;
         child_size.y -= diff;
       }
@@ -317,18 +352,131 @@ applyPositioner(flw::Positioner const &positioner,
     }
   }
 
-  Win32Window::Point const origin_lc{
-      static_cast<unsigned int>(origin_dc.x / dpr),
-      static_cast<unsigned int>(origin_dc.y / dpr)};
+  Win32Window::Point const origin_lc{static_cast<int>(origin_dc.x / dpr),
+                                     static_cast<int>(origin_dc.y / dpr)};
   Win32Window::Size const new_size{
       static_cast<unsigned int>(child_size.x / dpr),
       static_cast<unsigned int>(child_size.y / dpr)};
   return {origin_lc, new_size};
 }
 
+// Returns the logical origin and size to recreate |saved| with.
+auto savedFrame(flw::SavedWindow const &saved)
+    -> std::tuple<Win32Window::Point, Win32Window::Size> {
+  auto const scale{saved.dpi > 0 ? saved.dpi / 96.0 : 1.0};
+  auto const &frame{saved.frame};
+  auto const logical{[scale](int32_t value) {
+    return static_cast<int>(value / scale);
+  }};
+  auto const logical_size{[scale](int32_t value) {
+    return static_cast<unsigned int>(std::max(0.0, value / scale));
+  }};
+  return {{logical(frame.left), logical(frame.top)},
+          {logical_size(frame.right - frame.left),
+           logical_size(frame.bottom - frame.top)}};
+}
+
+// Returns the rect of a popup at |origin| with |size|, in logical pixels
+// relative to the client area of |parent_view_id|, if it lies entirely within
+// that client area.
+auto overlayRect(Win32Window::Point const &origin,
+                 Win32Window::Size const &size,
+                 flutter::FlutterViewId parent_view_id) -> std::optional<RECT> {
+  auto &parent{*FlutterWindowManager::instance().windows().at(parent_view_id)};
+  auto const &geometry{parent.geometry()};
+  auto const dpr{geometry.device_pixel_ratio()};
+  auto const client_origin{
+      WindowBackend::instance().GetClientOrigin(parent.GetHandle())};
+  auto const left{origin.x - client_origin.x / dpr};
+  auto const top{origin.y - client_origin.y / dpr};
+  if (left < 0 || top < 0 || left + size.width > geometry.client.right / dpr ||
+      top + size.height > geometry.client.bottom / dpr) {
+    return std::nullopt;
+  }
+  auto const x{static_cast<LONG>(std::lround(left))};
+  auto const y{static_cast<LONG>(std::lround(top))};
+  return RECT{x, y, x + static_cast<LONG>(size.width),
+              y + static_cast<LONG>(size.height)};
+}
+
+// Returns how Dart asked the window it creates to be announced: by events, or
+// by the reply if 'replyWithWindow' is true. Replies with an error and returns
+// std::nullopt if 'replyWithWindow' is not a bool.
+auto decodeAnnouncement(flutter::EncodableMap const &map,
+                        std::unique_ptr<flutter::MethodResult<>> &result)
+    -> std::optional<FlutterWindowManager::Announcement> {
+  using Announcement = FlutterWindowManager::Announcement;
+  auto const it{map.find(flutter::EncodableValue("replyWithWindow"))};
+  if (it == map.end()) {
+    return Announcement::events;
+  }
+  auto const *const value{std::get_if<bool>(&it->second)};
+  if (!value) {
+    result->Error("INVALID_VALUE",
+                  "Value for 'replyWithWindow' must be of type bool.");
+    return std::nullopt;
+  }
+  return *value ? Announcement::reply : Announcement::events;
+}
+
+auto encodeWindowState(FlutterWindowManager::WindowState const &window)
+    -> flutter::EncodableMap {
+  auto const &frame{window.frame};
+  return {
+      {flutter::EncodableValue("viewId"),
+       flutter::EncodableValue(ViewIdOf(window.view_id))},
+      {flutter::EncodableValue("archetype"),
+       flutter::EncodableValue(static_cast<int>(window.archetype))},
+      {flutter::EncodableValue("parentViewId"),
+       encodeParentViewId(window.parent_view_id)},
+      {flutter::EncodableValue("x"),
+       flutter::EncodableValue(static_cast<int>(frame.left))},
+      {flutter::EncodableValue("y"),
+       flutter::EncodableValue(static_cast<int>(frame.top))},
+      {flutter::EncodableValue("width"),
+       flutter::EncodableValue(static_cast<int>(frame.right - frame.left))},
+      {flutter::EncodableValue("height"),
+       flutter::EncodableValue(static_cast<int>(frame.bottom - frame.top))},
+      {flutter::EncodableValue("devicePixelRatio"),
+       flutter::EncodableValue(window.device_pixel_ratio)},
+      {flutter::EncodableValue("visibility"),
+       flutter::EncodableValue(static_cast<int>(window.visibility))}};
+}
+
+// Replies to a create call with the view ID of the new window or, if it is
+// announced by the reply, with its state and the sequence number it is current
+// as of. That reply stands in for onWindowCreated and onWindowResized.
+void replyWithWindow(
+    std::expected<flutter::FlutterViewId, FlutterWindowManager::Error> const
+        &window_id,
+    FlutterWindowManager::Announcement announcement,
+    std::unique_ptr<flutter::MethodResult<>> &result) {
+  if (!window_id) {
+    result->Error("UNAVAILABLE", "Can't create window.");
+    return;
+  }
+  if (announcement == FlutterWindowManager::Announcement::events) {
+    result->Success(flutter::EncodableValue(ViewIdOf(*window_id)));
+    return;
+  }
+  auto const snapshot{
+      FlutterWindowManager::instance().describeWindow(*window_id)};
+  if (snapshot.windows.empty()) {
+    // Closed already, and its onWindowDestroyed sent.
+    result->Error("UNAVAILABLE", "Window was closed.");
+    return;
+  }
+  auto reply{encodeWindowState(snapshot.windows.front())};
+  auto const sequence{static_cast<int64_t>(snapshot.sequence)};
+  reply.emplace(flutter::EncodableValue("sequence"),
+                flutter::EncodableValue(sequence));
+  result->Success(flutter::EncodableValue(std::move(reply)));
+}
+
 void handleCreateRegularWindow(
     flutter::MethodCall<> const &call,
-    std::unique_ptr<flutter::MethodResult<>> &result) {
+    std::unique_ptr<flutter::MethodResult<>> &result, EngineId engine) {
+  FLW_TRACE_SCOPE_NAMED(decode_arguments, "decodeArguments");
   auto const *const arguments{call.arguments()};
   if (auto const *const map{std::get_if<flutter::EncodableMap>(arguments)}) {
     auto const width_it{map->find(flutter::EncodableValue("width"))};
@@ -340,21 +488,59 @@ void handleCreateRegularWindow(
         Win32Window::Size const size{static_cast<unsigned int>(*width),
                                      static_cast<unsigned int>(*height)};
 
-        // Window will be centered within the 'main window'
-        auto const origin{[size]() -> Win32Window::Point {
+        // title
+        std::wstring title{L"regular"};
+        if (auto const title_it{map->find(flutter::EncodableValue("title"))};
+            title_it != map->end()) {
+          auto const *const utf8{std::get_if<std::string>(&title_it->second)};
+          auto wide{utf8 ? flw::text::WideFromUtf8(*utf8) : std::nullopt};
+          if (!wide) {
+            result->Error("INVALID_VALUE",
+                          "Value for 'title' must be a UTF-8 string.");
+            return;
+          }
+          title = std::move(*wide);
+        }
+
+        // placement
+        auto placement{flw::Placement::automatic};
+        if (auto const placement_it{
+                map->find(flutter::EncodableValue("placement"))};
+            placement_it != map->end()) {
+          auto const *const index{std::get_if<int>(&placement_it->second)};
+          if (!index || *index < 0 ||
+              *index > static_cast<int>(flw::Placement::centered)) {
+            result->Error("INVALID_VALUE",
+                          "Value for 'placement' must be a WindowPlacement "
+                          "index.");
+            return;
+          }
+          placement = static_cast<flw::Placement>(*index);
+        }
+
+        auto const announcement{decodeAnnouncement(*map, result)};
+        if (!announcement) {
+          return;
+        }
+        FLW_TRACE_SCOPE_END(decode_arguments);
+
+        // Window will be placed on the monitor of the engine's 'main window'
+        auto const origin{[size, engine, placement]() -> Win32Window::Point {
           auto const &windows{FlutterWindowManager::instance().windows()};
-          return windows.contains(0)
-                     ? calculateCenteredOrigin(size, windows.at(0)->GetHandle())
-                     : Win32Window::Point{0, 0};
+          auto const main_window{WindowIdFor(engine, 0)};
+          if (!windows.contains(main_window)) {
+            return {0, 0};
+          }
+          auto const &window{*windows.at(main_window)};
+          return placement == flw::Placement::centered
+                     ? calculateCenteredOrigin(size, window)
+                     : calculatePlacedOrigin(size, window, placement);
         }()};
 
-        if (auto const view_id{
-                FlutterWindowManager::instance().createRegularWindow(
-                    L"regular", origin, size)}) {
-          result->Success(flutter::EncodableValue(*view_id));
-        } else {
-          result->Error("UNAVAILABLE", "Can't create window.");
-        }
+        replyWithWindow(FlutterWindowManager::instance().createRegularWindow(
+                            title, origin, size, engine,
+                            ViewCreation::immediate, *announcement),
+                        *announcement, result);
       } else {
         result->Error("INVALID_VALUE",
                       "Values for {'width', 'height'} must be of type int.");
@@ -369,8 +555,13 @@ void handleCreateRegularWindow(
   }
 }
 
-void handleCreatePopupWindow(flutter::MethodCall<> const &call,
-                             std::unique_ptr<flutter::MethodResult<>> &result) {
+// Handles createPopupWindow, createTipWindow and createSatelliteWindow, which
+// take the same arguments.
+void handleCreateAnchoredWindow(
+    flutter::MethodCall<> const &call,
+    std::unique_ptr<flutter::MethodResult<>> &result,
+    flw::Archetype archetype, EngineId engine) {
+  FLW_TRACE_SCOPE_NAMED(decode_arguments, "decodeArguments");
   auto const *const arguments{call.arguments()};
   if (auto const *const map{std::get_if<flutter::EncodableMap>(arguments)}) {
     auto const parent_it{map->find(flutter::EncodableValue("parent"))};
@@ -384,6 +575,8 @@ void handleCreatePopupWindow(flutter::MethodCall<> const &call,
         map->find(flutter::EncodableValue("positionerOffset"))};
     auto const positioner_constraint_adjustment_it{
         map->find(flutter::EncodableValue("positionerConstraintAdjustment"))};
+    auto const allow_overlay_it{
+        map->find(flutter::EncodableValue("allowOverlay"))};
 
     if (parent_it != map->end() && size_it != map->end() &&
         anchor_rect_it != map->end() &&
@@ -502,6 +695,23 @@ void handleCreatePopupWindow(flutter::MethodCall<> const &call,
         return;
       }
 
+      // allowOverlay
+      auto allow_overlay{false};
+      if (allow_overlay_it != map->end()) {
+        auto const *const value{std::get_if<bool>(&allow_overlay_it->second)};
+        if (!value) {
+          result->Error("INVALID_VALUE",
+                        "Value for 'allowOverlay' must be of type bool.");
+          return;
+        }
+        allow_overlay = *value && archetype == flw::Archetype::popup;
+      }
+
+      auto const announcement{decodeAnnouncement(*map, result)};
+      if (!announcement) {
+        return;
+      }
+
       flw::Positioner const positioner{
           .anchor_rect = {.x = anchor_rect_x,
                           .y = anchor_rect_y,
@@ -513,16 +723,46 @@ void handleCreatePopupWindow(flutter::MethodCall<> const &call,
           .offset = {.dx = dx, .dy = dy},
           .constraint_adjustment =
               static_cast<uint32_t>(*positioner_constraint_adjustment)};
+      FLW_TRACE_SCOPE_END(decode_arguments);
 
+      auto const parent_id{WindowIdFor(engine, *parent)};
       auto const &[origin,
-                   new_size]{applyPositioner(positioner, size, *parent)};
-
-      if (auto const view_id{FlutterWindowManager::instance().createPopupWindow(
-              L"popup", origin, new_size, *parent)}) {
-        result->Success(flutter::EncodableValue(*view_id));
-      } else {
-        result->Error("UNAVAILABLE", "Can't create window.");
+                   new_size]{applyPositioner(positioner, size, parent_id)};
+
+      // A popup that fits inside its parent is drawn by Dart within the
+      // parent view, without a window and view of its own.
+      if (allow_overlay) {
+        if (auto const rect{overlayRect(origin, new_size, parent_id)}) {
+          result->Success(flutter::EncodableValue(flutter::EncodableMap{
+              {flutter::EncodableValue("overlay"),
+               flutter::EncodableValue(flutter::EncodableList{
+                   flutter::EncodableValue(static_cast<int>(rect->left)),
+                   flutter::EncodableValue(static_cast<int>(rect->top)),
+                   flutter::EncodableValue(
+                       static_cast<int>(rect->right - rect->left)),
+                   flutter::EncodableValue(
+                       static_cast<int>(rect->bottom - rect->top))})}}));
+          return;
+        }
       }
+
+      auto const window_id{[&] {
+        auto &manager{FlutterWindowManager::instance()};
+        switch (archetype) {
+        case flw::Archetype::tip:
+          return manager.createTipWindow(L"tip", origin, new_size, parent_id,
+                                         *announcement);
+        case flw::Archetype::satellite:
+          return manager.createSatelliteWindow(L"satellite", origin, new_size,
+                                               parent_id,
+                                               ViewCreation::immediate,
+                                               *announcement);
+        default:
+          return manager.createPopupWindow(L"popup", origin, new_size,
+                                           parent_id, *announcement);
+        }
+      }()};
+      replyWithWindow(window_id, *announcement, result);
     } else {
       result->Error("INVALID_VALUE",
                     "Map does not contain all required keys: "
@@ -536,14 +776,16 @@ void handleCreatePopupWindow(flutter::MethodCall<> const &call,
 }
 
 void handleDestroyWindow(flutter::MethodCall<> const &call,
-                         std::unique_ptr<flutter::MethodResult<>> &result) {
+                         std::unique_ptr<flutter::MethodResult<>> &result,
+                         EngineId engine) {
   auto const arguments{
       std::get<std::vector<flutter::EncodableValue>>(*call.arguments())};
   if (arguments.size() != 1 || !std::holds_alternative<int>(arguments[0])) {
     result->Error("INVALID_VALUE", "Value argument is not valid.");
   } else {
     auto const view_id{std::get<int>(arguments[0])};
-    if (FlutterWindowManager::instance().destroyWindow(view_id, true)) {
+    if (FlutterWindowManager::instance().destroyWindow(
+            WindowIdFor(engine, view_id), true)) {
       result->Success();
     } else {
       result->Error("UNAVAILABLE", "Can't destroy window.");
@@ -551,25 +793,239 @@ void handleDestroyWindow(flutter::MethodCall<> const &call,
   }
 }
 
+void handleGetStats(flutter::MethodCall<> const &call,
+                    std::unique_ptr<flutter::MethodResult<>> &result) {
+  auto const phase_name{[](MessageStats::Phase phase) -> char const * {
+    switch (phase) {
+    case MessageStats::Phase::dispatch:
+      return "dispatch";
+    case MessageStats::Phase::plugin:
+      return "plugin";
+    case MessageStats::Phase::handler:
+      return "handler";
+    case MessageStats::Phase::surface_resize:
+      return "surfaceResize";
+    case MessageStats::Phase::resize_frame:
+      return "resizeFrame";
+    case MessageStats::Phase::show:
+      return "show";
+    case MessageStats::Phase::hide:
+      return "hide";
+    default:
+      return "unknown";
+    }
+  }};
+  auto const as_int64{[](uint64_t value) {
+    return flutter::EncodableValue(static_cast<int64_t>(value));
+  }};
+
+  flutter::EncodableList stats;
+  MessageStats::instance().ForEach([&](MessageStats::Key const &key,
+                                       LatencyHistogram const &histogram) {
+    auto const name_it{wmTranslation.find(static_cast<int>(key.message))};
+    stats.emplace_back(flutter::EncodableMap{
+        {flutter::EncodableValue("archetype"),
+         flutter::EncodableValue(key.archetype)},
+        {flutter::EncodableValue("message"),
+         flutter::EncodableValue(static_cast<int64_t>(key.message))},
+        {flutter::EncodableValue("name"),
+         name_it != wmTranslation.end()
+             ? flutter::EncodableValue(name_it->second)
+             : flutter::EncodableValue()},
+        {flutter::EncodableValue("phase"),
+         flutter::EncodableValue(phase_name(key.phase))},
+        {flutter::EncodableValue("count"), as_int64(histogram.count())},
+        {flutter::EncodableValue("minNs"), as_int64(histogram.min())},
+        {flutter::EncodableValue("meanNs"), as_int64(histogram.mean())},
+        {flutter::EncodableValue("p50Ns"),
+         as_int64(histogram.ValueAtPercentile(50))},
+        {flutter::EncodableValue("p90Ns"),
+         as_int64(histogram.ValueAtPercentile(90))},
+        {flutter::EncodableValue("p99Ns"),
+         as_int64(histogram.ValueAtPercentile(99))},
+        {flutter::EncodableValue("maxNs"), as_int64(histogram.max())}});
+  });
+
+  // An optional {'reset': bool} argument clears the histograms once read.
+  if (auto const *const map{
+          std::get_if<flutter::EncodableMap>(call.arguments())}) {
+    auto const reset_it{map->find(flutter::EncodableValue("reset"))};
+    if (reset_it != map->end()) {
+      if (auto const *const reset{std::get_if<bool>(&reset_it->second)};
+          reset && *reset) {
+        MessageStats::instance().Reset();
+      }
+    }
+  }
+
+  result->Success(flutter::EncodableValue(std::move(stats)));
+}
+
+// Reports the windows of the calling engine only, as Dart cannot tell the views
+// of other engines apart.
+void handleGetMemoryStats(flutter::MethodCall<> const &,
+                          std::unique_ptr<flutter::MethodResult<>> &result,
+                          EngineId engine) {
+  flutter::EncodableList stats;
+  for (auto const &[window_id, window] :
+       FlutterWindowManager::instance().windows()) {
+    if (!window->flutter_view() || EngineIdOf(window_id) != engine) {
+      continue;
+    }
+    auto const &memory{window->memory()};
+    stats.emplace_back(flutter::EncodableMap{
+        {flutter::EncodableValue("viewId"),
+         flutter::EncodableValue(ViewIdOf(window_id))},
+        {flutter::EncodableValue("archetype"),
+         flutter::EncodableValue(static_cast<int>(window->archetype()))},
+        {flutter::EncodableValue("runnerBytes"),
+         flutter::EncodableValue(
+             memory.runner_bytes.load(std::memory_order_relaxed))},
+        {flutter::EncodableValue("runnerAllocations"),
+         flutter::EncodableValue(
+             memory.runner_allocations.load(std::memory_order_relaxed))},
+        {flutter::EncodableValue("surfaceBytes"),
+         flutter::EncodableValue(static_cast<int64_t>(
+             memory.surface_bytes.load(std::memory_order_relaxed)))},
+        {flutter::EncodableValue("visibility"),
+         flutter::EncodableValue(static_cast<int>(
+             window->visibility_tracker().visibility()))}});
+  }
+  result->Success(flutter::EncodableValue(std::move(stats)));
+}
+
+// Creates the views of the calling engine's deferred windows, regular windows
+// first so that they are realized before the windows they own.
+void handleRealizeWindows(flutter::MethodCall<> const &,
+                          std::unique_ptr<flutter::MethodResult<>> &result,
+                          EngineId engine) {
+  auto &manager{FlutterWindowManager::instance()};
+  std::vector<std::pair<bool, flutter::FlutterViewId>> deferred;
+  for (auto const &[window_id, window] : manager.windows()) {
+    if (window->deferred() && EngineIdOf(window_id) == engine) {
+      deferred.emplace_back(window->archetype() != flw::Archetype::regular,
+                            window_id);
+    }
+  }
+  std::ranges::sort(deferred);
+
+  flutter::EncodableList view_ids;
+  for (auto const &[owned, window_id] : deferred) {
+    if (auto const view_id{manager.realizeWindow(window_id)}) {
+      view_ids.emplace_back(ViewIdOf(*view_id));
+    }
+  }
+  result->Success(flutter::EncodableValue(std::move(view_ids)));
+}
+
+// Reports the windows of the calling engine in one reply, so that Dart can
+// rebuild its state after a hot restart or when it starts listening late.
+void handleGetWindowsSnapshot(flutter::MethodCall<> const &,
+                              std::unique_ptr<flutter::MethodResult<>> &result,
+                              EngineId engine) {
+  auto const snapshot{FlutterWindowManager::instance().snapshot(engine)};
+  flutter::EncodableList windows;
+  for (auto const &window : snapshot.windows) {
+    windows.emplace_back(encodeWindowState(window));
+  }
+  result->Success(flutter::EncodableValue(flutter::EncodableMap{
+      {flutter::EncodableValue("sequence"),
+       flutter::EncodableValue(static_cast<int64_t>(snapshot.sequence))},
+      {flutter::EncodableValue("windows"),
+       flutter::EncodableValue(std::move(windows))}}));
+}
+
+void handleSetMemoryBudget(flutter::MethodCall<> const &call,
+                           std::unique_ptr<flutter::MethodResult<>> &result) {
+  auto const *const map{std::get_if<flutter::EncodableMap>(call.arguments())};
+  if (!map) {
+    result->Error("INVALID_VALUE", "Value argument is not valid.");
+    return;
+  }
+  auto const bytes_it{map->find(flutter::EncodableValue("bytes"))};
+  if (bytes_it == map->end()) {
+    result->Error("INVALID_VALUE",
+                  "Map does not contain all required keys: {'bytes'}.");
+    return;
+  }
+  // The codec decodes integers as int or int64_t depending on their size.
+  auto const bytes{[&]() -> std::optional<int64_t> {
+    if (auto const *const value{std::get_if<int>(&bytes_it->second)}) {
+      return *value;
+    }
+    if (auto const *const value{std::get_if<int64_t>(&bytes_it->second)}) {
+      return *value;
+    }
+    return std::nullopt;
+  }()};
+  if (!bytes || *bytes < 0) {
+    result->Error("INVALID_VALUE",
+                  "Value for 'bytes' must be a non-negative int.");
+    return;
+  }
+
+  FlutterWindowManager::instance().setMemoryBudget(
+      static_cast<uint64_t>(*bytes));
+  result->Success();
+}
+
+void handleGetSatelliteTrail(flutter::MethodCall<> const &,
+                             std::unique_ptr<flutter::MethodResult<>> &result) {
+  auto const &trail{MessageStats::instance().satellite_trail()};
+  result->Success(flutter::EncodableValue(flutter::EncodableMap{
+      {flutter::EncodableValue("samples"),
+       flutter::EncodableValue(static_cast<int64_t>(trail.samples))},
+      {flutter::EncodableValue("trailingSamples"),
+       flutter::EncodableValue(static_cast<int64_t>(trail.trailing_samples))},
+      {flutter::EncodableValue("maxTrailingMoves"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(trail.max_trailing_moves))}}));
+}
+
+void handleConfigureLiveResize(
+    flutter::MethodCall<> const &call,
+    std::unique_ptr<flutter::MethodResult<>> &result) {
+  auto const *const map{std::get_if<flutter::EncodableMap>(call.arguments())};
+  if (!map) {
+    result->Error("INVALID_VALUE", "Value argument is not valid.");
+    return;
+  }
+  auto const get_arg{[map](char const *name) -> flutter::EncodableValue {
+    auto const it{map->find(flutter::EncodableValue(name))};
+    return it != map->end() ? it->second : flutter::EncodableValue();
+  }};
+
+  auto const enabled{get_arg("enabled")};
+  auto const interval_ms{get_arg("intervalMs")};
+  auto const bucket{get_arg("bucket")};
+  if (!std::holds_alternative<bool>(enabled) ||
+      !std::holds_alternative<int>(interval_ms) ||
+      !std::holds_alternative<int>(bucket) || std::get<int>(interval_ms) < 0 ||
+      std::get<int>(bucket) < 0) {
+    result->Error("INVALID_VALUE", "Value argument is not valid.");
+    return;
+  }
+
+  Win32Window::SetLiveResizeOptions(
+      {.enabled = std::get<bool>(enabled),
+       .interval = std::chrono::milliseconds(std::get<int>(interval_ms)),
+       .bucket = std::get<int>(bucket)});
+  result->Success();
+}
+
 } // namespace
 
-void FlutterWindowManager::initializeChannel() {
-  if (!channel_) {
-    channel_ = std::make_unique<flutter::MethodChannel<>>(
-        engine_->messenger(), CHANNEL,
+void FlutterWindowManager::initializeChannel(EngineId engine) {
+  auto &[host, channel]{engines_[engine]};
+  if (!channel) {
+    channel = std::make_unique<flutter::MethodChannel<>>(
+        host->messenger(), CHANNEL,
         &flutter::StandardMethodCodec::GetInstance());
-    channel_->SetMethodCallHandler(
-        [this](flutter::MethodCall<> const &call,
-               std::unique_ptr<flutter::MethodResult<>> result) {
-          if (call.method_name() == "createRegularWindow") {
-            handleCreateRegularWindow(call, result);
-          } else if (call.method_name() == "createPopupWindow") {
-            handleCreatePopupWindow(call, result);
-          } else if (call.method_name() == "destroyWindow") {
-            handleDestroyWindow(call, result);
-          } else {
-            result->NotImplemented();
-          }
+    channel->SetMethodCallHandler(
+        [this, engine](flutter::MethodCall<> const &call,
+                       std::unique_ptr<flutter::MethodResult<>> result) {
+          FLW_RECORD_METHOD_CALL(call);
+          handleMethodCall(call, std::move(result), engine);
         });
 
     // To avoid an overflow of onWindowCreated messages, the number of messages
@@ -578,46 +1034,136 @@ void FlutterWindowManager::initializeChannel() {
     // the channel's message handler is set up on the Dart side only after the
     // first call to State::didUpdateWidget.
     auto const max_windows_on_startup{16};
-    channel_->Resize(max_windows_on_startup);
+    channel->Resize(max_windows_on_startup);
   }
 }
 
+void FlutterWindowManager::handleMethodCall(
+    flutter::MethodCall<> const &call,
+    std::unique_ptr<flutter::MethodResult<>> result, EngineId engine) {
+  FLW_TRACE_SCOPE(call.method_name());
+  FLW_TRACE_FLOW_BEGIN();
+  if (call.method_name() == "createRegularWindow") {
+    handleCreateRegularWindow(call, result, engine);
+  } else if (call.method_name() == "createPopupWindow") {
+    handleCreateAnchoredWindow(call, result, flw::Archetype::popup, engine);
+  } else if (call.method_name() == "createTipWindow") {
+    handleCreateAnchoredWindow(call, result, flw::Archetype::tip, engine);
+  } else if (call.method_name() == "createSatelliteWindow") {
+    handleCreateAnchoredWindow(call, result, flw::Archetype::satellite,
+                               engine);
+  } else if (call.method_name() == "destroyWindow") {
+    handleDestroyWindow(call, result, engine);
+  } else if (call.method_name() == "getStats") {
+    handleGetStats(call, result);
+  } else if (call.method_name() == "getSatelliteTrail") {
+    handleGetSatelliteTrail(call, result);
+  } else if (call.method_name() == "configureLiveResize") {
+    handleConfigureLiveResize(call, result);
+  } else if (call.method_name() == "getMemoryStats") {
+    handleGetMemoryStats(call, result, engine);
+  } else if (call.method_name() == "realizeWindows") {
+    handleRealizeWindows(call, result, engine);
+  } else if (call.method_name() == "getWindowsSnapshot") {
+    handleGetWindowsSnapshot(call, result, engine);
+  } else if (call.method_name() == "setMemoryBudget") {
+    handleSetMemoryBudget(call, result);
+  } else {
+    result->NotImplemented();
+  }
+  FLW_TRACE_FLOW_CLEAR();
+}
+
+FlutterWindowManager::FlutterWindowManager() {
+  // The windows are destroyed with the manager at exit. Creating the
+  // singletons they use first destroys those after the manager.
+  WindowBackend::instance();
+  MessageStats::instance();
+  flw::WindowLayout::instance();
+  flw::WindowPlacement::instance();
+#if defined(FLW_ENABLE_REPLAY)
+  MessageRecorder::instance();
+#endif
+}
+
+FlutterWindowManager::~FlutterWindowManager() {
+  // Windows call back in here as they are destroyed, including the owned
+  // windows destroyed along with their owner. They go first, while the event
+  // queue is intact, and out of |windows_|, which the callbacks look up.
+  auto windows{std::exchange(windows_, {})};
+  windows.clear();
+  tip_pool_.clear();
+}
+
 void FlutterWindowManager::setEngine(
-    std::shared_ptr<flutter::FlutterEngine> engine) {
+    std::shared_ptr<FlutterEngineHost> engine) {
+  std::lock_guard<std::mutex> const lock(mutex_);
+  if (engines_.empty()) {
+    engines_.emplace_back();
+  }
+  engines_[0].host = std::move(engine);
+}
+
+auto FlutterWindowManager::addEngine(std::shared_ptr<FlutterEngineHost> engine)
+    -> EngineId {
   std::lock_guard<std::mutex> const lock(mutex_);
-  engine_ = std::move(engine);
+  if (engines_.empty()) {
+    engines_.emplace_back();
+  }
+  engines_.push_back({.host = std::move(engine), .channel = nullptr});
+  return static_cast<EngineId>(engines_.size() - 1);
+}
+
+auto FlutterWindowManager::findEngine(EngineId engine) -> Engine * {
+  return engine < engines_.size() && engines_[engine].host ? &engines_[engine]
+                                                            : nullptr;
 }
 
 auto FlutterWindowManager::createRegularWindow(std::wstring const &title,
                                                Win32Window::Point const &origin,
-                                               Win32Window::Size const &size)
+                                               Win32Window::Size const &size,
+                                               EngineId engine,
+                                               ViewCreation view_creation,
+                                               Announcement announcement)
     -> std::expected<flutter::FlutterViewId, Error> {
+  FLW_TRACE_SCOPE("FlutterWindowManager::createRegularWindow");
   std::unique_lock lock(mutex_);
-  if (!engine_) {
+  auto const *const host{findEngine(engine)};
+  if (!host) {
     return std::unexpected<Error>(Error::EngineNotSet);
   }
-  auto window{std::make_unique<FlutterWindow>(engine_)};
+  auto window{
+      std::make_unique<FlutterWindow>(host->host, engine, view_creation)};
 
   lock.unlock();
   if (!window->Create(title, origin, size, flw::Archetype::regular, nullptr)) {
     return std::unexpected(Error::Win32Error);
   }
+  flw::WindowLayout::instance().SetEngine(*window, engine);
   lock.lock();
 
-  // Assume first window is the main window
+  // Assume first window is the main window. Closed windows do not count.
+  cleanupClosedWindows();
   if (windows_.empty()) {
     window->SetQuitOnClose(true);
   }
 
-  auto const view_id{window->flutter_controller()->view_id()};
+  auto const view_id{window->window_id()};
+  auto const deferred{window->deferred()};
   windows_[view_id] = std::move(window);
 
-  initializeChannel();
-  cleanupClosedWindows();
-  sendOnWindowCreated(flw::Archetype::regular, view_id, std::nullopt);
+  initializeChannel(engine);
+  if (deferred) {
+    return view_id;
+  }
+  announceWindow(flw::Archetype::regular, view_id, std::nullopt, announcement);
 
   lock.unlock();
-  sendOnWindowResized(view_id);
+  if (announcement == Announcement::events) {
+    sendOnWindowResized(view_id);
+  }
+  enforceMemoryBudget(view_id);
+  flushEvents();
 
   return view_id;
 }
@@ -625,70 +1171,312 @@ auto FlutterWindowManager::createRegularWindow(std::wstring const &title,
 auto FlutterWindowManager::createPopupWindow(
     std::wstring const &title, Win32Window::Point const &origin,
     Win32Window::Size const &size,
-    std::optional<flutter::FlutterViewId> parent_view_id)
+    std::optional<flutter::FlutterViewId> parent_view_id,
+    Announcement announcement)
+    -> std::expected<flutter::FlutterViewId, Error> {
+  FLW_TRACE_SCOPE("FlutterWindowManager::createPopupWindow");
+  return createOwnedWindow(title, origin, size, flw::Archetype::popup,
+                           parent_view_id, ViewCreation::immediate,
+                           announcement);
+}
+
+auto FlutterWindowManager::createSatelliteWindow(
+    std::wstring const &title, Win32Window::Point const &origin,
+    Win32Window::Size const &size,
+    std::optional<flutter::FlutterViewId> parent_view_id,
+    ViewCreation view_creation, Announcement announcement)
+    -> std::expected<flutter::FlutterViewId, Error> {
+  FLW_TRACE_SCOPE("FlutterWindowManager::createSatelliteWindow");
+  return createOwnedWindow(title, origin, size, flw::Archetype::satellite,
+                           parent_view_id, view_creation, announcement);
+}
+
+auto FlutterWindowManager::createOwnedWindow(
+    std::wstring const &title, Win32Window::Point const &origin,
+    Win32Window::Size const &size, flw::Archetype archetype,
+    std::optional<flutter::FlutterViewId> parent_view_id,
+    ViewCreation view_creation, Announcement announcement)
     -> std::expected<flutter::FlutterViewId, Error> {
   std::unique_lock lock(mutex_);
-  if (!engine_) {
+  auto const engine{parent_view_id ? EngineIdOf(*parent_view_id) : 0};
+  auto const *const host{findEngine(engine)};
+  if (!host) {
     return std::unexpected<Error>(Error::EngineNotSet);
   }
   if (windows_.empty()) {
     return std::unexpected(Error::CannotBeFirstWindow);
   }
 
-  auto *const parent_hwnd{parent_view_id && windows_.contains(*parent_view_id)
-                              ? windows_[*parent_view_id].get()->GetHandle()
-                              : nullptr};
-  auto window{std::make_unique<FlutterWindow>(engine_)};
+  auto *const parent{parent_view_id && windows_.contains(*parent_view_id) &&
+                             !windows_[*parent_view_id]->closed()
+                         ? windows_[*parent_view_id].get()
+                         : nullptr};
+  auto *const parent_hwnd{parent ? parent->GetHandle() : nullptr};
+  auto window{std::make_unique<FlutterWindow>(host->host, engine,
+                                              view_creation, parent)};
 
   lock.unlock();
-  if (!window->Create(title, origin, size, flw::Archetype::popup,
-                      parent_hwnd)) {
+  if (!window->Create(title, origin, size, archetype, parent_hwnd)) {
     return std::unexpected(Error::Win32Error);
   }
   lock.lock();
 
-  auto const view_id{window->flutter_controller()->view_id()};
+  auto const view_id{window->window_id()};
+  auto const deferred{window->deferred()};
   windows_[view_id] = std::move(window);
 
-  initializeChannel();
+  initializeChannel(engine);
   cleanupClosedWindows();
-  sendOnWindowCreated(flw::Archetype::popup, view_id,
-                      parent_view_id ? *parent_view_id : -1);
+  if (deferred) {
+    return view_id;
+  }
+  announceWindow(archetype, view_id, parent_view_id ? *parent_view_id : -1,
+                 announcement);
 
   lock.unlock();
-  sendOnWindowResized(view_id);
+  if (announcement == Announcement::events) {
+    sendOnWindowResized(view_id);
+  }
+  enforceMemoryBudget(view_id);
+  flushEvents();
 
   return view_id;
 }
 
+auto FlutterWindowManager::createTipWindow(
+    std::wstring const &title, Win32Window::Point const &origin,
+    Win32Window::Size const &size,
+    std::optional<flutter::FlutterViewId> parent_view_id,
+    Announcement announcement)
+    -> std::expected<flutter::FlutterViewId, Error> {
+  FLW_TRACE_SCOPE("FlutterWindowManager::createTipWindow");
+  std::unique_lock lock(mutex_);
+  auto const engine{parent_view_id ? EngineIdOf(*parent_view_id) : 0};
+  if (!findEngine(engine)) {
+    return std::unexpected<Error>(Error::EngineNotSet);
+  }
+  if (windows_.empty()) {
+    return std::unexpected(Error::CannotBeFirstWindow);
+  }
+
+  auto *const parent_hwnd{parent_view_id && windows_.contains(*parent_view_id)
+                              ? windows_[*parent_view_id].get()->GetHandle()
+                              : nullptr};
+
+  // Pooled tips keep the view of their engine.
+  if (auto const pooled{std::ranges::find_if(
+          tip_pool_,
+          [engine](auto const &tip) { return tip->engine_id() == engine; })};
+      pooled != tip_pool_.end()) {
+    // Reuse a hidden tip: no native window or view is created, and the tip is
+    // shown without activation.
+    //
+    // The tip keeps its view ID, so Dart may still be about to receive the
+    // onWindowDestroyed of its previous use. With events, it is queued ahead of
+    // the onWindowCreated below. A reply announcing the tip carries a later
+    // sequence number, so Dart drops the event as stale rather than remove the
+    // reused tip.
+    auto window{std::move(*pooled)};
+    tip_pool_.erase(pooled);
+    auto &tip{*window};
+    auto const view_id{tip.window_id()};
+    windows_[view_id] = std::move(window);
+
+    // Shown before it is announced, so that the resize is not sent ahead of
+    // the announcement.
+    lock.unlock();
+    tip.ShowAt(origin, size, parent_hwnd);
+    lock.lock();
+    announceWindow(flw::Archetype::tip, view_id,
+                   parent_view_id ? *parent_view_id : -1, announcement);
+    lock.unlock();
+    // Dart forgot the size of the view along with the previous tip, and the
+    // frame commit only reports a change from the hidden tip's size.
+    if (announcement == Announcement::events) {
+      sendOnWindowResized(view_id);
+    }
+    enforceMemoryBudget(view_id);
+    flushEvents();
+
+    return view_id;
+  }
+
+  lock.unlock();
+  return createOwnedWindow(title, origin, size, flw::Archetype::tip,
+                           parent_view_id, ViewCreation::immediate,
+                           announcement);
+}
+
 auto FlutterWindowManager::destroyWindow(flutter::FlutterViewId view_id,
                                          bool destroy_native_window) -> bool {
   std::unique_lock lock(mutex_);
   if (windows_.contains(view_id)) {
     if (windows_[view_id]->GetQuitOnClose()) {
+      // The windows closed on the way out stay in the saved layout.
+      flw::WindowLayout::instance().Freeze();
       for (auto &[id, window] : windows_) {
-        if (id != view_id && window->flutter_controller()) {
+        if (id != view_id && !window->closed()) {
           lock.unlock();
           window->Destroy();
           lock.lock();
         }
       }
+      auto pool{std::exchange(tip_pool_, {})};
+      lock.unlock();
+      pool.clear();
+      lock.lock();
+    }
+    if (destroy_native_window &&
+        windows_[view_id]->archetype() == flw::Archetype::tip &&
+        windows_[view_id]->flutter_view() &&
+        tip_pool_.size() < kTipPoolCapacity) {
+      // Hide the tip and keep it for the next createTipWindow.
+      auto &tip{*tip_pool_.emplace_back(std::move(windows_[view_id]))};
+      windows_.erase(view_id);
+      // Numbered as it leaves the snapshots.
+      parents_.erase(view_id);
+      sendOnWindowDestroyed(view_id);
+      lock.unlock();
+      tip.Hide();
+      flushEvents();
+      return true;
     }
+    // Dart never learnt of a window whose view was deferred.
+    auto const announced{!windows_[view_id]->deferred()};
     if (destroy_native_window) {
       auto const &window{windows_[view_id]};
       lock.unlock();
+      // Destroying the native window calls back in here from
+      // FlutterWindow::OnDestroy, which sends onWindowDestroyed.
       window->Destroy();
-      lock.lock();
+      flushEvents();
+      return true;
+    }
+    // Numbered as it leaves the snapshots, which it would otherwise stay in
+    // until its view is gone.
+    parents_.erase(view_id);
+    if (announced) {
+      sendOnWindowDestroyed(view_id);
     }
-    sendOnWindowDestroyed(view_id);
+    lock.unlock();
+    flushEvents();
     return true;
   }
   return false;
 }
 
+auto FlutterWindowManager::realizeWindow(flutter::FlutterViewId window_id)
+    -> std::optional<flutter::FlutterViewId> {
+  std::unique_lock lock(mutex_);
+  auto const it{windows_.find(window_id)};
+  if (it == windows_.end() || it->second->closed()) {
+    return std::nullopt;
+  }
+  auto &window{*it->second};
+  if (!window.deferred()) {
+    return window_id;
+  }
+  // Dart learns of the parent before its owned windows.
+  auto *const parent{window.parent()};
+  std::optional<flutter::FlutterViewId> parent_id;
+  if (parent) {
+    auto const parent_window_id{parent->window_id()};
+    lock.unlock();
+    parent_id = realizeWindow(parent_window_id);
+    lock.lock();
+  }
+
+  lock.unlock();
+  if (!window.CreateDeferredView()) {
+    // The closed window is erased by the next cleanupClosedWindows.
+    window.Destroy();
+    return std::nullopt;
+  }
+  lock.lock();
+  auto node{windows_.extract(window_id)};
+  auto const view_id{window.window_id()};
+  node.key() = view_id;
+  windows_.insert(std::move(node));
+
+  auto const archetype{window.archetype()};
+  if (archetype == flw::Archetype::regular) {
+    announceWindow(archetype, view_id, std::nullopt, Announcement::events);
+  } else {
+    announceWindow(archetype, view_id, parent_id.value_or(-1),
+                   Announcement::events);
+  }
+
+  lock.unlock();
+  sendOnWindowResized(view_id);
+  enforceMemoryBudget(view_id);
+  flushEvents();
+
+  return view_id;
+}
+
+auto FlutterWindowManager::restoreLayout(ViewCreation view_creation) -> bool {
+  auto const saved{flw::WindowLayout::instance().TakeSaved()};
+  // Regular windows go first, so that satellites find their parents.
+  std::vector<size_t> order(saved.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::ranges::stable_sort(order, {}, [&saved](size_t index) {
+    auto const &window{saved[index]};
+    if (window.archetype != static_cast<uint32_t>(flw::Archetype::regular)) {
+      return 2;
+    }
+    return (window.flags & flw::SavedWindow::kQuitOnClose) ? 0 : 1;
+  });
+
+  std::vector<std::optional<flutter::FlutterViewId>> view_ids(saved.size());
+  auto restored{false};
+  for (auto const index : order) {
+    auto const &window{saved[index]};
+    auto const [origin, size]{savedFrame(window)};
+    auto const title{flw::text::WideFromUtf8(window.title).value_or(L"")};
+    auto const archetype{static_cast<flw::Archetype>(window.archetype)};
+    if (archetype == flw::Archetype::regular) {
+      auto view_id{createRegularWindow(title, origin, size, window.engine,
+                                       view_creation)};
+      if (!view_id && view_id.error() == Error::EngineNotSet) {
+        view_id = createRegularWindow(title, origin, size, 0, view_creation);
+      }
+      if (view_id) {
+        view_ids[index] = *view_id;
+        restored = true;
+      }
+    } else if (archetype == flw::Archetype::satellite && window.parent >= 0 &&
+               view_ids[window.parent]) {
+      if (auto const view_id{createSatelliteWindow(
+              title, origin, size, view_ids[window.parent], view_creation)}) {
+        view_ids[index] = *view_id;
+      }
+    }
+  }
+  return restored;
+}
+
+auto FlutterWindowManager::moveWindow(flutter::FlutterViewId view_id,
+                                      Win32Window::Point const &origin,
+                                      Win32Window::Size const &size) -> bool {
+  std::unique_lock lock(mutex_);
+  auto const it{windows_.find(view_id)};
+  if (it == windows_.end() || it->second->closed()) {
+    return false;
+  }
+  auto &window{*it->second};
+  lock.unlock();
+  window.MoveTo(origin, size);
+  flushEvents();
+  return true;
+}
+
 void FlutterWindowManager::cleanupClosedWindows() {
-  std::erase_if(windows_, [](auto const &window) {
-    return !window.second->flutter_controller();
+  std::erase_if(windows_, [this](auto const &window) {
+    if (!window.second->closed()) {
+      return false;
+    }
+    parents_.erase(window.first);
+    return true;
   });
 }
 
@@ -697,68 +1485,247 @@ auto FlutterWindowManager::windows() const -> WindowMap const & {
   return windows_;
 }
 
-auto FlutterWindowManager::channel() const
+auto FlutterWindowManager::channel(EngineId engine) const
     -> std::unique_ptr<flutter::MethodChannel<>> const & {
+  static std::unique_ptr<flutter::MethodChannel<>> const no_channel;
   std::lock_guard const lock(mutex_);
-  return channel_;
+  return engine < engines_.size() ? engines_[engine].channel : no_channel;
 };
 
+auto FlutterWindowManager::snapshot(EngineId engine) const -> Snapshot {
+  // Events are queued with mutex_ held or after the change they report, so
+  // every event numbered up to |sequence| is reflected in the windows below.
+  std::lock_guard const lock(mutex_);
+  Snapshot snapshot{.sequence = event_sequence_.load(std::memory_order_acquire),
+                    .windows = {}};
+  for (auto const &[window_id, window] : windows_) {
+    if (EngineIdOf(window_id) != engine) {
+      continue;
+    }
+    if (auto const state{stateOf(window_id, *window)}) {
+      snapshot.windows.push_back(*state);
+    }
+  }
+  return snapshot;
+}
+
+auto FlutterWindowManager::describeWindow(
+    flutter::FlutterViewId window_id) const -> Snapshot {
+  std::lock_guard const lock(mutex_);
+  Snapshot snapshot{.sequence = event_sequence_.load(std::memory_order_acquire),
+                    .windows = {}};
+  if (auto const it{windows_.find(window_id)}; it != windows_.end()) {
+    if (auto const state{stateOf(window_id, *it->second)}) {
+      snapshot.windows.push_back(*state);
+    }
+  }
+  return snapshot;
+}
+
+auto FlutterWindowManager::stateOf(flutter::FlutterViewId window_id,
+                                   FlutterWindow &window) const
+    -> std::optional<WindowState> {
+  // Deferred windows have not been announced yet.
+  auto const parent_it{parents_.find(window_id)};
+  if (!window.flutter_view() || parent_it == parents_.end()) {
+    return std::nullopt;
+  }
+  auto const &geometry{window.geometry()};
+  return WindowState{.view_id = window_id,
+                     .archetype = window.archetype(),
+                     .parent_view_id = parent_it->second,
+                     .frame = logicalFrame(geometry),
+                     .device_pixel_ratio = geometry.device_pixel_ratio(),
+                     .visibility = window.visibility_tracker().visibility()};
+}
+
+auto FlutterWindowManager::sentEventCount() const -> uint64_t {
+  return sent_event_count_.load(std::memory_order_relaxed);
+}
+
+void FlutterWindowManager::setMemoryBudget(uint64_t bytes) {
+  {
+    std::lock_guard const lock(mutex_);
+    memory_budget_ = bytes;
+  }
+  enforceMemoryBudget();
+}
+
+void FlutterWindowManager::enforceMemoryBudget(
+    std::optional<flutter::FlutterViewId> keep) {
+  for (;;) {
+    std::unique_lock lock(mutex_);
+    if (memory_budget_ == 0) {
+      return;
+    }
+    uint64_t total{0};
+    std::optional<flutter::FlutterViewId> victim;
+    std::chrono::steady_clock::time_point victim_hidden_since;
+    for (auto const &[view_id, window] : windows_) {
+      if (!window->flutter_view()) {
+        continue;
+      }
+      total += window->memory().total_bytes();
+      auto const &visibility{window->visibility_tracker()};
+      if (window->archetype() == flw::Archetype::popup && view_id != keep &&
+          visibility.visibility() != flw::Visibility::visible &&
+          (!victim || visibility.hidden_since() < victim_hidden_since)) {
+        victim = view_id;
+        victim_hidden_since = visibility.hidden_since();
+      }
+    }
+    if (total <= memory_budget_ || !victim) {
+      return;
+    }
+    lock.unlock();
+    destroyWindow(*victim, true);
+  }
+}
+
+void FlutterWindowManager::announceWindow(
+    flw::Archetype archetype, flutter::FlutterViewId view_id,
+    std::optional<flutter::FlutterViewId> parent_view_id,
+    Announcement announcement) {
+  parents_[view_id] = parent_view_id;
+  if (announcement == Announcement::events) {
+    sendOnWindowCreated(archetype, view_id, parent_view_id);
+  }
+}
+
 void FlutterWindowManager::sendOnWindowCreated(
     flw::Archetype archetype, flutter::FlutterViewId view_id,
-    std::optional<flutter::FlutterViewId> parent_view_id) const {
-  if (channel_) {
-    channel_->InvokeMethod(
+    std::optional<flutter::FlutterViewId> parent_view_id) {
+  FLW_TRACE_FLOW_STEP(FLW_TRACE_VIEW_TRACK(view_id));
+  queueEvent({.type = Event::Type::created,
+              .view_id = view_id,
+              .archetype = archetype,
+              .parent_view_id = parent_view_id});
+}
+
+void FlutterWindowManager::sendOnWindowDestroyed(
+    flutter::FlutterViewId view_id) {
+  queueEvent({.type = Event::Type::destroyed, .view_id = view_id});
+}
+
+void FlutterWindowManager::sendOnWindowVisibilityChanged(
+    flutter::FlutterViewId view_id, flw::Visibility visibility) {
+  queueEvent({.type = Event::Type::visibility_changed,
+              .view_id = view_id,
+              .visibility = visibility});
+}
+
+void FlutterWindowManager::sendOnWindowResized(
+    flutter::FlutterViewId view_id) {
+  Event event{.type = Event::Type::resized, .view_id = view_id};
+  {
+    std::lock_guard const lock(mutex_);
+    auto const it{windows_.find(view_id)};
+    // Dart learns the size of a window when it is announced.
+    if (it == windows_.end() || !parents_.contains(view_id)) {
+      return;
+    }
+    auto const &geometry{it->second->geometry()};
+    auto const frame{logicalFrame(geometry)};
+    event.width = static_cast<int>(frame.right - frame.left);
+    event.height = static_cast<int>(frame.bottom - frame.top);
+    event.device_pixel_ratio = geometry.device_pixel_ratio();
+    // Numbered along with the geometry it carries, so that no snapshot taken
+    // after it holds an older one.
+    queueEvent(event);
+  }
+}
+
+void FlutterWindowManager::queueEvent(Event event) {
+  event.sequence =
+      event_sequence_.fetch_add(1, std::memory_order_acq_rel) + 1;
+  events_.Push(std::move(event));
+  queued_events_.fetch_add(1, std::memory_order_release);
+}
+
+void FlutterWindowManager::flushEvents() {
+  // Only one thread pops at a time. An event queued while another thread
+  // flushes is left to it: that thread checks the queue again after letting go.
+  while (queued_events_.load(std::memory_order_acquire) > 0 &&
+         !flushing_.test_and_set(std::memory_order_acquire)) {
+    // Channels live as long as the manager once created.
+    std::vector<flutter::MethodChannel<> *> channels;
+    {
+      std::lock_guard const lock(mutex_);
+      for (auto const &engine : engines_) {
+        channels.push_back(engine.channel.get());
+      }
+    }
+    while (auto const event{events_.Pop()}) {
+      queued_events_.fetch_sub(1, std::memory_order_relaxed);
+      // Events queued before the channel of their engine exists are dropped,
+      // as Dart is not listening yet.
+      auto const engine{EngineIdOf(event->view_id)};
+      if (engine < channels.size() && channels[engine]) {
+        ++sent_event_count_;
+        sendEvent(*channels[engine], *event);
+      }
+    }
+    flushing_.clear(std::memory_order_release);
+  }
+}
+
+void FlutterWindowManager::sendEvent(flutter::MethodChannel<> &channel,
+                                     Event const &event) {
+  // Dart knows the views of its engine by their view IDs.
+  auto const view_id{ViewIdOf(event.view_id)};
+  switch (event.type) {
+  case Event::Type::created: {
+    FLW_TRACE_SCOPE_ON("onWindowCreated", FLW_TRACE_VIEW_TRACK(event.view_id));
+    channel.InvokeMethod(
         "onWindowCreated",
         std::make_unique<flutter::EncodableValue>(flutter::EncodableMap{
             {flutter::EncodableValue("viewId"),
              flutter::EncodableValue(view_id)},
+            {flutter::EncodableValue("sequence"),
+             flutter::EncodableValue(static_cast<int64_t>(event.sequence))},
             {flutter::EncodableValue("parentViewId"),
-            parent_view_id ? flutter::EncodableValue(*parent_view_id) : flutter::EncodableValue()},
+             encodeParentViewId(event.parent_view_id)},
             {flutter::EncodableValue("archetype"),
-             flutter::EncodableValue(static_cast<int>(archetype))}}));
+             flutter::EncodableValue(static_cast<int>(event.archetype))}}));
+    break;
   }
-}
-
-void FlutterWindowManager::sendOnWindowDestroyed(
-    flutter::FlutterViewId view_id) const {
-  if (channel_) {
-    channel_->InvokeMethod(
+  case Event::Type::destroyed:
+    channel.InvokeMethod(
         "onWindowDestroyed",
         std::make_unique<flutter::EncodableValue>(flutter::EncodableMap{
             {flutter::EncodableValue("viewId"),
              flutter::EncodableValue(view_id)},
+            {flutter::EncodableValue("sequence"),
+             flutter::EncodableValue(static_cast<int64_t>(event.sequence))},
         }));
-  }
-}
-
-void FlutterWindowManager::sendOnWindowResized(
-    flutter::FlutterViewId view_id) const {
-  std::lock_guard const lock(mutex_);
-  if (channel_) {
-    auto *const hwnd{windows_.at(view_id)->GetHandle()};
-    RECT frame;
-    if (FAILED(DwmGetWindowAttribute(hwnd, DWMWA_EXTENDED_FRAME_BOUNDS, &frame,
-                                     sizeof(frame)))) {
-      GetWindowRect(hwnd, &frame);
-    }
-
-    // Convert to logical coordinates
-    auto const dpr{FlutterDesktopGetDpiForHWND(hwnd) / base_dpi};
-    frame.left = static_cast<LONG>(frame.left / dpr);
-    frame.top = static_cast<LONG>(frame.top / dpr);
-    frame.right = static_cast<LONG>(frame.right / dpr);
-    frame.bottom = static_cast<LONG>(frame.bottom / dpr);
-
-    auto const width{frame.right - frame.left};
-    auto const height{frame.bottom - frame.top};
-    channel_->InvokeMethod(
+    break;
+  case Event::Type::resized: {
+    FLW_TRACE_SCOPE_ON("onWindowResized", FLW_TRACE_VIEW_TRACK(event.view_id));
+    channel.InvokeMethod(
         "onWindowResized",
         std::make_unique<flutter::EncodableValue>(flutter::EncodableMap{
             {flutter::EncodableValue("viewId"),
              flutter::EncodableValue(view_id)},
+            {flutter::EncodableValue("sequence"),
+             flutter::EncodableValue(static_cast<int64_t>(event.sequence))},
             {flutter::EncodableValue("width"),
-             flutter::EncodableValue(static_cast<int>(width))},
+             flutter::EncodableValue(event.width)},
             {flutter::EncodableValue("height"),
-             flutter::EncodableValue(static_cast<int>(height))}}));
+             flutter::EncodableValue(event.height)},
+            {flutter::EncodableValue("devicePixelRatio"),
+             flutter::EncodableValue(event.device_pixel_ratio)}}));
+    break;
+  }
+  case Event::Type::visibility_changed:
+    channel.InvokeMethod(
+        "onWindowVisibilityChanged",
+        std::make_unique<flutter::EncodableValue>(flutter::EncodableMap{
+            {flutter::EncodableValue("viewId"),
+             flutter::EncodableValue(view_id)},
+            {flutter::EncodableValue("sequence"),
+             flutter::EncodableValue(static_cast<int64_t>(event.sequence))},
+            {flutter::EncodableValue("visibility"),
+             flutter::EncodableValue(static_cast<int>(event.visibility))}}));
+    break;
   }
 }
\ No newline at end of file
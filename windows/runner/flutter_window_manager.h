@@ -3,11 +3,14 @@
 
 #include <flutter/method_channel.h>
 
+#include "event_queue.h"
 #include "flutter_window.h"
 #include "windowing_types.h"
 
+#include <atomic>
 #include <expected>
 #include <mutex>
+#include <vector>
 
 class FlutterWindowManager {
 public:
@@ -15,7 +18,7 @@ public:
   FlutterWindowManager(FlutterWindowManager &&) = delete;
   FlutterWindowManager &operator=(FlutterWindowManager const &) = delete;
   FlutterWindowManager &operator=(FlutterWindowManager &&) = delete;
-  ~FlutterWindowManager() = default;
+  ~FlutterWindowManager();
 
   enum class Error {
     Win32Error,
@@ -30,38 +33,202 @@ public:
     return instance;
   }
 
-  void setEngine(std::shared_ptr<flutter::FlutterEngine> engine);
-  auto createRegularWindow(std::wstring const &title,
-                           Win32Window::Point const &origin,
-                           Win32Window::Size const &size)
+  // How a new window is announced to Dart: by onWindowCreated and
+  // onWindowResized events, or by the reply to the method call creating it,
+  // filled in from describeWindow.
+  enum class Announcement { events, reply };
+
+  // Windows are identified by their window ID, see WindowIdFor. Owned windows
+  // run on the engine of their parent.
+
+  // Sets engine 0, the engine windows are created on by default.
+  void setEngine(std::shared_ptr<FlutterEngineHost> engine);
+  // Adds an engine, each with its own Dart UI isolate and flw/window channel,
+  // so that groups of windows placed on different engines run their UI work
+  // in parallel. Returns its ID.
+  auto addEngine(std::shared_ptr<FlutterEngineHost> engine) -> EngineId;
+  // Windows created with ViewCreation::deferred are keyed by a placeholder
+  // window ID, and announced to Dart only once realizeWindow creates their
+  // view.
+  auto createRegularWindow(
+      std::wstring const &title, Win32Window::Point const &origin,
+      Win32Window::Size const &size, EngineId engine = 0,
+      ViewCreation view_creation = ViewCreation::immediate,
+      Announcement announcement = Announcement::events)
       -> std::expected<flutter::FlutterViewId, Error>;
   auto createPopupWindow(
       std::wstring const &title, Win32Window::Point const &origin,
       Win32Window::Size const &size,
-      std::optional<flutter::FlutterViewId> parent_view_id = std::nullopt)
+      std::optional<flutter::FlutterViewId> parent_view_id = std::nullopt,
+      Announcement announcement = Announcement::events)
+      -> std::expected<flutter::FlutterViewId, Error>;
+  // Creates a satellite, which follows |parent_view_id| as it moves.
+  auto createSatelliteWindow(
+      std::wstring const &title, Win32Window::Point const &origin,
+      Win32Window::Size const &size,
+      std::optional<flutter::FlutterViewId> parent_view_id = std::nullopt,
+      ViewCreation view_creation = ViewCreation::immediate,
+      Announcement announcement = Announcement::events)
+      -> std::expected<flutter::FlutterViewId, Error>;
+  // Creates a tip, reusing a pooled one when available. Tips never take
+  // activation or focus.
+  auto createTipWindow(
+      std::wstring const &title, Win32Window::Point const &origin,
+      Win32Window::Size const &size,
+      std::optional<flutter::FlutterViewId> parent_view_id = std::nullopt,
+      Announcement announcement = Announcement::events)
       -> std::expected<flutter::FlutterViewId, Error>;
   auto destroyWindow(flutter::FlutterViewId view_id,
                      bool destroy_native_window) -> bool;
+  // Creates the view of the deferred window |window_id|, and of its parent
+  // first if deferred too, and announces them to Dart. Returns the window's
+  // new ID, or std::nullopt if there is no such window or its view could not
+  // be set up. A window that already has a view keeps its ID.
+  auto realizeWindow(flutter::FlutterViewId window_id)
+      -> std::optional<flutter::FlutterViewId>;
+  // Recreates the windows saved in flw::WindowLayout by the previous run, the
+  // main window first, on the engines they ran on, or on engine 0 if that
+  // engine has not been added. Views are created as |view_creation| says.
+  // Returns false if no regular window was restored.
+  auto restoreLayout(ViewCreation view_creation = ViewCreation::immediate)
+      -> bool;
+  // Moves and resizes the window |view_id|. Returns false if there is no such
+  // window.
+  auto moveWindow(flutter::FlutterViewId view_id,
+                  Win32Window::Point const &origin,
+                  Win32Window::Size const &size) -> bool;
   auto windows() const -> WindowMap const &;
-  auto channel() const -> std::unique_ptr<flutter::MethodChannel<>> const &;
+  // Returns the flw/window channel of |engine|, once it has a window.
+  auto channel(EngineId engine = 0) const
+      -> std::unique_ptr<flutter::MethodChannel<>> const &;
+
+  // Handles a method call received on the flw/window channel of |engine|.
+  void handleMethodCall(flutter::MethodCall<> const &call,
+                        std::unique_ptr<flutter::MethodResult<>> result,
+                        EngineId engine = 0);
+
+  // A window as reported by snapshot, with its frame in logical pixels and
+  // |parent_view_id| as sent in onWindowCreated.
+  struct WindowState {
+    flutter::FlutterViewId view_id;
+    flw::Archetype archetype;
+    std::optional<flutter::FlutterViewId> parent_view_id;
+    RECT frame;
+    double device_pixel_ratio;
+    flw::Visibility visibility;
+  };
+  struct Snapshot {
+    // The sequence number of the last event queued before the snapshot was
+    // taken. Events up to it are reflected in |windows|, later ones are not.
+    uint64_t sequence;
+    std::vector<WindowState> windows;
+  };
+  // Returns the windows of |engine| that Dart has been told of.
+  auto snapshot(EngineId engine) const -> Snapshot;
+  // Returns the window |window_id| as snapshot would, or no window if there is
+  // no such window or it has no view.
+  auto describeWindow(flutter::FlutterViewId window_id) const -> Snapshot;
+
+  // Returns the number of events sent to Dart over the flw/window channel.
+  auto sentEventCount() const -> uint64_t;
+
+  // Sends the queued events to Dart. Holds no lock while sending, so a slow
+  // messenger does not block the other manager operations. Must be called on
+  // the platform thread.
+  void flushEvents();
+
+  // Sets the number of bytes the windows may be charged in total before hidden
+  // popups are reclaimed, least recently visible first. 0 disables the budget.
+  void setMemoryBudget(uint64_t bytes);
+
+  // Destroys hidden popups until the windows fit in the memory budget. Never
+  // destroys the window |keep|, whose messages may be being handled.
+  void enforceMemoryBudget(
+      std::optional<flutter::FlutterViewId> keep = std::nullopt);
 
 private:
   friend class FlutterWindow;
 
-  FlutterWindowManager() = default;
+  // An engine and the flw/window channel its Dart code talks to.
+  struct Engine {
+    std::shared_ptr<FlutterEngineHost> host;
+    std::unique_ptr<flutter::MethodChannel<>> channel;
+  };
+
+  FlutterWindowManager();
+
+  // Returns engine |engine| if it exists. Requires mutex_.
+  auto findEngine(EngineId engine) -> Engine *;
+  void initializeChannel(EngineId engine);
+  // Creates a window of |archetype| owned by |parent_view_id|.
+  auto createOwnedWindow(
+      std::wstring const &title, Win32Window::Point const &origin,
+      Win32Window::Size const &size, flw::Archetype archetype,
+      std::optional<flutter::FlutterViewId> parent_view_id,
+      ViewCreation view_creation = ViewCreation::immediate,
+      Announcement announcement = Announcement::events)
+      -> std::expected<flutter::FlutterViewId, Error>;
+  // Returns the state of |window|, if it has a view and Dart has been told of
+  // it. Requires mutex_.
+  auto stateOf(flutter::FlutterViewId window_id,
+               FlutterWindow &window) const -> std::optional<WindowState>;
+  // An event for Dart, queued by the sendOnWindow* functions and encoded by
+  // flushEvents. It goes to the engine of |view_id|, a window ID like
+  // |parent_view_id|.
+  struct Event {
+    enum class Type { created, destroyed, resized, visibility_changed };
+    Type type{};
+    // Set by queueEvent, increasing across all engines.
+    uint64_t sequence{};
+    flutter::FlutterViewId view_id{};
+    flw::Archetype archetype{};
+    std::optional<flutter::FlutterViewId> parent_view_id{};
+    int width{};
+    int height{};
+    double device_pixel_ratio{};
+    flw::Visibility visibility{};
+  };
 
-  void initializeChannel();
+  // Records the parent of the new window |view_id| and, if it is announced by
+  // events, queues its onWindowCreated. Requires mutex_.
+  void announceWindow(flw::Archetype archetype, flutter::FlutterViewId view_id,
+                      std::optional<flutter::FlutterViewId> parent_view_id,
+                      Announcement announcement);
+  // The sendOnWindow* functions queue an event, sent by the next flushEvents.
+  // sendOnWindowCreated requires mutex_. The others may be called with it
+  // held, except sendOnWindowResized.
   void sendOnWindowCreated(flw::Archetype archetype,
                            flutter::FlutterViewId view_id,
-                           std::optional<flutter::FlutterViewId> parent_view_id) const;
-  void sendOnWindowDestroyed(flutter::FlutterViewId view_id) const;
-  void sendOnWindowResized(flutter::FlutterViewId view_id) const;
+                           std::optional<flutter::FlutterViewId> parent_view_id);
+  void sendOnWindowDestroyed(flutter::FlutterViewId view_id);
+  void sendOnWindowResized(flutter::FlutterViewId view_id);
+  void sendOnWindowVisibilityChanged(flutter::FlutterViewId view_id,
+                                     flw::Visibility visibility);
+  void queueEvent(Event event);
+  void sendEvent(flutter::MethodChannel<> &channel, Event const &event);
   void cleanupClosedWindows();
 
   mutable std::mutex mutex_;
-  std::unique_ptr<flutter::MethodChannel<>> channel_;
-  std::shared_ptr<flutter::FlutterEngine> engine_;
+  // Indexed by EngineId.
+  std::vector<Engine> engines_;
+  // The windows of all engines, keyed by window ID.
   WindowMap windows_;
+  // Hidden tips kept for reuse by createTipWindow.
+  std::vector<std::unique_ptr<FlutterWindow>> tip_pool_;
+  uint64_t memory_budget_ = 0;
+  std::atomic<uint64_t> sent_event_count_{0};
+  // The sequence number of the last event queued.
+  std::atomic<uint64_t> event_sequence_{0};
+  // The parent each window was announced with, as sent in onWindowCreated or
+  // the reply creating it.
+  std::unordered_map<flutter::FlutterViewId,
+                     std::optional<flutter::FlutterViewId>>
+      parents_;
+  flw::MpscQueue<Event> events_;
+  // The number of queued events not yet popped by flushEvents.
+  std::atomic<size_t> queued_events_{0};
+  // Set while a thread is in flushEvents, the queue's single consumer.
+  std::atomic_flag flushing_;
 };
 
 #endif // RUNNER_FLUTTER_WINDOW_MANAGER_H_
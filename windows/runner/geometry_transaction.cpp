@@ -0,0 +1,23 @@
+#include "geometry_transaction.h"
+
+#include <algorithm>
+#include <utility>
+
+void GeometryTransaction::SetFrame(HWND window, RECT const &frame) {
+  auto const it{std::ranges::find(changes_, window, &GeometryChange::window)};
+  if (it != changes_.end()) {
+    it->frame = frame;
+  } else {
+    changes_.push_back({.window = window, .frame = frame});
+  }
+}
+
+void GeometryTransaction::Commit() {
+  if (changes_.empty()) {
+    return;
+  }
+  // Hand the changes over before committing, as committing delivers messages
+  // whose handlers may start transactions of their own.
+  auto const changes{std::exchange(changes_, {})};
+  WindowBackend::instance().CommitGeometry(changes);
+}
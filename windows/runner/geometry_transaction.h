@@ -0,0 +1,38 @@
+#ifndef RUNNER_GEOMETRY_TRANSACTION_H_
+#define RUNNER_GEOMETRY_TRANSACTION_H_
+
+#include <vector>
+
+#include "window_backend.h"
+
+// Collects the geometry changes of a top-level window, its hosted Flutter
+// content and its attached popups, and applies them together with a single
+// WindowBackend::CommitGeometry call. Frames equal to the ones the windows
+// already have are dropped at commit time, so committing repaints nothing that
+// did not move.
+//
+// Pending changes are committed when the transaction goes out of scope.
+class GeometryTransaction {
+public:
+  GeometryTransaction() = default;
+  ~GeometryTransaction() { Commit(); }
+
+  GeometryTransaction(GeometryTransaction const &) = delete;
+  GeometryTransaction &operator=(GeometryTransaction const &) = delete;
+
+  // Sets the frame |window| will have once committed, replacing any earlier
+  // change to |window| in this transaction. |frame| is in screen coordinates
+  // for top-level windows and in client coordinates of the parent for child
+  // windows.
+  void SetFrame(HWND window, RECT const &frame);
+
+  bool empty() const { return changes_.empty(); }
+
+  // Applies the pending changes. Does nothing if there are none.
+  void Commit();
+
+private:
+  std::vector<GeometryChange> changes_;
+};
+
+#endif // RUNNER_GEOMETRY_TRANSACTION_H_
@@ -0,0 +1,84 @@
+#include "headless_flutter_engine.h"
+
+#include <utility>
+
+namespace {
+
+class HeadlessFlutterView : public FlutterViewHost {
+public:
+  HeadlessFlutterView(HeadlessWindowBackend &backend,
+                      flutter::FlutterViewId view_id, int width, int height)
+      : backend_(backend), view_id_(view_id),
+        window_(backend.CreateContentWindow(RECT{0, 0, width, height})) {}
+
+  ~HeadlessFlutterView() override { backend_.DestroyNativeWindow(window_); }
+
+  auto view_id() const -> flutter::FlutterViewId override { return view_id_; }
+
+  auto GetNativeWindow() -> HWND override { return window_; }
+
+  auto HandleTopLevelWindowProc(HWND, UINT, WPARAM, LPARAM)
+      -> std::optional<LRESULT> override {
+    return std::nullopt;
+  }
+
+private:
+  HeadlessWindowBackend &backend_;
+  flutter::FlutterViewId const view_id_;
+  HWND const window_;
+};
+
+} // namespace
+
+bool HeadlessBinaryMessenger::Deliver(std::string const &channel,
+                                      std::vector<uint8_t> const &data,
+                                      flutter::BinaryReply reply) {
+  auto const it{handlers_.find(channel)};
+  if (it == handlers_.end() || !it->second) {
+    return false;
+  }
+  it->second(data.data(), data.size(),
+             reply ? std::move(reply) : [](uint8_t const *, size_t) {});
+  return true;
+}
+
+void HeadlessBinaryMessenger::Send(std::string const &channel,
+                                   uint8_t const *message, size_t message_size,
+                                   flutter::BinaryReply) const {
+  sent_messages_.push_back(
+      {.channel = channel, .data = {message, message + message_size}});
+  if (send_observer_) {
+    // A copy, as the observer may send more.
+    auto const sent{sent_messages_.back()};
+    send_observer_(sent);
+  }
+}
+
+void HeadlessBinaryMessenger::SetMessageHandler(
+    std::string const &channel, flutter::BinaryMessageHandler handler) {
+  if (handler) {
+    handlers_[channel] = std::move(handler);
+  } else {
+    handlers_.erase(channel);
+  }
+}
+
+HeadlessFlutterEngine::HeadlessFlutterEngine(HeadlessWindowBackend &backend)
+    : backend_(backend) {}
+
+void HeadlessFlutterEngine::RenderFrame() {
+  if (auto callback{std::exchange(next_frame_callback_, nullptr)}) {
+    callback();
+  }
+}
+
+auto HeadlessFlutterEngine::CreateView(int width, int height)
+    -> std::unique_ptr<FlutterViewHost> {
+  return std::make_unique<HeadlessFlutterView>(backend_, next_view_id_++,
+                                               width, height);
+}
+
+void HeadlessFlutterEngine::SetNextFrameCallback(
+    std::function<void()> callback) {
+  next_frame_callback_ = std::move(callback);
+}
@@ -0,0 +1,83 @@
+#ifndef RUNNER_HEADLESS_FLUTTER_ENGINE_H_
+#define RUNNER_HEADLESS_FLUTTER_ENGINE_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flutter_engine_host.h"
+#include "headless_window_backend.h"
+
+// A BinaryMessenger that records what the runner sends to Dart and lets a
+// driver deliver messages as if they came from Dart.
+class HeadlessBinaryMessenger : public flutter::BinaryMessenger {
+public:
+  struct Message {
+    std::string channel;
+    std::vector<uint8_t> data;
+  };
+
+  // Delivers |data| to the handler of |channel|, as if Dart had sent it.
+  // Returns false if no handler is set.
+  bool Deliver(std::string const &channel, std::vector<uint8_t> const &data,
+               flutter::BinaryReply reply = nullptr);
+
+  auto sent_messages() const -> std::vector<Message> const & {
+    return sent_messages_;
+  }
+  void ClearSentMessages() { sent_messages_.clear(); }
+
+  // Calls |observer| with each message the runner sends, once recorded, as
+  // Dart receiving it would. It may call back into the runner.
+  void SetSendObserver(std::function<void(Message const &)> observer) {
+    send_observer_ = std::move(observer);
+  }
+
+  // flutter::BinaryMessenger:
+  void Send(std::string const &channel, uint8_t const *message,
+            size_t message_size,
+            flutter::BinaryReply reply = nullptr) const override;
+  void SetMessageHandler(std::string const &channel,
+                         flutter::BinaryMessageHandler handler) override;
+
+private:
+  // Send is const in the BinaryMessenger interface.
+  mutable std::vector<Message> sent_messages_;
+  std::function<void(Message const &)> send_observer_;
+  std::map<std::string, flutter::BinaryMessageHandler> handlers_;
+};
+
+// A FlutterEngineHost without an engine, for running the window manager on a
+// HeadlessWindowBackend. Views are content windows of |backend| and never
+// render; RenderFrame runs the pending next-frame callback as if they had.
+class HeadlessFlutterEngine : public FlutterEngineHost {
+public:
+  explicit HeadlessFlutterEngine(HeadlessWindowBackend &backend);
+
+  auto headless_messenger() -> HeadlessBinaryMessenger & { return messenger_; }
+
+  // Runs the pending next-frame callback, if any.
+  void RenderFrame();
+
+  // FlutterEngineHost:
+  auto CreateView(int width, int height)
+      -> std::unique_ptr<FlutterViewHost> override;
+  auto messenger() -> flutter::BinaryMessenger * override {
+    return &messenger_;
+  }
+  void ReloadSystemFonts() override {}
+
+protected:
+  void SetNextFrameCallback(std::function<void()> callback) override;
+
+private:
+  HeadlessWindowBackend &backend_;
+  HeadlessBinaryMessenger messenger_;
+  flutter::FlutterViewId next_view_id_ = 0;
+  std::function<void()> next_frame_callback_;
+};
+
+#endif // RUNNER_HEADLESS_FLUTTER_ENGINE_H_
@@ -0,0 +1,354 @@
+#include "headless_window_backend.h"
+
+#include <vector>
+
+namespace {
+
+auto Width(RECT const &rect) -> LONG { return rect.right - rect.left; }
+auto Height(RECT const &rect) -> LONG { return rect.bottom - rect.top; }
+
+auto EqualFrames(RECT const &a, RECT const &b) -> bool {
+  return a.left == b.left && a.top == b.top && a.right == b.right &&
+         a.bottom == b.bottom;
+}
+
+} // namespace
+
+HWND HeadlessWindowBackend::CreateContentWindow(RECT const &frame) {
+  auto *const handle{NextHandle()};
+  windows_[handle] = {.owner = nullptr,
+                      .parent = nullptr,
+                      .frame = frame,
+                      .visible = true,
+                      .destroying = false,
+                      .occlusion = {},
+                      .timers = {}};
+  ++counters_.windows_created;
+  return handle;
+}
+
+HWND HeadlessWindowBackend::CreateNativeWindow(Win32Window *owner,
+                                               std::wstring const &,
+                                               DWORD style, DWORD,
+                                               RECT const &frame, HWND parent) {
+  auto *const handle{NextHandle()};
+  windows_[handle] = {.owner = owner,
+                      .parent = parent,
+                      .frame = frame,
+                      .visible = (style & WS_VISIBLE) != 0,
+                      .destroying = false,
+                      .occlusion = {},
+                      .timers = {}};
+  ++counters_.windows_created;
+  AttachHandle(owner, handle);
+
+  SendWindowMessage(handle, WM_CREATE, 0, 0);
+  SendWindowMessage(handle, WM_SIZE, SIZE_RESTORED,
+                    MAKELPARAM(Width(frame), Height(frame)));
+  if (style & WS_VISIBLE) {
+    SendWindowMessage(handle, WM_SHOWWINDOW, TRUE, 0);
+    Activate(handle);
+  }
+  return handle;
+}
+
+void HeadlessWindowBackend::DestroyNativeWindow(HWND window) {
+  auto const it{windows_.find(window)};
+  if (it == windows_.end() || it->second.destroying) {
+    return;
+  }
+  it->second.destroying = true;
+
+  // Like DestroyWindow, destroy the owned windows first, then send WM_DESTROY
+  // to the window before its child windows.
+  std::vector<HWND> owned;
+  std::vector<HWND> children;
+  for (auto const &[handle, record] : windows_) {
+    if (record.parent == window) {
+      (record.owner ? owned : children).push_back(handle);
+    }
+  }
+  for (auto *const handle : owned) {
+    DestroyNativeWindow(handle);
+  }
+
+  if (active_ == window) {
+    active_ = nullptr;
+  }
+  if (focus_ == window) {
+    focus_ = nullptr;
+  }
+  SendWindowMessage(window, WM_DESTROY, 0, 0);
+  for (auto *const handle : children) {
+    DestroyNativeWindow(handle);
+  }
+  SendWindowMessage(window, WM_NCDESTROY, 0, 0);
+  windows_.erase(window);
+  ++counters_.windows_destroyed;
+}
+
+Win32Window *HeadlessWindowBackend::GetWindowFromHandle(HWND window) {
+  auto const it{windows_.find(window)};
+  return it != windows_.end() ? it->second.owner : nullptr;
+}
+
+HWND HeadlessWindowBackend::GetParentHandle(HWND window) {
+  auto const it{windows_.find(window)};
+  return it != windows_.end() ? it->second.parent : nullptr;
+}
+
+void HeadlessWindowBackend::SetParent(HWND child, HWND parent) {
+  if (auto const it{windows_.find(child)}; it != windows_.end()) {
+    it->second.parent = parent;
+  }
+}
+
+void HeadlessWindowBackend::SetOwner(HWND window, HWND owner) {
+  SetParent(window, owner);
+}
+
+void HeadlessWindowBackend::SetVisible(HWND window, bool visible) {
+  auto const it{windows_.find(window)};
+  if (it == windows_.end() || it->second.visible == visible) {
+    return;
+  }
+  it->second.visible = visible;
+  SendWindowMessage(window, WM_SHOWWINDOW, visible, 0);
+}
+
+bool HeadlessWindowBackend::IsVisible(HWND window) const {
+  auto const it{windows_.find(window)};
+  return it != windows_.end() && it->second.visible;
+}
+
+void HeadlessWindowBackend::CommitGeometry(
+    std::span<GeometryChange const> changes) {
+  struct Applied {
+    HWND window;
+    RECT previous;
+    RECT frame;
+  };
+  std::vector<Applied> applied;
+  for (auto const &[window, requested] : changes) {
+    auto it{windows_.find(window)};
+    if (it == windows_.end() || EqualFrames(it->second.frame, requested)) {
+      continue;
+    }
+    // Like SetWindowPos, let the window see and adjust the change first.
+    auto const previous{it->second.frame};
+    WINDOWPOS position{.hwnd = window,
+                       .hwndInsertAfter = nullptr,
+                       .x = requested.left,
+                       .y = requested.top,
+                       .cx = Width(requested),
+                       .cy = Height(requested),
+                       .flags = SWP_NOZORDER | SWP_NOACTIVATE};
+    if (previous.left == requested.left && previous.top == requested.top) {
+      position.flags |= SWP_NOMOVE;
+    }
+    if (Width(previous) == Width(requested) &&
+        Height(previous) == Height(requested)) {
+      position.flags |= SWP_NOSIZE;
+    }
+    SendWindowMessage(window, WM_WINDOWPOSCHANGING, 0,
+                      reinterpret_cast<LPARAM>(&position));
+    it = windows_.find(window);
+    if (it == windows_.end()) {
+      continue;
+    }
+    RECT const frame{position.x, position.y, position.x + position.cx,
+                     position.y + position.cy};
+    applied.push_back(
+        {.window = window, .previous = it->second.frame, .frame = frame});
+    it->second.frame = frame;
+    ++counters_.frame_changes;
+  }
+  if (applied.empty()) {
+    return;
+  }
+  ++counters_.geometry_batches;
+  for (auto const &[window, previous, frame] : applied) {
+    NotifyFrameChanged(window, previous, frame);
+  }
+}
+
+RECT HeadlessWindowBackend::GetClientRectForFrame(HWND, RECT const &frame,
+                                                  UINT) {
+  return {0, 0, Width(frame), Height(frame)};
+}
+
+RECT HeadlessWindowBackend::GetClientRect(HWND window) {
+  auto const it{windows_.find(window)};
+  if (it == windows_.end()) {
+    return {0, 0, 0, 0};
+  }
+  // Headless windows have no non-client area.
+  return {0, 0, Width(it->second.frame), Height(it->second.frame)};
+}
+
+POINT HeadlessWindowBackend::GetClientOrigin(HWND window) {
+  auto const frame{GetWindowRect(window)};
+  return {frame.left, frame.top};
+}
+
+RECT HeadlessWindowBackend::GetWindowRect(HWND window) {
+  auto const it{windows_.find(window)};
+  return it != windows_.end() ? it->second.frame : RECT{0, 0, 0, 0};
+}
+
+RECT HeadlessWindowBackend::GetExtendedFrameBounds(HWND window) {
+  return GetWindowRect(window);
+}
+
+LRESULT HeadlessWindowBackend::SendWindowMessage(HWND window, UINT message,
+                                                 WPARAM wparam, LPARAM lparam) {
+  auto const it{windows_.find(window)};
+  if (it == windows_.end()) {
+    return 0;
+  }
+  ++counters_.messages_sent;
+  if (auto *const owner{it->second.owner}) {
+    return Dispatch(owner, window, message, wparam, lparam);
+  }
+  return DefaultWindowProc(window, message, wparam, lparam);
+}
+
+LRESULT HeadlessWindowBackend::DefaultWindowProc(HWND window, UINT message,
+                                                 WPARAM, LPARAM) {
+  if (message == WM_CLOSE) {
+    DestroyNativeWindow(window);
+  }
+  return 0;
+}
+
+void HeadlessWindowBackend::ChangeDpi(HWND window, UINT dpi,
+                                      RECT const &suggested) {
+  dpi_ = dpi;
+  auto frame{suggested};
+  SendWindowMessage(window, WM_DPICHANGED, MAKEWPARAM(dpi, dpi),
+                    reinterpret_cast<LPARAM>(&frame));
+}
+
+void HeadlessWindowBackend::SetOcclusion(HWND window,
+                                         WindowOcclusion const &occlusion) {
+  if (auto const it{windows_.find(window)}; it != windows_.end()) {
+    it->second.occlusion = occlusion;
+  }
+}
+
+void HeadlessWindowBackend::FireTimers() {
+  std::vector<std::pair<HWND, uintptr_t>> timers;
+  for (auto const &[handle, record] : windows_) {
+    for (auto const id : record.timers) {
+      timers.emplace_back(handle, id);
+    }
+  }
+  for (auto const &[handle, id] : timers) {
+    SendWindowMessage(handle, WM_TIMER, id, 0);
+  }
+}
+
+WindowOcclusion HeadlessWindowBackend::QueryOcclusion(HWND window) {
+  ++counters_.occlusion_queries;
+  auto const it{windows_.find(window)};
+  return it != windows_.end() ? it->second.occlusion : WindowOcclusion{};
+}
+
+void HeadlessWindowBackend::SetTimer(HWND window, uintptr_t id,
+                                     std::chrono::milliseconds) {
+  if (auto const it{windows_.find(window)}; it != windows_.end()) {
+    it->second.timers.insert(id);
+  }
+}
+
+void HeadlessWindowBackend::KillTimer(HWND window, uintptr_t id) {
+  if (auto const it{windows_.find(window)}; it != windows_.end()) {
+    it->second.timers.erase(id);
+  }
+}
+
+void HeadlessWindowBackend::PostQuit(int exit_code) {
+  quit_requested_ = true;
+  exit_code_ = exit_code;
+}
+
+bool HeadlessWindowBackend::PostTask(std::function<void()> task) {
+  std::lock_guard const lock(tasks_mutex_);
+  if (post_task_fails_) {
+    return false;
+  }
+  tasks_.push_back(std::move(task));
+  return true;
+}
+
+void HeadlessWindowBackend::SetPostTaskFails(bool fails) {
+  std::lock_guard const lock(tasks_mutex_);
+  post_task_fails_ = fails;
+}
+
+size_t HeadlessWindowBackend::RunPostedTasks() {
+  size_t count{0};
+  for (;;) {
+    std::vector<std::function<void()>> tasks;
+    {
+      std::lock_guard const lock(tasks_mutex_);
+      tasks.swap(tasks_);
+    }
+    if (tasks.empty()) {
+      return count;
+    }
+    for (auto &task : tasks) {
+      task();
+    }
+    count += tasks.size();
+  }
+}
+
+HWND HeadlessWindowBackend::NextHandle() {
+  // Handles are never dereferenced; keep them distinct and non-null.
+  return reinterpret_cast<HWND>(++next_handle_);
+}
+
+void HeadlessWindowBackend::Activate(HWND window) {
+  if (active_ == window) {
+    return;
+  }
+  auto *const previous{active_};
+  active_ = window;
+  ++counters_.activations;
+  if (previous) {
+    SendWindowMessage(previous, WM_NCACTIVATE, FALSE, 0);
+    SendWindowMessage(previous, WM_ACTIVATE, WA_INACTIVE,
+                      reinterpret_cast<LPARAM>(window));
+  }
+  SendWindowMessage(window, WM_NCACTIVATE, TRUE, 0);
+  SendWindowMessage(window, WM_ACTIVATE, WA_ACTIVE,
+                    reinterpret_cast<LPARAM>(previous));
+}
+
+void HeadlessWindowBackend::NotifyFrameChanged(HWND window,
+                                               RECT const &previous,
+                                               RECT const &frame) {
+  WINDOWPOS position{.hwnd = window,
+                     .hwndInsertAfter = nullptr,
+                     .x = frame.left,
+                     .y = frame.top,
+                     .cx = Width(frame),
+                     .cy = Height(frame),
+                     .flags = SWP_NOZORDER | SWP_NOACTIVATE};
+  if (previous.left == frame.left && previous.top == frame.top) {
+    position.flags |= SWP_NOMOVE;
+  }
+  if (Width(previous) == Width(frame) && Height(previous) == Height(frame)) {
+    position.flags |= SWP_NOSIZE;
+  }
+  SendWindowMessage(window, WM_WINDOWPOSCHANGED, 0,
+                    reinterpret_cast<LPARAM>(&position));
+  if (previous.left != frame.left || previous.top != frame.top) {
+    SendWindowMessage(window, WM_MOVE, 0, MAKELPARAM(frame.left, frame.top));
+  }
+  if (Width(previous) != Width(frame) || Height(previous) != Height(frame)) {
+    SendWindowMessage(window, WM_SIZE, SIZE_RESTORED,
+                      MAKELPARAM(Width(frame), Height(frame)));
+  }
+}
@@ -0,0 +1,152 @@
+#ifndef RUNNER_HEADLESS_WINDOW_BACKEND_H_
+#define RUNNER_HEADLESS_WINDOW_BACKEND_H_
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "window_backend.h"
+
+// A WindowBackend that keeps windows in memory instead of on a display.
+//
+// Windows are plain records holding their frame and parent. Messages are
+// delivered synchronously, in the order Win32 would deliver the ones the runner
+// relies on: creation sends WM_SIZE and activates the window, geometry changes
+// send WM_WINDOWPOSCHANGING before moving the window, destruction
+// destroys owned and child windows first and then sends WM_DESTROY, and
+// WM_CLOSE reaching DefaultWindowProc destroys the window. Every window sits on
+// a single monitor with a configurable DPI.
+class HeadlessWindowBackend : public WindowBackend {
+public:
+  // The number of native operations performed, for stress runs.
+  struct Counters {
+    uint64_t windows_created;
+    uint64_t windows_destroyed;
+    uint64_t frame_changes;
+    uint64_t geometry_batches;
+    uint64_t messages_sent;
+    uint64_t activations;
+    uint64_t occlusion_queries;
+  };
+
+  HeadlessWindowBackend() = default;
+
+  // Creates a window standing in for the native window of a Flutter view.
+  HWND CreateContentWindow(RECT const &frame);
+
+  // Sets the bounds of the monitor all windows are on, and its work area, the
+  // whole monitor by default.
+  void SetMonitorRect(RECT const &monitor,
+                      std::optional<RECT> work_area = std::nullopt) {
+    monitor_ = monitor;
+    work_area_ = work_area.value_or(monitor);
+  }
+  void SetDpi(UINT dpi) { dpi_ = dpi; }
+
+  // Moves the monitor to |dpi| and sends WM_DPICHANGED to |window| with
+  // |suggested| as its new frame, as Windows does when a window crosses to a
+  // monitor with a different DPI.
+  void ChangeDpi(HWND window, UINT dpi, RECT const &suggested);
+
+  // Sets what QueryOcclusion reports for |window|.
+  void SetOcclusion(HWND window, WindowOcclusion const &occlusion);
+
+  // Sends WM_TIMER for every running timer, as if their intervals elapsed.
+  void FireTimers();
+
+  // Runs the tasks posted so far, including those they post, as the message
+  // loop would. Returns the number of tasks run.
+  size_t RunPostedTasks();
+  // Makes PostTask fail and drop its task, as when the message queue is full.
+  void SetPostTaskFails(bool fails);
+
+  // Returns whether PostQuit has been called, and the exit code it was given.
+  bool quit_requested() const { return quit_requested_; }
+  int exit_code() const { return exit_code_; }
+
+  // Returns the number of windows that currently exist, including content
+  // windows.
+  size_t window_count() const { return windows_.size(); }
+
+  HWND active_window() const { return active_; }
+  HWND focus() const { return focus_; }
+  bool IsVisible(HWND window) const;
+
+  Counters const &counters() const { return counters_; }
+
+  // WindowBackend:
+  HWND CreateNativeWindow(Win32Window *owner, std::wstring const &title,
+                          DWORD style, DWORD ex_style, RECT const &frame,
+                          HWND parent) override;
+  void DestroyNativeWindow(HWND window) override;
+  void OnLastWindowDestroyed() override {}
+  Win32Window *GetWindowFromHandle(HWND window) override;
+  HWND GetParentHandle(HWND window) override;
+  void SetParent(HWND child, HWND parent) override;
+  void SetOwner(HWND window, HWND owner) override;
+  void SetVisible(HWND window, bool visible) override;
+  void CommitGeometry(std::span<GeometryChange const> changes) override;
+  RECT GetClientRectForFrame(HWND window, RECT const &frame,
+                             UINT dpi) override;
+  void SetFocus(HWND window) override { focus_ = window; }
+  RECT GetClientRect(HWND window) override;
+  POINT GetClientOrigin(HWND window) override;
+  RECT GetWindowRect(HWND window) override;
+  RECT GetExtendedFrameBounds(HWND window) override;
+  RECT GetMonitorRect(HWND) override { return monitor_; }
+  RECT GetWorkArea(HWND) override { return work_area_; }
+  UINT GetDpiForWindow(HWND) override { return dpi_; }
+  UINT GetDpiForPoint(POINT) override { return dpi_; }
+  WindowOcclusion QueryOcclusion(HWND window) override;
+  void SetTimer(HWND window, uintptr_t id,
+                std::chrono::milliseconds interval) override;
+  void KillTimer(HWND window, uintptr_t id) override;
+  void UpdateTheme(HWND) override {}
+  LRESULT SendWindowMessage(HWND window, UINT message, WPARAM wparam,
+                            LPARAM lparam) override;
+  LRESULT DefaultWindowProc(HWND window, UINT message, WPARAM wparam,
+                            LPARAM lparam) override;
+  void PostQuit(int exit_code) override;
+  bool PostTask(std::function<void()> task) override;
+
+private:
+  struct Window {
+    // The Win32Window attached to the window, or nullptr for content windows.
+    Win32Window *owner;
+    HWND parent;
+    RECT frame;
+    bool visible;
+    bool destroying;
+    WindowOcclusion occlusion;
+    std::set<uintptr_t> timers;
+  };
+
+  HWND NextHandle();
+
+  // Makes |window| the active window, deactivating the previous one.
+  void Activate(HWND window);
+
+  // Sends WM_WINDOWPOSCHANGED and the move and resize messages for |window|
+  // going from |previous| to |frame|.
+  void NotifyFrameChanged(HWND window, RECT const &previous, RECT const &frame);
+
+  std::unordered_map<HWND, Window> windows_;
+  uintptr_t next_handle_ = 0;
+  HWND active_ = nullptr;
+  HWND focus_ = nullptr;
+  RECT monitor_{0, 0, 1920, 1080};
+  RECT work_area_{monitor_};
+  UINT dpi_ = 96;
+  bool quit_requested_ = false;
+  int exit_code_ = 0;
+  Counters counters_{};
+  // PostTask is the only method called from other threads.
+  std::mutex tasks_mutex_;
+  std::vector<std::function<void()>> tasks_;
+  bool post_task_fails_ = false;
+};
+
+#endif // RUNNER_HEADLESS_WINDOW_BACKEND_H_
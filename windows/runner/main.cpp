@@ -1,8 +1,13 @@
 #include <flutter/generated_plugin_registrant.h>
 #include <windows.h>
 
+#include "flutter_engine_host.h"
 #include "flutter_window_manager.h"
+#include "message_replay.h"
+#include "trace_event.h"
 #include "utils.h"
+#include "window_command_queue.h"
+#include "window_layout.h"
 
 int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
                       _In_ wchar_t *command_line, _In_ int show_command) {
@@ -25,22 +30,51 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
   auto const engine{std::make_shared<flutter::FlutterEngine>(project)};
   RegisterPlugins(engine.get());
 
-  FlutterWindowManager::instance().setEngine(engine);
-  if (!FlutterWindowManager::instance().createRegularWindow(
-          L"Main window", {10, 10}, {700, 650}) ||
-      !FlutterWindowManager::instance().createRegularWindow(
-          L"window #1", {710, 10}, {400, 320}) ||
-      !FlutterWindowManager::instance().createRegularWindow(
-          L"window #2", {710, 340}, {400, 320})) {
+#if defined(FLW_ENABLE_REPLAY)
+  StartRecordingFromEnvironment();
+#endif
+
+  FlutterWindowManager::instance().setEngine(
+      std::make_shared<DesktopFlutterEngineHost>(engine));
+  WindowCommandQueue::instance().AttachToCurrentThread();
+#if defined(FLW_ENABLE_LAZY_VIEWS)
+  // Only the windows found visible get a view right away.
+  constexpr auto view_creation{ViewCreation::deferred};
+#else
+  constexpr auto view_creation{ViewCreation::immediate};
+#endif
+  auto restored{false};
+#if defined(FLW_ENABLE_LAYOUT_RESTORE)
+  restored = flw::WindowLayout::instance().Open(FLW_LAYOUT_FILE) &&
+             FlutterWindowManager::instance().restoreLayout(view_creation);
+#endif
+  if (!restored &&
+      (!FlutterWindowManager::instance().createRegularWindow(
+           L"Main window", {10, 10}, {700, 650}, 0, view_creation) ||
+       !FlutterWindowManager::instance().createRegularWindow(
+           L"window #1", {710, 10}, {400, 320}, 0, view_creation) ||
+       !FlutterWindowManager::instance().createRegularWindow(
+           L"window #2", {710, 340}, {400, 320}, 0, view_creation))) {
     return EXIT_FAILURE;
   }
 
+#if defined(FLW_ENABLE_REPLAY)
+  if (ReplayFromEnvironment()) {
+    ::CoUninitialize();
+    return EXIT_SUCCESS;
+  }
+#endif
+
   ::MSG msg;
   while (::GetMessage(&msg, nullptr, 0, 0)) {
     ::TranslateMessage(&msg);
     ::DispatchMessage(&msg);
+    WindowCommandQueue::instance().RunStalled();
   }
 
+  flw::WindowLayout::instance().Freeze();
+  FLW_TRACE_FLUSH();
+
   ::CoUninitialize();
   return EXIT_SUCCESS;
 }
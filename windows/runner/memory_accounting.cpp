@@ -0,0 +1,156 @@
+#include "memory_accounting.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace flw::memory {
+
+#if defined(FLW_ENABLE_ALLOCATION_ACCOUNTING)
+
+namespace {
+
+std::atomic<uint64_t> g_allocation_count{0};
+thread_local MemoryCounters *t_owner{nullptr};
+
+// Prefixed to every allocation so that its release is charged to the window
+// that made it. Keeps the returned pointer aligned for any fundamental type.
+struct alignas(alignof(std::max_align_t)) AllocationHeader {
+  MemoryCounters *owner;
+  std::size_t size;
+};
+
+} // namespace
+
+ScopedAllocationOwner::ScopedAllocationOwner(MemoryCounters *counters)
+    : previous_(t_owner) {
+  t_owner = counters;
+}
+
+ScopedAllocationOwner::~ScopedAllocationOwner() { t_owner = previous_; }
+
+// static
+auto MemoryAccounting::allocation_count() -> uint64_t {
+  return g_allocation_count.load(std::memory_order_relaxed);
+}
+
+#else
+
+// static
+auto MemoryAccounting::allocation_count() -> uint64_t { return 0; }
+
+#endif // defined(FLW_ENABLE_ALLOCATION_ACCOUNTING)
+
+// static
+MemoryAccounting &MemoryAccounting::instance() {
+  // Never destroyed, so that allocations freed during static destruction still
+  // find their counters.
+  static auto *const instance{[] {
+    ScopedAllocationOwner const unowned(nullptr);
+    return new MemoryAccounting;
+  }()};
+  return *instance;
+}
+
+MemoryCounters *MemoryAccounting::CreateCounters() {
+  // The bookkeeping outlives the window, so it is charged to no window.
+  ScopedAllocationOwner const unowned(nullptr);
+  std::lock_guard const lock(mutex_);
+  if (!free_) {
+    return &counters_.emplace_back();
+  }
+  auto *const counters{std::exchange(free_, free_->next_free)};
+  counters->next_free = nullptr;
+  counters->runner_bytes.store(0, std::memory_order_relaxed);
+  counters->surface_bytes.store(0, std::memory_order_relaxed);
+  return counters;
+}
+
+void MemoryAccounting::ReleaseCounters(MemoryCounters *counters) {
+  counters->surface_bytes.store(0, std::memory_order_relaxed);
+  counters->released.store(true);
+  RecycleIfUnused(counters);
+}
+
+void MemoryAccounting::RecycleIfUnused(MemoryCounters *counters) {
+  // Both the release and the last free may get here; only one recycles.
+  if (counters->runner_allocations.load() != 0 ||
+      !counters->released.exchange(false)) {
+    return;
+  }
+  std::lock_guard const lock(mutex_);
+  counters->next_free = free_;
+  free_ = counters;
+}
+
+} // namespace flw::memory
+
+#if defined(FLW_ENABLE_ALLOCATION_ACCOUNTING)
+
+namespace {
+
+// Allocates |size| bytes charged to the current owner, calling the new handler
+// until it succeeds if |retry|. Returns nullptr on failure.
+void *Allocate(std::size_t size, bool retry) {
+  using flw::memory::AllocationHeader;
+  AllocationHeader *header;
+  while (!(header = static_cast<AllocationHeader *>(
+               std::malloc(sizeof(AllocationHeader) + size)))) {
+    auto const handler{std::get_new_handler()};
+    if (!retry || !handler) {
+      return nullptr;
+    }
+    handler();
+  }
+  flw::memory::g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  header->owner = flw::memory::t_owner;
+  header->size = size;
+  if (auto *const owner{header->owner}) {
+    owner->runner_bytes.fetch_add(static_cast<int64_t>(size),
+                                  std::memory_order_relaxed);
+    owner->runner_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  return header + 1;
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+  if (auto *const pointer{Allocate(size, true)}) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::nothrow_t const &) noexcept {
+  return Allocate(size, false);
+}
+
+void operator delete(void *pointer) noexcept {
+  using flw::memory::AllocationHeader;
+  if (!pointer) {
+    return;
+  }
+  auto *const header{static_cast<AllocationHeader *>(pointer) - 1};
+  if (auto *const owner{header->owner}) {
+    owner->runner_bytes.fetch_sub(static_cast<int64_t>(header->size),
+                                  std::memory_order_relaxed);
+    if (owner->runner_allocations.fetch_sub(1) == 1 &&
+        owner->released.load()) {
+      flw::memory::ScopedAllocationOwner const unowned(nullptr);
+      flw::memory::MemoryAccounting::instance().RecycleIfUnused(owner);
+    }
+  }
+  std::free(header);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  operator delete(pointer);
+}
+
+void operator delete(void *pointer, std::nothrow_t const &) noexcept {
+  operator delete(pointer);
+}
+
+#endif // defined(FLW_ENABLE_ALLOCATION_ACCOUNTING)
@@ -0,0 +1,105 @@
+#ifndef RUNNER_MEMORY_ACCOUNTING_H_
+#define RUNNER_MEMORY_ACCOUNTING_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+// Per-window accounting of the memory a view costs: the runner's own heap
+// allocations made on the window's behalf, and an estimate of the engine
+// surface backing its content.
+//
+// Surface sizes are always tracked. Attributing heap allocations replaces the
+// global operator new and delete, and is compiled in through the
+// FLW_ENABLE_ALLOCATION_ACCOUNTING CMake option (also enabled by
+// FLW_ENABLE_REPLAY, whose reports count allocations). Allocations are charged
+// to the window whose ScopedAllocationOwner is active on the allocating thread,
+// which the runner sets only while creating a window's view, so that what is
+// charged lives and dies with the window. Allocations made while handling
+// messages are mostly shared state, such as statistics and registries, and are
+// charged to no window.
+namespace flw::memory {
+
+// Bytes per pixel assumed for the engine surface backing a view.
+inline constexpr uint64_t kSurfaceBytesPerPixel{4};
+
+struct MemoryCounters {
+  // Live heap bytes and allocations charged to the window.
+  std::atomic<int64_t> runner_bytes{0};
+  std::atomic<int64_t> runner_allocations{0};
+  std::atomic<uint64_t> surface_bytes{0};
+
+  // Set from the window's destruction until the counters are recycled, which
+  // happens once the last allocation charged to them is freed.
+  std::atomic<bool> released{false};
+  // The next counters in MemoryAccounting's free list.
+  MemoryCounters *next_free = nullptr;
+
+  void SetSurfaceSize(int64_t width, int64_t height) {
+    surface_bytes.store(static_cast<uint64_t>(width > 0 ? width : 0) *
+                            static_cast<uint64_t>(height > 0 ? height : 0) *
+                            kSurfaceBytesPerPixel,
+                        std::memory_order_relaxed);
+  }
+
+  auto total_bytes() const -> uint64_t {
+    auto const runner{runner_bytes.load(std::memory_order_relaxed)};
+    return (runner > 0 ? static_cast<uint64_t>(runner) : 0) +
+           surface_bytes.load(std::memory_order_relaxed);
+  }
+};
+
+class MemoryAccounting {
+public:
+  static MemoryAccounting &instance();
+
+  // Returns zeroed counters for a window.
+  MemoryCounters *CreateCounters();
+
+  // Returns the counters of a destroyed window. They are reused once every
+  // allocation charged to them has been freed; until then they stay valid, so
+  // that late frees remain balanced.
+  void ReleaseCounters(MemoryCounters *counters);
+
+  // Makes released |counters| reusable if no allocation charged to them is
+  // live. Called as the last one is freed.
+  void RecycleIfUnused(MemoryCounters *counters);
+
+  // Returns the number of heap allocations made by the runner since startup,
+  // or 0 when allocations are not accounted.
+  static auto allocation_count() -> uint64_t;
+
+private:
+  MemoryAccounting() = default;
+
+  std::mutex mutex_;
+  std::deque<MemoryCounters> counters_;
+  // Counters ready for reuse, linked through MemoryCounters::next_free, so that
+  // recycling them from operator delete does not allocate.
+  MemoryCounters *free_ = nullptr;
+};
+
+// Charges the heap allocations made on the current thread during its lifetime
+// to |counters|.
+class ScopedAllocationOwner {
+public:
+#if defined(FLW_ENABLE_ALLOCATION_ACCOUNTING)
+  explicit ScopedAllocationOwner(MemoryCounters *counters);
+  ~ScopedAllocationOwner();
+#else
+  explicit ScopedAllocationOwner(MemoryCounters *) {}
+#endif
+
+  ScopedAllocationOwner(ScopedAllocationOwner const &) = delete;
+  ScopedAllocationOwner &operator=(ScopedAllocationOwner const &) = delete;
+
+#if defined(FLW_ENABLE_ALLOCATION_ACCOUNTING)
+private:
+  MemoryCounters *previous_;
+#endif
+};
+
+} // namespace flw::memory
+
+#endif // RUNNER_MEMORY_ACCOUNTING_H_
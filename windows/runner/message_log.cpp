@@ -0,0 +1,162 @@
+#include "message_log.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace flw::log {
+
+namespace {
+
+constexpr char kMagic[4]{'F', 'L', 'W', 'R'};
+
+} // namespace
+
+bool Writer::Open(std::filesystem::path const &path) {
+  out_.open(path, std::ios::binary | std::ios::trunc);
+  if (!out_) {
+    return false;
+  }
+  out_.write(kMagic, sizeof(kMagic));
+  out_.put(static_cast<char>(kVersion));
+  return static_cast<bool>(out_);
+}
+
+void Writer::Write(Record const &record) {
+  if (!out_.is_open()) {
+    return;
+  }
+  buffer_.clear();
+  buffer_.push_back(static_cast<uint8_t>(record.kind));
+  PutVarint(record.delta_us);
+  PutVarint(record.window);
+  switch (record.kind) {
+  case RecordKind::window_created:
+    PutSigned(record.archetype);
+    PutSigned(record.parent);
+    break;
+  case RecordKind::window_destroyed:
+    break;
+  case RecordKind::message:
+    PutVarint(record.message);
+    PutVarint(record.wparam);
+    PutSigned(record.lparam);
+    PutVarint(record.payload.size());
+    buffer_.insert(buffer_.end(), record.payload.begin(), record.payload.end());
+    break;
+  case RecordKind::method_call:
+    PutVarint(record.payload.size());
+    buffer_.insert(buffer_.end(), record.payload.begin(), record.payload.end());
+    break;
+  }
+  out_.write(reinterpret_cast<char const *>(buffer_.data()),
+             static_cast<std::streamsize>(buffer_.size()));
+}
+
+void Writer::PutVarint(uint64_t value) {
+  while (value >= 0x80) {
+    buffer_.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  buffer_.push_back(static_cast<uint8_t>(value));
+}
+
+void Writer::PutSigned(int64_t value) {
+  PutVarint((static_cast<uint64_t>(value) << 1) ^
+            static_cast<uint64_t>(value >> 63));
+}
+
+bool Reader::Open(std::filesystem::path const &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  data_.assign(std::istreambuf_iterator<char>(in),
+               std::istreambuf_iterator<char>());
+  position_ = sizeof(kMagic) + 1;
+  return data_.size() >= position_ &&
+         std::equal(std::begin(kMagic), std::end(kMagic), data_.begin()) &&
+         data_[sizeof(kMagic)] == kVersion;
+}
+
+std::optional<Record> Reader::Next() {
+  if (position_ >= data_.size()) {
+    return std::nullopt;
+  }
+  Record record{};
+  record.kind = static_cast<RecordKind>(data_[position_++]);
+  auto const delta{GetVarint()};
+  auto const window{GetVarint()};
+  if (!delta || !window) {
+    return std::nullopt;
+  }
+  record.delta_us = *delta;
+  record.window = static_cast<uint32_t>(*window);
+
+  auto const read_payload{[this, &record]() -> bool {
+    auto const size{GetVarint()};
+    if (!size || *size > data_.size() - position_) {
+      return false;
+    }
+    auto const begin{data_.begin() + static_cast<std::ptrdiff_t>(position_)};
+    record.payload.assign(begin, begin + static_cast<std::ptrdiff_t>(*size));
+    position_ += static_cast<size_t>(*size);
+    return true;
+  }};
+
+  switch (record.kind) {
+  case RecordKind::window_created: {
+    auto const archetype{GetSigned()};
+    auto const parent{GetSigned()};
+    if (!archetype || !parent) {
+      return std::nullopt;
+    }
+    record.archetype = static_cast<int32_t>(*archetype);
+    record.parent = *parent;
+    break;
+  }
+  case RecordKind::window_destroyed:
+    break;
+  case RecordKind::message: {
+    auto const message{GetVarint()};
+    auto const wparam{GetVarint()};
+    auto const lparam{GetSigned()};
+    if (!message || !wparam || !lparam || !read_payload()) {
+      return std::nullopt;
+    }
+    record.message = static_cast<uint32_t>(*message);
+    record.wparam = *wparam;
+    record.lparam = *lparam;
+    break;
+  }
+  case RecordKind::method_call:
+    if (!read_payload()) {
+      return std::nullopt;
+    }
+    break;
+  default:
+    return std::nullopt;
+  }
+  return record;
+}
+
+std::optional<uint64_t> Reader::GetVarint() {
+  uint64_t value{0};
+  for (int shift{0}; shift < 64 && position_ < data_.size(); shift += 7) {
+    auto const byte{data_[position_++]};
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<int64_t> Reader::GetSigned() {
+  auto const value{GetVarint()};
+  if (!value) {
+    return std::nullopt;
+  }
+  return static_cast<int64_t>(*value >> 1) ^ -static_cast<int64_t>(*value & 1);
+}
+
+} // namespace flw::log
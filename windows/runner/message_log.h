@@ -0,0 +1,85 @@
+#ifndef RUNNER_MESSAGE_LOG_H_
+#define RUNNER_MESSAGE_LOG_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Compact binary log of the window message stream and the flw/window calls
+// seen by the runner, used to record a scenario once and replay it later.
+//
+// A log starts with the 4-byte magic "FLWR" and a version byte, followed by
+// records. Every record starts with its kind byte and the time elapsed since
+// the previous record in microseconds; integers are LEB128 varints (zigzag
+// encoded when signed) so that typical records fit in a handful of bytes.
+namespace flw::log {
+
+inline constexpr uint8_t kVersion{1};
+
+enum class RecordKind : uint8_t {
+  // A Win32Window was created. Windows are identified by the order of their
+  // creation, which is deterministic for a given startup sequence.
+  window_created = 1,
+  // A Win32Window was destroyed.
+  window_destroyed = 2,
+  // A message was dispatched to a window's WndProc.
+  message = 3,
+  // A method call was received on the flw/window channel. |payload| holds the
+  // call encoded with the standard method codec.
+  method_call = 4,
+};
+
+struct Record {
+  RecordKind kind{};
+  uint64_t delta_us{};
+  uint32_t window{};
+  // window_created: the archetype and the parent window, or -1.
+  int32_t archetype{};
+  int64_t parent{};
+  // message: the message and its parameters. Pointer parameters are not
+  // replayable; for such messages |payload| carries the pointee instead.
+  uint32_t message{};
+  uint64_t wparam{};
+  int64_t lparam{};
+  std::vector<uint8_t> payload{};
+};
+
+class Writer {
+public:
+  // Opens |path| for writing and emits the header. Returns false on failure.
+  bool Open(std::filesystem::path const &path);
+  bool IsOpen() const { return out_.is_open(); }
+  void Write(Record const &record);
+  void Flush() { out_.flush(); }
+
+private:
+  void PutVarint(uint64_t value);
+  void PutSigned(int64_t value);
+
+  std::ofstream out_;
+  std::vector<uint8_t> buffer_;
+};
+
+class Reader {
+public:
+  // Opens |path| and validates the header. Returns false on failure.
+  bool Open(std::filesystem::path const &path);
+
+  // Returns the next record, or std::nullopt at the end of the log or on a
+  // truncated record.
+  std::optional<Record> Next();
+
+private:
+  std::optional<uint64_t> GetVarint();
+  std::optional<int64_t> GetSigned();
+
+  std::vector<uint8_t> data_;
+  size_t position_ = 0;
+};
+
+} // namespace flw::log
+
+#endif // RUNNER_MESSAGE_LOG_H_
@@ -0,0 +1,311 @@
+#include "message_replay.h"
+
+#if defined(FLW_ENABLE_REPLAY)
+
+#include <flutter/method_result_functions.h>
+#include <flutter/standard_method_codec.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <optional>
+
+#include "flutter_window_manager.h"
+#include "memory_accounting.h"
+#include "win32_window.h"
+#include "window_backend.h"
+
+namespace {
+
+// Returns whether |message| takes part in the scenarios worth replaying, and
+// is either free of pointer and handle parameters or has them sanitized by
+// OnMessage.
+bool IsReplayable(UINT message) {
+  switch (message) {
+  case WM_MOVE:
+  case WM_SIZE:
+  case WM_ACTIVATE:
+  case WM_CLOSE:
+  case WM_SHOWWINDOW:
+  case WM_SETTINGCHANGE:
+  case WM_ACTIVATEAPP:
+  case WM_FONTCHANGE:
+  case WM_MOUSEACTIVATE:
+  case WM_WINDOWPOSCHANGING:
+  case WM_WINDOWPOSCHANGED:
+  case WM_NCACTIVATE:
+  case WM_ENTERSIZEMOVE:
+  case WM_EXITSIZEMOVE:
+  case WM_DPICHANGED:
+  case WM_DWMCOLORIZATIONCOLORCHANGED:
+    return true;
+  default:
+    return false;
+  }
+}
+
+template <typename T> std::vector<uint8_t> BytesOf(T const &value) {
+  auto const *const begin{reinterpret_cast<uint8_t const *>(&value)};
+  return {begin, begin + sizeof(T)};
+}
+
+#if defined(_WIN32)
+using EnvironmentString = std::wstring;
+#define FLW_ENV(name) L##name
+
+std::optional<std::wstring> GetEnvironment(wchar_t const *name) {
+  auto const size{GetEnvironmentVariableW(name, nullptr, 0)};
+  if (size == 0) {
+    return std::nullopt;
+  }
+  std::wstring value(size, L'\0');
+  value.resize(GetEnvironmentVariableW(name, value.data(), size));
+  return value;
+}
+
+double ProcessCpuMilliseconds() {
+  FILETIME creation, exit, kernel, user;
+  if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel,
+                       &user)) {
+    return 0;
+  }
+  auto const to_100ns{[](FILETIME const &time) {
+    return (static_cast<uint64_t>(time.dwHighDateTime) << 32) |
+           time.dwLowDateTime;
+  }};
+  return static_cast<double>(to_100ns(kernel) + to_100ns(user)) / 10'000.0;
+}
+#else
+using EnvironmentString = std::string;
+#define FLW_ENV(name) name
+
+std::optional<std::string> GetEnvironment(char const *name) {
+  if (auto const *const value{std::getenv(name)}) {
+    return value;
+  }
+  return std::nullopt;
+}
+
+// std::clock measures the CPU time of the process outside Windows.
+double ProcessCpuMilliseconds() {
+  return 1000.0 * static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+#endif
+
+} // namespace
+
+bool MessageRecorder::Start(std::filesystem::path const &path) {
+  last_record_ = std::chrono::steady_clock::now();
+  return writer_.Open(path);
+}
+
+void MessageRecorder::OnWindowCreated(Win32Window *window,
+                                      flw::Archetype archetype,
+                                      Win32Window const *parent) {
+  auto const ordinal{next_ordinal_++};
+  ordinals_[window] = ordinal;
+  windows_[ordinal] = window;
+
+  auto const parent_it{ordinals_.find(parent)};
+  Write({.kind = flw::log::RecordKind::window_created,
+         .window = ordinal,
+         .archetype = static_cast<int32_t>(archetype),
+         .parent = parent_it != ordinals_.end()
+                       ? static_cast<int64_t>(parent_it->second)
+                       : -1});
+}
+
+void MessageRecorder::OnWindowDestroyed(Win32Window const *window) {
+  if (auto const it{ordinals_.find(window)}; it != ordinals_.end()) {
+    Write({.kind = flw::log::RecordKind::window_destroyed,
+           .window = it->second});
+    windows_.erase(it->second);
+    ordinals_.erase(it);
+  }
+}
+
+void MessageRecorder::OnMessage(Win32Window const *window, UINT message,
+                                WPARAM wparam, LPARAM lparam) {
+  if (!writer_.IsOpen() || !IsReplayable(message)) {
+    return;
+  }
+  auto const it{ordinals_.find(window)};
+  if (it == ordinals_.end()) {
+    return;
+  }
+
+  flw::log::Record record{.kind = flw::log::RecordKind::message,
+                          .window = it->second,
+                          .message = message,
+                          .wparam = wparam,
+                          .lparam = lparam};
+  switch (message) {
+  case WM_DPICHANGED:
+    record.payload = BytesOf(*reinterpret_cast<RECT const *>(lparam));
+    record.lparam = 0;
+    break;
+  case WM_WINDOWPOSCHANGING:
+  case WM_WINDOWPOSCHANGED: {
+    auto window_pos{*reinterpret_cast<WINDOWPOS const *>(lparam)};
+    window_pos.hwnd = nullptr;
+    window_pos.hwndInsertAfter = nullptr;
+    record.payload = BytesOf(window_pos);
+    record.lparam = 0;
+    break;
+  }
+  case WM_MOUSEACTIVATE:
+    record.wparam = 0;
+    break;
+  case WM_NCACTIVATE:
+  case WM_SETTINGCHANGE:
+    record.lparam = 0;
+    break;
+  default:
+    break;
+  }
+  Write(std::move(record));
+}
+
+void MessageRecorder::OnMethodCall(flutter::MethodCall<> const &call) {
+  if (!writer_.IsOpen()) {
+    return;
+  }
+  auto const encoded{
+      flutter::StandardMethodCodec::GetInstance().EncodeMethodCall(call)};
+  Write({.kind = flw::log::RecordKind::method_call, .payload = *encoded});
+}
+
+Win32Window *MessageRecorder::WindowForOrdinal(uint32_t ordinal) const {
+  auto const it{windows_.find(ordinal)};
+  return it != windows_.end() ? it->second : nullptr;
+}
+
+void MessageRecorder::Write(flw::log::Record record) {
+  if (!writer_.IsOpen()) {
+    return;
+  }
+  auto const now{std::chrono::steady_clock::now()};
+  record.delta_us = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(now - last_record_)
+          .count());
+  last_record_ = now;
+  writer_.Write(record);
+}
+
+std::vector<ReplayReport>
+ReplayScenarios(std::vector<std::filesystem::path> const &paths) {
+  std::vector<ReplayReport> reports;
+  auto &manager{FlutterWindowManager::instance()};
+  for (auto const &path : paths) {
+    ReplayReport report{.scenario = path};
+    flw::log::Reader reader;
+    report.loaded = reader.Open(path);
+    if (!report.loaded) {
+      reports.push_back(std::move(report));
+      continue;
+    }
+
+    auto const events_before{manager.sentEventCount()};
+    auto const allocations_before{
+        flw::memory::MemoryAccounting::allocation_count()};
+    auto const cpu_before{ProcessCpuMilliseconds()};
+    auto const wall_before{std::chrono::steady_clock::now()};
+
+    while (auto record{reader.Next()}) {
+      switch (record->kind) {
+      case flw::log::RecordKind::message: {
+        auto *const window{
+            MessageRecorder::instance().WindowForOrdinal(record->window)};
+        auto *const hwnd{window ? window->GetHandle() : nullptr};
+        if (!hwnd) {
+          break;
+        }
+        auto lparam{static_cast<LPARAM>(record->lparam)};
+        RECT rect;
+        WINDOWPOS window_pos;
+        if (record->message == WM_DPICHANGED &&
+            record->payload.size() == sizeof(rect)) {
+          std::memcpy(&rect, record->payload.data(), sizeof(rect));
+          lparam = reinterpret_cast<LPARAM>(&rect);
+        } else if ((record->message == WM_WINDOWPOSCHANGING ||
+                    record->message == WM_WINDOWPOSCHANGED) &&
+                   record->payload.size() == sizeof(window_pos)) {
+          std::memcpy(&window_pos, record->payload.data(), sizeof(window_pos));
+          window_pos.hwnd = hwnd;
+          lparam = reinterpret_cast<LPARAM>(&window_pos);
+        }
+        WindowBackend::instance().SendWindowMessage(
+            hwnd, record->message, static_cast<WPARAM>(record->wparam), lparam);
+        ++report.messages;
+        break;
+      }
+      case flw::log::RecordKind::method_call:
+        if (auto const call{
+                flutter::StandardMethodCodec::GetInstance().DecodeMethodCall(
+                    record->payload)}) {
+          manager.handleMethodCall(
+              *call, std::make_unique<flutter::MethodResultFunctions<>>(
+                         nullptr, nullptr, nullptr));
+          ++report.method_calls;
+        }
+        break;
+      default:
+        // Window creation and destruction are replayed by the method calls
+        // and messages that caused them.
+        break;
+      }
+    }
+
+    report.wall_ms = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - wall_before)
+                         .count();
+    report.cpu_ms = ProcessCpuMilliseconds() - cpu_before;
+    report.allocations =
+        flw::memory::MemoryAccounting::allocation_count() - allocations_before;
+    report.events_emitted = manager.sentEventCount() - events_before;
+    reports.push_back(std::move(report));
+  }
+  return reports;
+}
+
+void StartRecordingFromEnvironment() {
+  if (auto const path{GetEnvironment(FLW_ENV("FLW_RECORD_FILE"))}) {
+    MessageRecorder::instance().Start(*path);
+  }
+}
+
+bool ReplayFromEnvironment() {
+  auto const files{GetEnvironment(FLW_ENV("FLW_REPLAY_FILES"))};
+  if (!files) {
+    return false;
+  }
+
+  std::vector<std::filesystem::path> paths;
+  for (size_t begin{0}; begin <= files->size();) {
+    auto end{files->find(FLW_ENV(';'), begin)};
+    if (end == EnvironmentString::npos) {
+      end = files->size();
+    }
+    if (end > begin) {
+      paths.emplace_back(files->substr(begin, end - begin));
+    }
+    begin = end + 1;
+  }
+
+  std::printf("scenario,loaded,cpu_ms,wall_ms,allocations,messages,"
+              "method_calls,events_emitted\n");
+  for (auto const &report : ReplayScenarios(paths)) {
+    std::printf("%s,%d,%.3f,%.3f,%llu,%llu,%llu,%llu\n",
+                report.scenario.filename().string().c_str(), report.loaded,
+                report.cpu_ms, report.wall_ms,
+                static_cast<unsigned long long>(report.allocations),
+                static_cast<unsigned long long>(report.messages),
+                static_cast<unsigned long long>(report.method_calls),
+                static_cast<unsigned long long>(report.events_emitted));
+  }
+  std::fflush(stdout);
+  return true;
+}
+
+#endif // defined(FLW_ENABLE_REPLAY)
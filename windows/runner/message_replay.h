@@ -0,0 +1,108 @@
+#ifndef RUNNER_MESSAGE_REPLAY_H_
+#define RUNNER_MESSAGE_REPLAY_H_
+
+// Recording of the window message stream and flw/window calls into a
+// message_log.h file, and replay of such files against the live window
+// manager to measure a scenario without driving the desktop by hand.
+//
+// Compiled in through the FLW_ENABLE_REPLAY CMake option. When it is off, the
+// FLW_RECORD_* hooks expand to nothing.
+//
+// With the option on, setting FLW_RECORD_FILE records the session into that
+// file. Setting FLW_REPLAY_FILES to a ';'-separated list of logs replays each
+// of them as a scenario once the startup windows exist, prints a report line
+// per scenario and exits.
+
+#if defined(FLW_ENABLE_REPLAY)
+
+#include <flutter/method_call.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "message_log.h"
+#include "platform_window_types.h"
+#include "windowing_types.h"
+
+class Win32Window;
+
+class MessageRecorder {
+public:
+  static MessageRecorder &instance() {
+    static MessageRecorder instance;
+    return instance;
+  }
+
+  // Starts writing records to |path|. Returns false if it can't be opened.
+  bool Start(std::filesystem::path const &path);
+
+  // Windows are tracked whether or not a recording is in progress, so that
+  // a replay can map the windows of a log onto the windows it recreates.
+  void OnWindowCreated(Win32Window *window, flw::Archetype archetype,
+                       Win32Window const *parent);
+  void OnWindowDestroyed(Win32Window const *window);
+  void OnMessage(Win32Window const *window, UINT message, WPARAM wparam,
+                 LPARAM lparam);
+  void OnMethodCall(flutter::MethodCall<> const &call);
+
+  // Returns the live window created in position |ordinal|, or nullptr.
+  Win32Window *WindowForOrdinal(uint32_t ordinal) const;
+
+private:
+  MessageRecorder() = default;
+
+  void Write(flw::log::Record record);
+
+  std::unordered_map<Win32Window const *, uint32_t> ordinals_;
+  std::unordered_map<uint32_t, Win32Window *> windows_;
+  uint32_t next_ordinal_ = 0;
+  flw::log::Writer writer_;
+  std::chrono::steady_clock::time_point last_record_;
+};
+
+struct ReplayReport {
+  std::filesystem::path scenario{};
+  bool loaded{};
+  double cpu_ms{};
+  double wall_ms{};
+  uint64_t allocations{};
+  uint64_t messages{};
+  uint64_t method_calls{};
+  uint64_t events_emitted{};
+};
+
+// Replays every log in |paths| in order, as fast as possible, and returns one
+// report per log.
+std::vector<ReplayReport>
+ReplayScenarios(std::vector<std::filesystem::path> const &paths);
+
+// Starts recording if FLW_RECORD_FILE is set.
+void StartRecordingFromEnvironment();
+
+// Replays the logs listed in FLW_REPLAY_FILES and prints their reports.
+// Returns false if the variable is not set.
+bool ReplayFromEnvironment();
+
+#define FLW_RECORD_WINDOW_CREATED(window, archetype, parent)                   \
+  MessageRecorder::instance().OnWindowCreated(window, archetype, parent)
+#define FLW_RECORD_WINDOW_DESTROYED(window)                                    \
+  MessageRecorder::instance().OnWindowDestroyed(window)
+#define FLW_RECORD_MESSAGE(window, message, wparam, lparam)                    \
+  MessageRecorder::instance().OnMessage(window, message, wparam, lparam)
+#define FLW_RECORD_METHOD_CALL(call)                                           \
+  MessageRecorder::instance().OnMethodCall(call)
+
+#else
+
+#define FLW_RECORD_WINDOW_CREATED(window, archetype, parent)
+#define FLW_RECORD_WINDOW_DESTROYED(window)
+#define FLW_RECORD_MESSAGE(window, message, wparam, lparam)
+#define FLW_RECORD_METHOD_CALL(call)
+
+#endif // defined(FLW_ENABLE_REPLAY)
+
+#endif // RUNNER_MESSAGE_REPLAY_H_
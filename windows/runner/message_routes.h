@@ -0,0 +1,76 @@
+#ifndef RUNNER_MESSAGE_ROUTES_H_
+#define RUNNER_MESSAGE_ROUTES_H_
+
+#include "platform_window_types.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <utility>
+
+namespace flw {
+
+// Handles a window message for a window of type T. Returns std::nullopt to
+// pass the message on to DefWindowProc.
+template <typename T>
+using MessageHandlerFn = auto (*)(T &window, HWND hwnd, WPARAM wparam,
+                                  LPARAM lparam) -> std::optional<LRESULT>;
+
+template <typename T> struct MessageRoute {
+  UINT message;
+  MessageHandlerFn<T> handler;
+};
+
+// Dispatches a window message for a window of type T to its handler, or
+// returns std::nullopt if it has none or the handler passes it on.
+template <typename T>
+using MessageRouter = auto (*)(T &window, HWND hwnd, UINT message,
+                               WPARAM wparam, LPARAM lparam)
+    -> std::optional<LRESULT>;
+
+// Returns |routes| as a table sorted by message, for FindMessageHandler. A
+// message routed twice fails to compile.
+template <typename T, typename... Routes>
+consteval auto MakeMessageRoutes(Routes... routes)
+    -> std::array<MessageRoute<T>, sizeof...(Routes)> {
+  std::array<MessageRoute<T>, sizeof...(Routes)> table{routes...};
+  std::ranges::sort(table, {}, &MessageRoute<T>::message);
+  if (std::ranges::adjacent_find(table, {}, &MessageRoute<T>::message) !=
+      table.end()) {
+    std::unreachable();
+  }
+  return table;
+}
+
+// The MessageRouter for the constexpr table |kRoutes|. The routes are known at
+// compile time, so finding the route is a chain of comparisons against constant
+// messages, which the compiler lowers to a switch, and the handler is called
+// directly.
+template <typename T, auto const &kRoutes>
+auto RouteMessage(T &window, HWND hwnd, UINT message, WPARAM wparam,
+                  LPARAM lparam) -> std::optional<LRESULT> {
+  return [&]<size_t... I>(std::index_sequence<I...>) {
+    std::optional<LRESULT> result;
+    static_cast<void>(
+        ((message == kRoutes[I].message &&
+          (result = kRoutes[I].handler(window, hwnd, wparam, lparam), true)) ||
+         ...));
+    return result;
+  }(std::make_index_sequence<kRoutes.size()>{});
+}
+
+// Returns the handler of |message| in |routes|, or nullptr if it has none.
+// Unlike RouteMessage, |routes| may be chosen at run time.
+template <typename T>
+auto FindMessageHandler(std::span<MessageRoute<T> const> routes, UINT message)
+    -> MessageHandlerFn<T> {
+  auto const it{std::ranges::lower_bound(routes, message, {},
+                                         &MessageRoute<T>::message)};
+  return it != routes.end() && it->message == message ? it->handler : nullptr;
+}
+
+} // namespace flw
+
+#endif // RUNNER_MESSAGE_ROUTES_H_
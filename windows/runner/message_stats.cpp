@@ -0,0 +1,86 @@
+#include "message_stats.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+void LatencyHistogram::Record(uint64_t value) {
+  value = std::min<uint64_t>(value, (1ull << kMaxValueBits) - 1);
+  ++counts_[BucketIndex(value)];
+  ++count_;
+  sum_ += value;
+  min_ = std::min(min_, value);
+  max_ = std::max(max_, value);
+}
+
+void LatencyHistogram::Reset() { *this = LatencyHistogram{}; }
+
+uint64_t LatencyHistogram::ValueAtPercentile(double percentile) const {
+  if (!count_) {
+    return 0;
+  }
+  auto const clamped{std::clamp(percentile, 0.0, 100.0)};
+  auto const target{std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * count_)))};
+  uint64_t seen{0};
+  for (size_t i{0}; i < kBucketCount; ++i) {
+    seen += counts_[i];
+    if (seen >= target) {
+      return std::clamp(BucketUpperBound(i), min_, max_);
+    }
+  }
+  return max_;
+}
+
+// static
+size_t LatencyHistogram::BucketIndex(uint64_t value) {
+  if (value < kSubBucketCount) {
+    return static_cast<size_t>(value);
+  }
+  auto const exponent{std::bit_width(value) - 1};
+  auto const shift{exponent - kSubBucketBits};
+  auto const sub_bucket{(value >> shift) - kSubBucketCount};
+  return static_cast<size_t>((exponent - kSubBucketBits + 1) * kSubBucketCount +
+                             sub_bucket);
+}
+
+// static
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+  if (index < kSubBucketCount) {
+    return index;
+  }
+  auto const shift{index / kSubBucketCount - 1};
+  auto const sub_bucket{index % kSubBucketCount};
+  return ((kSubBucketCount + sub_bucket + 1) << shift) - 1;
+}
+
+void MessageStats::Record(Key const &key, uint64_t nanoseconds) {
+  histograms_[Pack(key)].Record(nanoseconds);
+}
+
+void MessageStats::RecordSatelliteTrail(uint64_t trailing_moves) {
+  ++satellite_trail_.samples;
+  if (trailing_moves > 0) {
+    ++satellite_trail_.trailing_samples;
+  }
+  satellite_trail_.max_trailing_moves =
+      std::max(satellite_trail_.max_trailing_moves, trailing_moves);
+}
+
+void MessageStats::Reset() {
+  histograms_.clear();
+  satellite_trail_ = {};
+}
+
+// static
+uint64_t MessageStats::Pack(Key const &key) {
+  return (static_cast<uint64_t>(key.archetype) << 40) |
+         (static_cast<uint64_t>(key.phase) << 32) | key.message;
+}
+
+// static
+MessageStats::Key MessageStats::Unpack(uint64_t packed) {
+  return {.archetype = static_cast<int>(packed >> 40),
+          .message = static_cast<unsigned int>(packed & 0xffffffff),
+          .phase = static_cast<Phase>((packed >> 32) & 0xff)};
+}
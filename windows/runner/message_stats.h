@@ -0,0 +1,143 @@
+#ifndef RUNNER_MESSAGE_STATS_H_
+#define RUNNER_MESSAGE_STATS_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+// A fixed-footprint latency histogram with HDR-style log-linear buckets.
+// Values below 2^kSubBucketBits are recorded exactly; larger values land in
+// one of 2^kSubBucketBits sub-buckets per power of two, which bounds the
+// relative error of any reported percentile to about 6%. Recording is a
+// handful of integer operations and never allocates.
+class LatencyHistogram {
+public:
+  // Records a single sample, in nanoseconds.
+  void Record(uint64_t value);
+
+  // Clears all recorded samples.
+  void Reset();
+
+  uint64_t count() const { return count_; }
+  uint64_t min() const { return count_ ? min_ : 0; }
+  uint64_t max() const { return max_; }
+  uint64_t mean() const { return count_ ? sum_ / count_ : 0; }
+
+  // Returns the smallest recorded value such that |percentile| percent of the
+  // samples are less than or equal to it. |percentile| is in [0, 100].
+  uint64_t ValueAtPercentile(double percentile) const;
+
+private:
+  static constexpr int kSubBucketBits = 4;
+  static constexpr uint64_t kSubBucketCount = uint64_t{1} << kSubBucketBits;
+  // Samples are clamped to 2^kMaxValueBits - 1 ns (about 18 minutes).
+  static constexpr int kMaxValueBits = 40;
+  static constexpr size_t kBucketCount =
+      (kMaxValueBits - kSubBucketBits + 1) * kSubBucketCount;
+
+  static size_t BucketIndex(uint64_t value);
+  static uint64_t BucketUpperBound(size_t index);
+
+  std::array<uint32_t, kBucketCount> counts_{};
+  uint64_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t min_ = UINT64_MAX;
+  uint64_t max_ = 0;
+};
+
+// Process-wide collection of message handler latencies, keyed by window
+// archetype, window message and the dispatch phase being measured. All
+// recording happens on the platform thread, hence no synchronization.
+class MessageStats {
+public:
+  enum class Phase {
+    // Whole WndProc dispatch, from Win32Window::WndProc to its return.
+    dispatch,
+    // FlutterViewController::HandleTopLevelWindowProc, including plugins.
+    plugin,
+    // Win32Window::MessageHandler.
+    handler,
+    // Commits that resize the hosted content, keyed under WM_SIZE. The count
+    // is the number of surface reallocations.
+    surface_resize,
+    // From a content resize to the next frame rendered by the engine, keyed
+    // under WM_SIZE.
+    resize_frame,
+    // Showing and hiding a pooled window, keyed under WM_SHOWWINDOW.
+    show,
+    hide,
+  };
+
+  // How closely satellites follow their parents. Every move of a window with
+  // satellites adds one sample per satellite.
+  struct SatelliteTrail {
+    uint64_t samples;
+    // The samples in which the satellite was out of place.
+    uint64_t trailing_samples;
+    // The longest run of consecutive parent moves a satellite trailed.
+    uint64_t max_trailing_moves;
+  };
+
+  struct Key {
+    int archetype;
+    unsigned int message;
+    Phase phase;
+  };
+
+  static MessageStats &instance() {
+    static MessageStats instance;
+    return instance;
+  }
+
+  void Record(Key const &key, uint64_t nanoseconds);
+  // Records a satellite that has trailed its parent for |trailing_moves|
+  // consecutive moves, 0 when in sync.
+  void RecordSatelliteTrail(uint64_t trailing_moves);
+  void Reset();
+
+  SatelliteTrail const &satellite_trail() const { return satellite_trail_; }
+
+  // Calls |visitor| with (Key const&, LatencyHistogram const&) for every
+  // histogram holding at least one sample.
+  template <typename Visitor> void ForEach(Visitor &&visitor) const {
+    for (auto const &[packed, histogram] : histograms_) {
+      if (histogram.count()) {
+        visitor(Unpack(packed), histogram);
+      }
+    }
+  }
+
+private:
+  MessageStats() = default;
+
+  static uint64_t Pack(Key const &key);
+  static Key Unpack(uint64_t packed);
+
+  std::unordered_map<uint64_t, LatencyHistogram> histograms_;
+  SatelliteTrail satellite_trail_{};
+};
+
+// Records the lifetime of the scope into MessageStats.
+class ScopedMessageTimer {
+public:
+  ScopedMessageTimer(int archetype, unsigned int message,
+                     MessageStats::Phase phase)
+      : key_{archetype, message, phase},
+        start_(std::chrono::steady_clock::now()) {}
+  ~ScopedMessageTimer() {
+    auto const elapsed{std::chrono::steady_clock::now() - start_};
+    MessageStats::instance().Record(
+        key_, static_cast<uint64_t>(
+                  std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                      .count()));
+  }
+  ScopedMessageTimer(ScopedMessageTimer const &) = delete;
+  ScopedMessageTimer &operator=(ScopedMessageTimer const &) = delete;
+
+private:
+  MessageStats::Key key_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+#endif // RUNNER_MESSAGE_STATS_H_
@@ -0,0 +1,128 @@
+#ifndef RUNNER_PLATFORM_WINDOW_TYPES_H_
+#define RUNNER_PLATFORM_WINDOW_TYPES_H_
+
+// The Win32 types and message constants used by the platform-neutral window
+// logic (Win32Window, FlutterWindow and FlutterWindowManager). On Windows they
+// come from <windows.h>; elsewhere, minimal stand-ins with the same values are
+// provided so that the logic can be built against the headless backend.
+
+#if defined(_WIN32)
+
+#include <windows.h>
+
+#else
+
+#include <cstdint>
+
+using BOOL = int;
+using UINT = unsigned int;
+using DWORD = uint32_t;
+using LONG = int32_t;
+using WPARAM = uintptr_t;
+using LPARAM = intptr_t;
+using LRESULT = intptr_t;
+
+struct HWND__;
+using HWND = HWND__ *;
+
+struct RECT {
+  LONG left;
+  LONG top;
+  LONG right;
+  LONG bottom;
+};
+
+struct POINT {
+  LONG x;
+  LONG y;
+};
+
+struct SIZE {
+  LONG cx;
+  LONG cy;
+};
+
+struct WINDOWPOS {
+  HWND hwnd;
+  HWND hwndInsertAfter;
+  int x;
+  int y;
+  int cx;
+  int cy;
+  UINT flags;
+};
+
+#define TRUE 1
+#define FALSE 0
+#define CALLBACK
+
+#define LOWORD(l) (static_cast<uint16_t>(static_cast<uintptr_t>(l) & 0xffff))
+#define HIWORD(l)                                                              \
+  (static_cast<uint16_t>((static_cast<uintptr_t>(l) >> 16) & 0xffff))
+#define MAKEWPARAM(l, h)                                                       \
+  (static_cast<WPARAM>(static_cast<uint32_t>(                                  \
+      static_cast<uint16_t>(l) | (static_cast<uint32_t>(                       \
+                                      static_cast<uint16_t>(h))                \
+                                  << 16))))
+#define MAKELPARAM(l, h)                                                       \
+  (static_cast<LPARAM>(static_cast<uint32_t>(                                  \
+      static_cast<uint16_t>(l) | (static_cast<uint32_t>(                       \
+                                      static_cast<uint16_t>(h))                \
+                                  << 16))))
+
+#define WM_CREATE 0x0001
+#define WM_DESTROY 0x0002
+#define WM_MOVE 0x0003
+#define WM_SIZE 0x0005
+#define WM_ACTIVATE 0x0006
+#define WM_SETFOCUS 0x0007
+#define WM_KILLFOCUS 0x0008
+#define WM_CLOSE 0x0010
+#define WM_SHOWWINDOW 0x0018
+#define WM_SETTINGCHANGE 0x001A
+#define WM_ACTIVATEAPP 0x001C
+#define WM_FONTCHANGE 0x001D
+#define WM_MOUSEACTIVATE 0x0021
+#define WM_WINDOWPOSCHANGING 0x0046
+#define WM_WINDOWPOSCHANGED 0x0047
+#define WM_DISPLAYCHANGE 0x007E
+#define WM_NCCREATE 0x0081
+#define WM_NCDESTROY 0x0082
+#define WM_NCACTIVATE 0x0086
+#define WM_TIMER 0x0113
+#define WM_ENTERSIZEMOVE 0x0231
+#define WM_EXITSIZEMOVE 0x0232
+#define WM_DPICHANGED 0x02E0
+#define WM_DWMCOLORIZATIONCOLORCHANGED 0x0320
+#define WM_APP 0x8000
+
+#define WA_INACTIVE 0
+#define WA_ACTIVE 1
+#define WA_CLICKACTIVE 2
+
+#define MA_ACTIVATE 1
+#define MA_NOACTIVATE 3
+
+#define SIZE_RESTORED 0
+#define SIZE_MINIMIZED 1
+#define SIZE_MAXIMIZED 2
+
+#define WS_OVERLAPPEDWINDOW 0x00CF0000L
+#define WS_POPUP 0x80000000L
+#define WS_CHILD 0x40000000L
+#define WS_VISIBLE 0x10000000L
+#define WS_CAPTION 0x00C00000L
+#define WS_SYSMENU 0x00080000L
+#define WS_THICKFRAME 0x00040000L
+
+#define WS_EX_TOOLWINDOW 0x00000080L
+#define WS_EX_NOACTIVATE 0x08000000L
+
+#define SWP_NOSIZE 0x0001
+#define SWP_NOMOVE 0x0002
+#define SWP_NOZORDER 0x0004
+#define SWP_NOACTIVATE 0x0010
+
+#endif // defined(_WIN32)
+
+#endif // RUNNER_PLATFORM_WINDOW_TYPES_H_
@@ -0,0 +1,132 @@
+#include "system_settings.h"
+
+#include <dwmapi.h>
+#include <flutter_windows.h>
+
+#include <algorithm>
+
+/// Window attribute that enables dark mode window decorations.
+///
+/// Redefined in case the developer's machine has a Windows SDK older than
+/// version 10.0.22000.0.
+/// See:
+/// https://docs.microsoft.com/windows/win32/api/dwmapi/ne-dwmapi-dwmwindowattribute
+#ifndef DWMWA_USE_IMMERSIVE_DARK_MODE
+#define DWMWA_USE_IMMERSIVE_DARK_MODE 20
+#endif
+
+SystemSettings::SystemSettings() : dark_mode_(ReadDarkMode()) {
+  // User32 is loaded for as long as the process has windows, so the entry
+  // points stay valid without holding a reference to the module.
+  if (HMODULE user32_module = GetModuleHandleW(L"User32.dll")) {
+    // Only needed for PerMonitor V1 awareness mode.
+    enable_non_client_dpi_scaling_ =
+        reinterpret_cast<EnableNonClientDpiScaling *>(
+            GetProcAddress(user32_module, "EnableNonClientDpiScaling"));
+    set_window_composition_attribute_ =
+        reinterpret_cast<SetWindowCompositionAttribute *>(
+            GetProcAddress(user32_module, "SetWindowCompositionAttribute"));
+  }
+}
+
+void SystemSettings::AttachWindow(HWND window) {
+  if (enable_non_client_dpi_scaling_) {
+    enable_non_client_dpi_scaling_(window);
+  }
+  EnableTransparentBackground(window);
+  windows_.push_back(window);
+}
+
+void SystemSettings::DetachWindow(HWND window) {
+  std::erase(windows_, window);
+}
+
+void SystemSettings::ApplyTheme(HWND window) const {
+  if (dark_mode_) {
+    BOOL enable_dark_mode = *dark_mode_;
+    DwmSetWindowAttribute(window, DWMWA_USE_IMMERSIVE_DARK_MODE,
+                          &enable_dark_mode, sizeof(enable_dark_mode));
+  }
+}
+
+UINT SystemSettings::GetDpiForMonitor(HMONITOR monitor) {
+  auto const [it, inserted]{monitor_dpis_.try_emplace(monitor, 0)};
+  if (inserted) {
+    it->second = FlutterDesktopGetDpiForMonitor(monitor);
+  }
+  return it->second;
+}
+
+void SystemSettings::OnSettingChange(HWND window, UINT message) {
+  switch (message) {
+  case WM_DISPLAYCHANGE:
+  case WM_DPICHANGED:
+    monitor_dpis_.clear();
+    break;
+  case WM_SETTINGCHANGE:
+  case WM_DWMCOLORIZATIONCOLORCHANGED:
+    // Every top-level window receives the change; only act on it once.
+    if (windows_.empty() || windows_.front() != window) {
+      break;
+    }
+    monitor_dpis_.clear();
+    if (auto const dark_mode{ReadDarkMode()}; dark_mode != dark_mode_) {
+      dark_mode_ = dark_mode;
+      for (auto *const each : windows_) {
+        ApplyTheme(each);
+      }
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+// static
+std::optional<bool> SystemSettings::ReadDarkMode() {
+  // Registry key for app theme preference.
+  const wchar_t kGetPreferredBrightnessRegKey[] =
+      L"Software\\Microsoft\\Windows\\CurrentVersion\\Themes\\Personalize";
+  const wchar_t kGetPreferredBrightnessRegValue[] = L"AppsUseLightTheme";
+
+  // A value of 0 indicates apps should use dark mode. A non-zero or missing
+  // value indicates apps should use light mode.
+  DWORD light_mode;
+  DWORD light_mode_size = sizeof(light_mode);
+  LSTATUS const result =
+      RegGetValue(HKEY_CURRENT_USER, kGetPreferredBrightnessRegKey,
+                  kGetPreferredBrightnessRegValue, RRF_RT_REG_DWORD, nullptr,
+                  &light_mode, &light_mode_size);
+  if (result != ERROR_SUCCESS) {
+    return std::nullopt;
+  }
+  return light_mode == 0;
+}
+
+void SystemSettings::EnableTransparentBackground(HWND window) const {
+  if (set_window_composition_attribute_ == nullptr) {
+    return;
+  }
+
+  enum ACCENT_STATE { ACCENT_DISABLED = 0 };
+
+  struct ACCENT_POLICY {
+    ACCENT_STATE AccentState;
+    DWORD AccentFlags;
+    DWORD GradientColor;
+    DWORD AnimationId;
+  };
+
+  ACCENT_POLICY accent = {ACCENT_DISABLED, 2, static_cast<DWORD>(0), 0};
+  WINDOWCOMPOSITIONATTRIBDATA data{.Attrib = WCA_ACCENT_POLICY,
+                                   .pvData = &accent,
+                                   .cbData = sizeof(accent)};
+  set_window_composition_attribute_(window, &data);
+
+  MARGINS const margins = {-1};
+  ::DwmExtendFrameIntoClientArea(window, &margins);
+  BOOL const enable = TRUE;
+  INT effect_value = 1;
+  ::DwmSetWindowAttribute(window, DWMWA_SYSTEMBACKDROP_TYPE, &effect_value,
+                          sizeof(enable));
+}
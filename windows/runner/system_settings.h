@@ -0,0 +1,71 @@
+#ifndef RUNNER_SYSTEM_SETTINGS_H_
+#define RUNNER_SYSTEM_SETTINGS_H_
+
+#include <windows.h>
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Process-wide cache of the system settings and optional User32 entry points
+// the runner's windows depend on.
+//
+// The optional entry points are resolved once, and the app theme and monitor
+// DPIs are read once and then served from memory, so creating a window makes
+// no loader or registry calls. When the settings change, every window is
+// notified; the first window registered refreshes the cache with a single read
+// and applies the result to all of them.
+class SystemSettings {
+public:
+  static SystemSettings &instance() {
+    static SystemSettings instance;
+    return instance;
+  }
+
+  // Prepares the newly created |window| and starts fanning setting changes out
+  // to it. Must be called on WM_NCCREATE.
+  void AttachWindow(HWND window);
+
+  // Stops fanning setting changes out to |window|.
+  void DetachWindow(HWND window);
+
+  // Matches the frame of |window| to the app theme.
+  void ApplyTheme(HWND window) const;
+
+  // Returns the DPI of |monitor|.
+  UINT GetDpiForMonitor(HMONITOR monitor);
+
+  // Handles WM_SETTINGCHANGE, WM_DWMCOLORIZATIONCOLORCHANGED, WM_DISPLAYCHANGE
+  // and WM_DPICHANGED, which are sent to every top-level window.
+  void OnSettingChange(HWND window, UINT message);
+
+private:
+  using EnableNonClientDpiScaling = BOOL __stdcall(HWND hwnd);
+
+  enum WINDOWCOMPOSITIONATTRIB { WCA_ACCENT_POLICY = 19 };
+
+  struct WINDOWCOMPOSITIONATTRIBDATA {
+    WINDOWCOMPOSITIONATTRIB Attrib;
+    PVOID pvData;
+    SIZE_T cbData;
+  };
+
+  using SetWindowCompositionAttribute =
+      BOOL __stdcall(HWND, WINDOWCOMPOSITIONATTRIBDATA *);
+
+  SystemSettings();
+
+  // Returns whether apps should use dark mode, or std::nullopt if the
+  // preference is not set.
+  static std::optional<bool> ReadDarkMode();
+
+  void EnableTransparentBackground(HWND window) const;
+
+  EnableNonClientDpiScaling *enable_non_client_dpi_scaling_ = nullptr;
+  SetWindowCompositionAttribute *set_window_composition_attribute_ = nullptr;
+  std::optional<bool> dark_mode_;
+  std::unordered_map<HMONITOR, UINT> monitor_dpis_;
+  std::vector<HWND> windows_;
+};
+
+#endif // RUNNER_SYSTEM_SETTINGS_H_
@@ -0,0 +1,32 @@
+#ifndef FLUTTER_CLIENT_WRAPPER_BINARY_MESSENGER_H_
+#define FLUTTER_CLIENT_WRAPPER_BINARY_MESSENGER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace flutter {
+
+typedef std::function<void(uint8_t const *reply, size_t reply_size)>
+    BinaryReply;
+
+typedef std::function<void(uint8_t const *message, size_t message_size,
+                           BinaryReply reply)>
+    BinaryMessageHandler;
+
+class BinaryMessenger {
+public:
+  virtual ~BinaryMessenger() = default;
+
+  virtual void Send(std::string const &channel, uint8_t const *message,
+                    size_t message_size,
+                    BinaryReply reply = nullptr) const = 0;
+
+  virtual void SetMessageHandler(std::string const &channel,
+                                 BinaryMessageHandler handler) = 0;
+};
+
+} // namespace flutter
+
+#endif // FLUTTER_CLIENT_WRAPPER_BINARY_MESSENGER_H_
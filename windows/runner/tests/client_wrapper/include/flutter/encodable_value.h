@@ -0,0 +1,105 @@
+#ifndef FLUTTER_CLIENT_WRAPPER_ENCODABLE_VALUE_H_
+#define FLUTTER_CLIENT_WRAPPER_ENCODABLE_VALUE_H_
+
+#include <algorithm>
+#include <compare>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// The subset of the Flutter C++ client wrapper the runner uses, for building
+// it off Windows against the headless backend. Types and signatures match
+// flutter/cpp_client_wrapper; custom values are not supported.
+namespace flutter {
+
+class EncodableValue;
+
+using EncodableList = std::vector<EncodableValue>;
+using EncodableMap = std::map<EncodableValue, EncodableValue>;
+
+namespace internal {
+// The alternatives of EncodableValue, in the order of the client wrapper.
+using EncodableValueVariant =
+    std::variant<std::monostate, bool, int32_t, int64_t, double, std::string,
+                 std::vector<uint8_t>, std::vector<int32_t>,
+                 std::vector<int64_t>, std::vector<double>, EncodableList,
+                 EncodableMap, std::vector<float>>;
+} // namespace internal
+
+class EncodableValue : public internal::EncodableValueVariant {
+public:
+  using super = internal::EncodableValueVariant;
+
+  constexpr EncodableValue() = default;
+
+  explicit EncodableValue(char const *string) : super(std::string(string)) {}
+  EncodableValue &operator=(char const *other) {
+    *this = std::string(other);
+    return *this;
+  }
+
+  template <class T>
+  constexpr explicit EncodableValue(T &&t) noexcept
+      : super(std::forward<T>(t)) {}
+
+  using super::operator=;
+
+  bool IsNull() const { return std::holds_alternative<std::monostate>(*this); }
+
+  // Returns the value as an int64_t, for values that may be sent as either
+  // int32 or int64.
+  int64_t LongValue() const {
+    if (std::holds_alternative<int32_t>(*this)) {
+      return std::get<int32_t>(*this);
+    }
+    return std::get<int64_t>(*this);
+  }
+
+  // Orders values by type, then by value. Lists and maps are compared
+  // element by element, without std::variant's comparison operators, whose
+  // constraints cannot be checked for a type that contains itself.
+  friend bool operator<(EncodableValue const &lhs, EncodableValue const &rhs) {
+    if (lhs.index() != rhs.index()) {
+      return lhs.index() < rhs.index();
+    }
+    return std::visit(
+        [&rhs](auto const &left) -> bool {
+          using T = std::decay_t<decltype(left)>;
+          auto const &right{std::get<T>(rhs)};
+          if constexpr (std::is_same_v<T, std::monostate>) {
+            return false;
+          } else if constexpr (std::is_same_v<T, EncodableList>) {
+            return std::lexicographical_compare(left.begin(), left.end(),
+                                                right.begin(), right.end());
+          } else if constexpr (std::is_same_v<T, EncodableMap>) {
+            return std::lexicographical_compare(
+                left.begin(), left.end(), right.begin(), right.end(),
+                [](auto const &a, auto const &b) {
+                  return a.first < b.first ||
+                         (!(b.first < a.first) && a.second < b.second);
+                });
+          } else {
+            return left < right;
+          }
+        },
+        static_cast<super const &>(lhs));
+  }
+  friend bool operator==(EncodableValue const &lhs,
+                         EncodableValue const &rhs) {
+    return !(lhs < rhs) && !(rhs < lhs);
+  }
+  friend std::weak_ordering operator<=>(EncodableValue const &lhs,
+                                        EncodableValue const &rhs) {
+    return lhs < rhs   ? std::weak_ordering::less
+           : rhs < lhs ? std::weak_ordering::greater
+                       : std::weak_ordering::equivalent;
+  }
+};
+
+} // namespace flutter
+
+#endif // FLUTTER_CLIENT_WRAPPER_ENCODABLE_VALUE_H_
@@ -0,0 +1,29 @@
+#ifndef FLUTTER_CLIENT_WRAPPER_METHOD_CALL_H_
+#define FLUTTER_CLIENT_WRAPPER_METHOD_CALL_H_
+
+#include <memory>
+#include <string>
+
+#include "encodable_value.h"
+
+namespace flutter {
+
+template <typename T = EncodableValue> class MethodCall {
+public:
+  MethodCall(std::string const &method_name, std::unique_ptr<T> arguments)
+      : method_name_(method_name), arguments_(std::move(arguments)) {}
+
+  MethodCall(MethodCall const &) = delete;
+  MethodCall &operator=(MethodCall const &) = delete;
+
+  std::string const &method_name() const { return method_name_; }
+  T const *arguments() const { return arguments_.get(); }
+
+private:
+  std::string method_name_;
+  std::unique_ptr<T> arguments_;
+};
+
+} // namespace flutter
+
+#endif // FLUTTER_CLIENT_WRAPPER_METHOD_CALL_H_
@@ -0,0 +1,128 @@
+#ifndef FLUTTER_CLIENT_WRAPPER_METHOD_CHANNEL_H_
+#define FLUTTER_CLIENT_WRAPPER_METHOD_CHANNEL_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "binary_messenger.h"
+#include "encodable_value.h"
+#include "method_call.h"
+#include "method_result.h"
+#include "standard_method_codec.h"
+
+namespace flutter {
+
+// The channel the engine's channel buffers are configured on.
+inline constexpr char kControlChannelName[] = "dev.flutter/channel-buffers";
+
+template <typename T = EncodableValue>
+using MethodCallHandler = std::function<void(
+    MethodCall<T> const &call, std::unique_ptr<MethodResult<T>> result)>;
+
+namespace internal {
+
+// Sends the response to a method call received from Dart as the reply to its
+// message. A result destroyed without a response replies that the method is
+// not implemented.
+class ReplyMethodResult : public MethodResult<EncodableValue> {
+public:
+  ReplyMethodResult(BinaryReply reply, StandardMethodCodec const *codec)
+      : reply_(std::move(reply)), codec_(codec) {}
+  ~ReplyMethodResult() override {
+    if (reply_) {
+      NotImplementedInternal();
+    }
+  }
+
+protected:
+  void SuccessInternal(EncodableValue const *result) override {
+    Reply(*codec_->EncodeSuccessEnvelope(result));
+  }
+  void ErrorInternal(std::string const &error_code,
+                     std::string const &error_message,
+                     EncodableValue const *error_details) override {
+    Reply(*codec_->EncodeErrorEnvelope(error_code, error_message,
+                                       error_details));
+  }
+  void NotImplementedInternal() override { Reply({}); }
+
+private:
+  void Reply(std::vector<uint8_t> const &data) {
+    if (auto reply{std::exchange(reply_, nullptr)}) {
+      reply(data.data(), data.size());
+    }
+  }
+
+  BinaryReply reply_;
+  StandardMethodCodec const *codec_;
+};
+
+} // namespace internal
+
+template <typename T = EncodableValue> class MethodChannel {
+public:
+  MethodChannel(BinaryMessenger *messenger, std::string const &name,
+                StandardMethodCodec const *codec)
+      : messenger_(messenger), name_(name), codec_(codec) {}
+
+  MethodChannel(MethodChannel const &) = delete;
+  MethodChannel &operator=(MethodChannel const &) = delete;
+
+  void InvokeMethod(std::string const &method, std::unique_ptr<T> arguments,
+                    std::unique_ptr<MethodResult<T>> result = nullptr) {
+    MethodCall<T> const call(method, std::move(arguments));
+    auto const message{codec_->EncodeMethodCall(call)};
+    if (!result) {
+      messenger_->Send(name_, message->data(), message->size(), nullptr);
+      return;
+    }
+    std::shared_ptr<MethodResult<T>> shared_result{std::move(result)};
+    messenger_->Send(name_, message->data(), message->size(),
+                     [codec = codec_, shared_result](uint8_t const *reply,
+                                                     size_t reply_size) {
+                       codec->DecodeAndProcessResponseEnvelope(
+                           reply, reply_size, shared_result.get());
+                     });
+  }
+
+  void SetMethodCallHandler(MethodCallHandler<T> handler) const {
+    if (!handler) {
+      messenger_->SetMessageHandler(name_, nullptr);
+      return;
+    }
+    messenger_->SetMessageHandler(
+        name_, [handler = std::move(handler),
+                codec = codec_](uint8_t const *message, size_t message_size,
+                                BinaryReply reply) {
+          auto result{std::make_unique<internal::ReplyMethodResult>(
+              std::move(reply), codec)};
+          auto const call{codec->DecodeMethodCall(message, message_size)};
+          if (!call) {
+            return;
+          }
+          handler(*call, std::move(result));
+        });
+  }
+
+  // Sets how many messages for this channel the engine buffers until Dart
+  // listens to it.
+  void Resize(int new_size) {
+    MethodCall<T> const call(
+        "resize", std::make_unique<T>(EncodableList{EncodableValue(name_),
+                                                    EncodableValue(new_size)}));
+    auto const message{codec_->EncodeMethodCall(call)};
+    messenger_->Send(kControlChannelName, message->data(), message->size(),
+                     nullptr);
+  }
+
+private:
+  BinaryMessenger *messenger_;
+  std::string name_;
+  StandardMethodCodec const *codec_;
+};
+
+} // namespace flutter
+
+#endif // FLUTTER_CLIENT_WRAPPER_METHOD_CHANNEL_H_
@@ -0,0 +1,42 @@
+#ifndef FLUTTER_CLIENT_WRAPPER_METHOD_RESULT_H_
+#define FLUTTER_CLIENT_WRAPPER_METHOD_RESULT_H_
+
+#include <string>
+
+#include "encodable_value.h"
+
+namespace flutter {
+
+template <typename T = EncodableValue> class MethodResult {
+public:
+  MethodResult() = default;
+  virtual ~MethodResult() = default;
+
+  MethodResult(MethodResult const &) = delete;
+  MethodResult &operator=(MethodResult const &) = delete;
+
+  void Success(T const &result) { SuccessInternal(&result); }
+  void Success() { SuccessInternal(nullptr); }
+
+  void Error(std::string const &error_code,
+             std::string const &error_message, T const &error_details) {
+    ErrorInternal(error_code, error_message, &error_details);
+  }
+  void Error(std::string const &error_code,
+             std::string const &error_message = "") {
+    ErrorInternal(error_code, error_message, nullptr);
+  }
+
+  void NotImplemented() { NotImplementedInternal(); }
+
+protected:
+  virtual void SuccessInternal(T const *result) = 0;
+  virtual void ErrorInternal(std::string const &error_code,
+                             std::string const &error_message,
+                             T const *error_details) = 0;
+  virtual void NotImplementedInternal() = 0;
+};
+
+} // namespace flutter
+
+#endif // FLUTTER_CLIENT_WRAPPER_METHOD_RESULT_H_
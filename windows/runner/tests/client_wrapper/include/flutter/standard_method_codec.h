@@ -0,0 +1,56 @@
+#ifndef FLUTTER_CLIENT_WRAPPER_STANDARD_METHOD_CODEC_H_
+#define FLUTTER_CLIENT_WRAPPER_STANDARD_METHOD_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "encodable_value.h"
+#include "method_call.h"
+#include "method_result.h"
+
+namespace flutter {
+
+// The standard method codec, in the wire format of StandardMethodCodec in
+// package:flutter/services.dart.
+class StandardMethodCodec {
+public:
+  static StandardMethodCodec const &GetInstance();
+
+  StandardMethodCodec(StandardMethodCodec const &) = delete;
+  StandardMethodCodec &operator=(StandardMethodCodec const &) = delete;
+
+  // Returns null if |message| is not a well-formed method call.
+  std::unique_ptr<MethodCall<EncodableValue>>
+  DecodeMethodCall(uint8_t const *message, size_t message_size) const;
+  std::unique_ptr<MethodCall<EncodableValue>>
+  DecodeMethodCall(std::vector<uint8_t> const &message) const {
+    return DecodeMethodCall(message.data(), message.size());
+  }
+
+  std::unique_ptr<std::vector<uint8_t>>
+  EncodeMethodCall(MethodCall<EncodableValue> const &method_call) const;
+
+  std::unique_ptr<std::vector<uint8_t>>
+  EncodeSuccessEnvelope(EncodableValue const *result = nullptr) const;
+
+  std::unique_ptr<std::vector<uint8_t>>
+  EncodeErrorEnvelope(std::string const &error_code,
+                      std::string const &error_message = "",
+                      EncodableValue const *error_details = nullptr) const;
+
+  // Decodes |response| and passes it to |result|. An empty response is
+  // reported as not implemented. Returns false if |response| is malformed.
+  bool DecodeAndProcessResponseEnvelope(
+      uint8_t const *response, size_t response_size,
+      MethodResult<EncodableValue> *result) const;
+
+private:
+  StandardMethodCodec() = default;
+};
+
+} // namespace flutter
+
+#endif // FLUTTER_CLIENT_WRAPPER_STANDARD_METHOD_CODEC_H_
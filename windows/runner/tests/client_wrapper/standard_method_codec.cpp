@@ -0,0 +1,372 @@
+#include "include/flutter/standard_method_codec.h"
+
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+namespace flutter {
+
+namespace {
+
+enum class Type : uint8_t {
+  kNull = 0,
+  kTrue = 1,
+  kFalse = 2,
+  kInt32 = 3,
+  kInt64 = 4,
+  kFloat64 = 6,
+  kString = 7,
+  kUInt8List = 8,
+  kInt32List = 9,
+  kInt64List = 10,
+  kFloat64List = 11,
+  kList = 12,
+  kMap = 13,
+  kFloat32List = 14,
+};
+
+class Writer {
+public:
+  explicit Writer(std::vector<uint8_t> &bytes) : bytes_(bytes) {}
+
+  void WriteByte(uint8_t byte) { bytes_.push_back(byte); }
+
+  template <typename T> void WriteScalar(T value) {
+    auto const *const data{reinterpret_cast<uint8_t const *>(&value)};
+    bytes_.insert(bytes_.end(), data, data + sizeof(value));
+  }
+
+  void WriteAlignment(size_t alignment) {
+    while (bytes_.size() % alignment != 0) {
+      bytes_.push_back(0);
+    }
+  }
+
+  void WriteSize(size_t size) {
+    if (size < 254) {
+      WriteByte(static_cast<uint8_t>(size));
+    } else if (size <= 0xffff) {
+      WriteByte(254);
+      WriteScalar(static_cast<uint16_t>(size));
+    } else {
+      WriteByte(255);
+      WriteScalar(static_cast<uint32_t>(size));
+    }
+  }
+
+  template <typename T> void WriteVector(std::vector<T> const &values) {
+    WriteSize(values.size());
+    if constexpr (sizeof(T) > 1) {
+      WriteAlignment(sizeof(T));
+    }
+    for (auto const value : values) {
+      WriteScalar(value);
+    }
+  }
+
+  void WriteValue(EncodableValue const &value) {
+    std::visit(
+        [this](auto const &v) {
+          using V = std::decay_t<decltype(v)>;
+          if constexpr (std::is_same_v<V, std::monostate>) {
+            WriteByte(static_cast<uint8_t>(Type::kNull));
+          } else if constexpr (std::is_same_v<V, bool>) {
+            WriteByte(static_cast<uint8_t>(v ? Type::kTrue : Type::kFalse));
+          } else if constexpr (std::is_same_v<V, int32_t>) {
+            WriteByte(static_cast<uint8_t>(Type::kInt32));
+            WriteScalar(v);
+          } else if constexpr (std::is_same_v<V, int64_t>) {
+            WriteByte(static_cast<uint8_t>(Type::kInt64));
+            WriteScalar(v);
+          } else if constexpr (std::is_same_v<V, double>) {
+            WriteByte(static_cast<uint8_t>(Type::kFloat64));
+            WriteAlignment(8);
+            WriteScalar(v);
+          } else if constexpr (std::is_same_v<V, std::string>) {
+            WriteByte(static_cast<uint8_t>(Type::kString));
+            WriteSize(v.size());
+            bytes_.insert(bytes_.end(), v.begin(), v.end());
+          } else if constexpr (std::is_same_v<V, std::vector<uint8_t>>) {
+            WriteByte(static_cast<uint8_t>(Type::kUInt8List));
+            WriteVector(v);
+          } else if constexpr (std::is_same_v<V, std::vector<int32_t>>) {
+            WriteByte(static_cast<uint8_t>(Type::kInt32List));
+            WriteVector(v);
+          } else if constexpr (std::is_same_v<V, std::vector<int64_t>>) {
+            WriteByte(static_cast<uint8_t>(Type::kInt64List));
+            WriteVector(v);
+          } else if constexpr (std::is_same_v<V, std::vector<double>>) {
+            WriteByte(static_cast<uint8_t>(Type::kFloat64List));
+            WriteVector(v);
+          } else if constexpr (std::is_same_v<V, std::vector<float>>) {
+            WriteByte(static_cast<uint8_t>(Type::kFloat32List));
+            WriteVector(v);
+          } else if constexpr (std::is_same_v<V, EncodableList>) {
+            WriteByte(static_cast<uint8_t>(Type::kList));
+            WriteSize(v.size());
+            for (auto const &element : v) {
+              WriteValue(element);
+            }
+          } else if constexpr (std::is_same_v<V, EncodableMap>) {
+            WriteByte(static_cast<uint8_t>(Type::kMap));
+            WriteSize(v.size());
+            for (auto const &[key, element] : v) {
+              WriteValue(key);
+              WriteValue(element);
+            }
+          }
+        },
+        static_cast<EncodableValue::super const &>(value));
+  }
+
+private:
+  std::vector<uint8_t> &bytes_;
+};
+
+class Reader {
+public:
+  Reader(uint8_t const *bytes, size_t size) : bytes_(bytes), size_(size) {}
+
+  bool at_end() const { return position_ == size_; }
+
+  std::optional<uint8_t> ReadByte() {
+    if (position_ >= size_) {
+      return std::nullopt;
+    }
+    return bytes_[position_++];
+  }
+
+  template <typename T> std::optional<T> ReadScalar() {
+    if (size_ - position_ < sizeof(T)) {
+      return std::nullopt;
+    }
+    T value;
+    std::memcpy(&value, bytes_ + position_, sizeof(T));
+    position_ += sizeof(T);
+    return value;
+  }
+
+  bool ReadAlignment(size_t alignment) {
+    while (position_ % alignment != 0) {
+      if (!ReadByte()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::optional<size_t> ReadSize() {
+    auto const byte{ReadByte()};
+    if (!byte) {
+      return std::nullopt;
+    }
+    if (*byte < 254) {
+      return *byte;
+    }
+    if (*byte == 254) {
+      return ReadScalar<uint16_t>();
+    }
+    return ReadScalar<uint32_t>();
+  }
+
+  template <typename T> std::optional<EncodableValue> ReadVector() {
+    auto const size{ReadSize()};
+    if (!size || (sizeof(T) > 1 && !ReadAlignment(sizeof(T)))) {
+      return std::nullopt;
+    }
+    std::vector<T> values;
+    for (size_t i{0}; i < *size; ++i) {
+      auto const value{ReadScalar<T>()};
+      if (!value) {
+        return std::nullopt;
+      }
+      values.push_back(*value);
+    }
+    return EncodableValue(std::move(values));
+  }
+
+  std::optional<EncodableValue> ReadValue() {
+    auto const type{ReadByte()};
+    if (!type) {
+      return std::nullopt;
+    }
+    switch (static_cast<Type>(*type)) {
+    case Type::kNull:
+      return EncodableValue();
+    case Type::kTrue:
+      return EncodableValue(true);
+    case Type::kFalse:
+      return EncodableValue(false);
+    case Type::kInt32:
+      if (auto const value{ReadScalar<int32_t>()}) {
+        return EncodableValue(*value);
+      }
+      return std::nullopt;
+    case Type::kInt64:
+      if (auto const value{ReadScalar<int64_t>()}) {
+        return EncodableValue(*value);
+      }
+      return std::nullopt;
+    case Type::kFloat64:
+      if (!ReadAlignment(8)) {
+        return std::nullopt;
+      }
+      if (auto const value{ReadScalar<double>()}) {
+        return EncodableValue(*value);
+      }
+      return std::nullopt;
+    case Type::kString: {
+      auto const size{ReadSize()};
+      if (!size || size_ - position_ < *size) {
+        return std::nullopt;
+      }
+      std::string value(reinterpret_cast<char const *>(bytes_ + position_),
+                        *size);
+      position_ += *size;
+      return EncodableValue(std::move(value));
+    }
+    case Type::kUInt8List:
+      return ReadVector<uint8_t>();
+    case Type::kInt32List:
+      return ReadVector<int32_t>();
+    case Type::kInt64List:
+      return ReadVector<int64_t>();
+    case Type::kFloat64List:
+      return ReadVector<double>();
+    case Type::kFloat32List:
+      return ReadVector<float>();
+    case Type::kList: {
+      auto const size{ReadSize()};
+      if (!size) {
+        return std::nullopt;
+      }
+      EncodableList list;
+      for (size_t i{0}; i < *size; ++i) {
+        auto element{ReadValue()};
+        if (!element) {
+          return std::nullopt;
+        }
+        list.push_back(std::move(*element));
+      }
+      return EncodableValue(std::move(list));
+    }
+    case Type::kMap: {
+      auto const size{ReadSize()};
+      if (!size) {
+        return std::nullopt;
+      }
+      EncodableMap map;
+      for (size_t i{0}; i < *size; ++i) {
+        auto key{ReadValue()};
+        auto element{key ? ReadValue() : std::nullopt};
+        if (!element) {
+          return std::nullopt;
+        }
+        map.emplace(std::move(*key), std::move(*element));
+      }
+      return EncodableValue(std::move(map));
+    }
+    }
+    return std::nullopt;
+  }
+
+private:
+  uint8_t const *bytes_;
+  size_t size_;
+  size_t position_ = 0;
+};
+
+} // namespace
+
+StandardMethodCodec const &StandardMethodCodec::GetInstance() {
+  static StandardMethodCodec const instance;
+  return instance;
+}
+
+std::unique_ptr<MethodCall<EncodableValue>>
+StandardMethodCodec::DecodeMethodCall(uint8_t const *message,
+                                      size_t message_size) const {
+  Reader reader(message, message_size);
+  auto name{reader.ReadValue()};
+  if (!name || !std::holds_alternative<std::string>(*name)) {
+    return nullptr;
+  }
+  auto arguments{reader.ReadValue()};
+  if (!arguments || !reader.at_end()) {
+    return nullptr;
+  }
+  return std::make_unique<MethodCall<EncodableValue>>(
+      std::get<std::string>(*name),
+      std::make_unique<EncodableValue>(std::move(*arguments)));
+}
+
+std::unique_ptr<std::vector<uint8_t>> StandardMethodCodec::EncodeMethodCall(
+    MethodCall<EncodableValue> const &method_call) const {
+  auto bytes{std::make_unique<std::vector<uint8_t>>()};
+  Writer writer(*bytes);
+  writer.WriteValue(EncodableValue(method_call.method_name()));
+  writer.WriteValue(method_call.arguments() ? *method_call.arguments()
+                                            : EncodableValue());
+  return bytes;
+}
+
+std::unique_ptr<std::vector<uint8_t>>
+StandardMethodCodec::EncodeSuccessEnvelope(EncodableValue const *result) const {
+  auto bytes{std::make_unique<std::vector<uint8_t>>()};
+  Writer writer(*bytes);
+  writer.WriteByte(0);
+  writer.WriteValue(result ? *result : EncodableValue());
+  return bytes;
+}
+
+std::unique_ptr<std::vector<uint8_t>> StandardMethodCodec::EncodeErrorEnvelope(
+    std::string const &error_code, std::string const &error_message,
+    EncodableValue const *error_details) const {
+  auto bytes{std::make_unique<std::vector<uint8_t>>()};
+  Writer writer(*bytes);
+  writer.WriteByte(1);
+  writer.WriteValue(EncodableValue(error_code));
+  writer.WriteValue(error_message.empty() ? EncodableValue()
+                                          : EncodableValue(error_message));
+  writer.WriteValue(error_details ? *error_details : EncodableValue());
+  return bytes;
+}
+
+bool StandardMethodCodec::DecodeAndProcessResponseEnvelope(
+    uint8_t const *response, size_t response_size,
+    MethodResult<EncodableValue> *result) const {
+  if (response_size == 0) {
+    result->NotImplemented();
+    return true;
+  }
+  Reader reader(response, response_size);
+  auto const kind{reader.ReadByte()};
+  if (kind == 0) {
+    auto const value{reader.ReadValue()};
+    if (!value) {
+      return false;
+    }
+    if (value->IsNull()) {
+      result->Success();
+    } else {
+      result->Success(*value);
+    }
+    return true;
+  }
+  auto const code{reader.ReadValue()};
+  auto const message{code ? reader.ReadValue() : std::nullopt};
+  auto const details{message ? reader.ReadValue() : std::nullopt};
+  if (kind != 1 || !details || !std::holds_alternative<std::string>(*code)) {
+    return false;
+  }
+  auto const *const message_string{std::get_if<std::string>(&*message)};
+  auto const error_message{message_string ? *message_string : std::string{}};
+  if (details->IsNull()) {
+    result->Error(std::get<std::string>(*code), error_message);
+  } else {
+    result->Error(std::get<std::string>(*code), error_message, *details);
+  }
+  return true;
+}
+
+} // namespace flutter
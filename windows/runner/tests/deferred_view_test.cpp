@@ -0,0 +1,57 @@
+#include "test_support.h"
+
+// Windows created with deferred views get their view and are announced once
+// visible or realized by Dart, and are never announced if destroyed first,
+// however they are destroyed.
+
+int main() {
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+  auto &backend{harness.backend()};
+  auto const deferred{ViewCreation::deferred};
+
+  auto const main_window{
+      manager.createRegularWindow(L"main", {10, 10}, {640, 480}, 0, deferred)};
+  auto const back_window{
+      manager.createRegularWindow(L"back", {20, 20}, {320, 240}, 0, deferred)};
+  auto const closed_window{
+      manager.createRegularWindow(L"closed", {30, 30}, {320, 240}, 0, deferred)};
+  CHECK(main_window && back_window && closed_window);
+  CHECK(harness.TakeSentCalls().empty());
+
+  backend.SetOcclusion(manager.windows().at(*back_window)->GetHandle(),
+                       {.cloaked = false, .occluded = true});
+
+  // Closed by the system rather than by the manager: FlutterWindow::OnDestroy
+  // runs after the handle is cleared.
+  backend.SendWindowMessage(manager.windows().at(*closed_window)->GetHandle(),
+                            WM_CLOSE, 0, 0);
+  auto const &closed{*manager.windows().at(*closed_window)};
+  CHECK(closed.closed());
+  CHECK(!closed.deferred());
+  CHECK(!manager.realizeWindow(*closed_window).has_value());
+
+  // The visible main window is realized; the occluded one stays deferred.
+  backend.RunPostedTasks();
+  auto calls{harness.TakeSentCalls()};
+  CHECK_EQ(calls.size(), size_t{2});
+  CHECK(calls.size() == 2 && calls[0].method == "onWindowCreated" &&
+        calls[1].method == "onWindowResized");
+  CHECK(manager.windows().at(*back_window)->deferred());
+
+  // Dart realizes the rest, which leaves out the closed window.
+  auto const response{harness.Call("realizeWindows")};
+  CHECK(response.ok());
+  auto const *const view_ids{
+      std::get_if<flutter::EncodableList>(&response.value)};
+  CHECK(view_ids && view_ids->size() == 1);
+  calls = harness.TakeSentCalls();
+  CHECK_EQ(std::ranges::count(calls, std::string("onWindowCreated"),
+                              &flw::test::SentCall::method),
+           1);
+  for (auto const &[id, window] : manager.windows()) {
+    CHECK(!window->deferred());
+  }
+
+  return flw::test::Finish("deferred_view_test");
+}
@@ -0,0 +1,49 @@
+#include <tuple>
+
+#include "test_support.h"
+
+// Moving to a monitor with another DPI resizes the frame and the content in a
+// single geometry batch, and Dart hears of it once, at the new size and scale.
+// The suggested frames keep the logical size of the window at 400x300.
+
+namespace {
+
+auto DevicePixelRatio(flw::test::SentCall const &call) -> double {
+  auto const &map{std::get<flutter::EncodableMap>(call.arguments)};
+  return std::get<double>(map.at(flutter::EncodableValue("devicePixelRatio")));
+}
+
+} // namespace
+
+int main() {
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+  auto &backend{harness.backend()};
+  auto const window{manager.createRegularWindow(L"window", {0, 0}, {400, 300})};
+  CHECK(window.has_value());
+  auto const handle{manager.windows().at(*window)->GetHandle()};
+  harness.TakeSentCalls();
+
+  for (auto const &[dpi, width, height] :
+       {std::tuple{144u, 600, 450}, std::tuple{96u, 400, 300}}) {
+    auto const batches{backend.counters().geometry_batches};
+    backend.ChangeDpi(handle, dpi, {100, 100, 100 + width, 100 + height});
+    CHECK_EQ(backend.counters().geometry_batches, batches + 1);
+
+    std::vector<flw::test::SentCall> resizes;
+    for (auto const &call : harness.TakeSentCalls()) {
+      if (call.method == "onWindowResized") {
+        resizes.push_back(call);
+      }
+    }
+    CHECK_EQ(resizes.size(), size_t{1});
+    if (resizes.size() == 1) {
+      CHECK(resizes[0].Int("viewId") == *window);
+      CHECK(resizes[0].Int("width") == 400);
+      CHECK(resizes[0].Int("height") == 300);
+      CHECK(DevicePixelRatio(resizes[0]) == dpi / 96.0);
+    }
+  }
+
+  return flw::test::Finish("dpi_change_test");
+}
@@ -0,0 +1,81 @@
+#include "test_support.h"
+
+#include "geometry_transaction.h"
+
+// Geometry changes are committed in batches: a transaction keeps the last frame
+// set for each window and drops the frames that would not change, a resize
+// moves a window and its content together, and moving a parent moves all of
+// its satellites in one further batch.
+
+int main() {
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+  auto &backend{harness.backend()};
+  auto const &counters{backend.counters()};
+
+  {
+    auto const first{backend.CreateContentWindow({0, 0, 100, 100})};
+    auto const second{backend.CreateContentWindow({0, 0, 100, 100})};
+    auto const batches{counters.geometry_batches};
+    auto const frame_changes{counters.frame_changes};
+
+    // Unchanged frames commit nothing.
+    {
+      GeometryTransaction transaction;
+      transaction.SetFrame(first, {0, 0, 100, 100});
+      CHECK(!transaction.empty());
+    }
+    CHECK_EQ(counters.geometry_batches, batches);
+
+    // The last frame set for a window wins, and the transaction commits once
+    // whether or not it is committed before going out of scope.
+    {
+      GeometryTransaction transaction;
+      transaction.SetFrame(first, {10, 0, 110, 100});
+      transaction.SetFrame(first, {20, 0, 120, 100});
+      transaction.SetFrame(second, {0, 0, 200, 100});
+      transaction.Commit();
+      CHECK(transaction.empty());
+    }
+    CHECK_EQ(counters.geometry_batches, batches + 1);
+    CHECK_EQ(counters.frame_changes, frame_changes + 2);
+    CHECK_EQ(backend.GetWindowRect(first).left, 20);
+    CHECK_EQ(backend.GetWindowRect(second).right, 200);
+  }
+
+  auto const parent{manager.createRegularWindow(L"parent", {0, 0}, {400, 300})};
+  CHECK(parent.has_value());
+  std::vector<flutter::FlutterViewId> satellites;
+  for (int i{0}; i < 3; ++i) {
+    auto const satellite{manager.createSatelliteWindow(
+        L"satellite", {420, 110 * i}, {100, 100}, *parent)};
+    CHECK(satellite.has_value());
+    satellites.push_back(*satellite);
+  }
+
+  // Moving the parent is one batch, and its satellites follow in another.
+  auto batches{counters.geometry_batches};
+  auto frame_changes{counters.frame_changes};
+  CHECK(manager.moveWindow(*parent, {50, 40}, {400, 300}));
+  CHECK_EQ(counters.geometry_batches, batches + 2);
+  CHECK_EQ(counters.frame_changes, frame_changes + 4);
+  for (int i{0}; i < 3; ++i) {
+    auto const &frame{manager.windows().at(satellites[i])->geometry().frame};
+    CHECK_EQ(frame.left, 470);
+    CHECK_EQ(frame.top, 40 + 110 * i);
+  }
+
+  // Resizing in place moves the frame and then the content.
+  batches = counters.geometry_batches;
+  frame_changes = counters.frame_changes;
+  CHECK(manager.moveWindow(*parent, {50, 40}, {500, 300}));
+  CHECK_EQ(counters.frame_changes, frame_changes + 2);
+  CHECK_EQ(counters.geometry_batches, batches + 2);
+
+  // Moving to the current frame commits nothing.
+  batches = counters.geometry_batches;
+  CHECK(manager.moveWindow(*parent, {50, 40}, {500, 300}));
+  CHECK_EQ(counters.geometry_batches, batches);
+
+  return flw::test::Finish("geometry_transaction_test");
+}
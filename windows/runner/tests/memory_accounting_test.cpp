@@ -0,0 +1,68 @@
+#include "test_support.h"
+
+#include <new>
+
+#include "memory_accounting.h"
+
+// Built with FLW_ENABLE_ALLOCATION_ACCOUNTING. Only the allocations made while
+// creating a window's view are charged to it, the counters of destroyed
+// windows are reused, and the replaced operator new reports failure the way
+// the standard ones do.
+
+namespace {
+
+auto MemoryOf(flutter::FlutterViewId window_id)
+    -> flw::memory::MemoryCounters const & {
+  return FlutterWindowManager::instance().windows().at(window_id)->memory();
+}
+
+} // namespace
+
+int main() {
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+  auto &backend{harness.backend()};
+
+  auto const window{manager.createRegularWindow(L"window", {0, 0}, {400, 300})};
+  CHECK(window.has_value());
+  auto const &memory{MemoryOf(*window)};
+  auto const view_allocations{memory.runner_allocations.load()};
+  CHECK(view_allocations > 0);
+
+  // Messages grow shared state, such as statistics, which is not the window's.
+  auto const handle{manager.windows().at(*window)->GetHandle()};
+  for (int i{0}; i < 100; ++i) {
+    CHECK(manager.moveWindow(*window, {i, i}, {400, 300}));
+    backend.SendWindowMessage(handle, WM_ACTIVATE, WA_ACTIVE, 0);
+  }
+  CHECK_EQ(memory.runner_allocations.load(), view_allocations);
+
+  // The counters of a destroyed window are reused once it is freed, which the
+  // next window creation does.
+  auto const *const counters{&memory};
+  CHECK(manager.destroyWindow(*window, true));
+  auto const next{manager.createRegularWindow(L"next", {0, 0}, {400, 300})};
+  CHECK(next.has_value());
+  CHECK(manager.destroyWindow(*next, true));
+  auto const last{manager.createRegularWindow(L"last", {0, 0}, {400, 300})};
+  CHECK(last.has_value());
+  CHECK(&MemoryOf(*last) == counters);
+  CHECK_EQ(MemoryOf(*last).runner_allocations.load(), view_allocations);
+  CHECK(manager.destroyWindow(*last, true));
+
+  // Allocations that cannot be satisfied throw or return null.
+  std::size_t volatile const too_large{~std::size_t{0} / 2};
+  CHECK(::operator new(too_large, std::nothrow) == nullptr);
+  auto threw{false};
+  try {
+    ::operator delete(::operator new(too_large));
+  } catch (std::bad_alloc const &) {
+    threw = true;
+  }
+  CHECK(threw);
+  auto *const small{::operator new(16, std::nothrow)};
+  CHECK(small != nullptr);
+  ::operator delete(small, std::nothrow);
+
+  return flw::test::Finish("memory_accounting_test");
+}
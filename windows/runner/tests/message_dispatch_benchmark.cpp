@@ -0,0 +1,190 @@
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "test_support.h"
+
+#include "message_log.h"
+#include "message_routes.h"
+
+// Replays message mixes through the two ways of dispatching a window message
+// to its route: the router RouteMessage generates at compile time, as windows
+// use, and a binary search of the route table at run time. Both must agree on
+// every message. Reports the time per message of each.
+//
+// The routes are those of a regular window, with stub handlers. The mixes are
+// the message records of the logs given as arguments, recorded with
+// FLW_RECORD_FILE, or else built-in mixes of a drag, pointer input and
+// activation changes, replayed from logs written here.
+
+namespace {
+
+// Messages the runner does not route, by their Win32 values.
+constexpr UINT kPaint{0x000F};
+constexpr UINT kEraseBackground{0x0014};
+constexpr UINT kSetCursor{0x0020};
+constexpr UINT kGetMinMaxInfo{0x0024};
+constexpr UINT kNcCalcSize{0x0083};
+constexpr UINT kNcHitTest{0x0084};
+constexpr UINT kKeyDown{0x0100};
+constexpr UINT kKeyUp{0x0101};
+constexpr UINT kChar{0x0102};
+constexpr UINT kMouseMove{0x0200};
+constexpr UINT kLeftButtonDown{0x0201};
+constexpr UINT kLeftButtonUp{0x0202};
+
+constexpr size_t kMessagesPerStrategy{4'000'000};
+
+struct Target {
+  uint64_t handled = 0;
+};
+
+// Handles a message, passing it on to DefWindowProc unless it has a result.
+template <LRESULT kResult>
+auto Handle(Target &target, HWND, WPARAM wparam, LPARAM)
+    -> std::optional<LRESULT> {
+  target.handled += wparam;
+  if constexpr (kResult < 0) {
+    return std::nullopt;
+  } else {
+    return kResult;
+  }
+}
+
+using Route = flw::MessageRoute<Target>;
+
+constexpr auto kRoutes{flw::MakeMessageRoutes<Target>(
+    Route{WM_DESTROY, &Handle<0>}, Route{WM_DPICHANGED, &Handle<0>},
+    Route{WM_SIZE, &Handle<0>}, Route{WM_TIMER, &Handle<-1>},
+    Route{WM_ENTERSIZEMOVE, &Handle<-1>},
+    Route{WM_WINDOWPOSCHANGING, &Handle<-1>},
+    Route{WM_WINDOWPOSCHANGED, &Handle<-1>},
+    Route{WM_DISPLAYCHANGE, &Handle<-1>}, Route{WM_MOVE, &Handle<-1>},
+    Route{WM_EXITSIZEMOVE, &Handle<-1>}, Route{WM_ACTIVATE, &Handle<0>},
+    Route{WM_ACTIVATEAPP, &Handle<0>}, Route{WM_MOUSEACTIVATE, &Handle<1>},
+    Route{WM_NCACTIVATE, &Handle<-1>})};
+
+struct Mix {
+  std::string name;
+  std::vector<UINT> messages;
+};
+
+auto BuiltInMixes() -> std::vector<Mix> {
+  return {
+      {"drag",
+       {WM_ENTERSIZEMOVE, kNcHitTest, kSetCursor, kMouseMove,
+        WM_WINDOWPOSCHANGING, kGetMinMaxInfo, kNcCalcSize,
+        WM_WINDOWPOSCHANGED, WM_MOVE, WM_SIZE, kPaint, kEraseBackground,
+        WM_EXITSIZEMOVE}},
+      {"pointer",
+       {kNcHitTest, kSetCursor, kMouseMove, kNcHitTest, kSetCursor,
+        kMouseMove, WM_MOUSEACTIVATE, kLeftButtonDown, kLeftButtonUp}},
+      {"activation",
+       {WM_ACTIVATEAPP, WM_NCACTIVATE, WM_ACTIVATE, WM_SETFOCUS, kKeyDown,
+        kChar, kKeyUp, WM_KILLFOCUS, WM_TIMER}},
+  };
+}
+
+// Returns the messages of the log at |path|, in order.
+auto ReadMix(std::filesystem::path const &path) -> std::vector<UINT> {
+  std::vector<UINT> messages;
+  flw::log::Reader reader;
+  if (!reader.Open(path)) {
+    return messages;
+  }
+  while (auto const record{reader.Next()}) {
+    if (record->kind == flw::log::RecordKind::message) {
+      messages.push_back(record->message);
+    }
+  }
+  return messages;
+}
+
+struct Outcome {
+  uint64_t handled = 0;
+  uint64_t results = 0;
+  double ns_per_message = 0;
+};
+
+// Dispatches the messages of |mix| in a loop with |dispatch|.
+template <typename Dispatch>
+auto Run(std::vector<UINT> const &mix, Dispatch &&dispatch) -> Outcome {
+  Outcome outcome;
+  Target target;
+  auto const start{std::chrono::steady_clock::now()};
+  size_t dispatched{0};
+  while (dispatched < kMessagesPerStrategy) {
+    for (auto const message : mix) {
+      if (auto const result{dispatch(target, message)}) {
+        outcome.results += static_cast<uint64_t>(*result) + 1;
+      }
+    }
+    dispatched += mix.size();
+  }
+  auto const elapsed{std::chrono::steady_clock::now() - start};
+  outcome.handled = target.handled;
+  outcome.ns_per_message =
+      std::chrono::duration<double, std::nano>(elapsed).count() /
+      static_cast<double>(dispatched);
+  return outcome;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::vector<Mix> mixes;
+  for (int i{1}; i < argc; ++i) {
+    mixes.push_back({std::filesystem::path(argv[i]).filename().string(),
+                     ReadMix(argv[i])});
+  }
+  if (mixes.empty()) {
+    // Round-trips the built-in mixes through logs, as recorded mixes are.
+    auto const path{std::filesystem::temp_directory_path() /
+                    "message_dispatch_benchmark.flwr"};
+    for (auto mix : BuiltInMixes()) {
+      {
+        flw::log::Writer writer;
+        CHECK(writer.Open(path));
+        for (auto const message : mix.messages) {
+          writer.Write({.kind = flw::log::RecordKind::message,
+                        .message = message,
+                        .wparam = 1});
+        }
+      }
+      mix.messages = ReadMix(path);
+      mixes.push_back(std::move(mix));
+    }
+    std::filesystem::remove(path);
+  }
+
+  // Read through volatile pointers, as Win32Window chooses its routes at run
+  // time, so that neither strategy is folded into the loop.
+  flw::MessageRouter<Target> volatile const router{
+      &flw::RouteMessage<Target, kRoutes>};
+  Route const *volatile const table{kRoutes.data()};
+
+  std::printf("mix,messages,switch_ns,table_ns\n");
+  for (auto const &[name, messages] : mixes) {
+    CHECK(!messages.empty());
+    if (messages.empty()) {
+      continue;
+    }
+    auto const routed{Run(messages, [router](Target &target, UINT message) {
+      return router(target, nullptr, message, 1, 0);
+    })};
+    auto const searched{
+        Run(messages, [table](Target &target, UINT message) {
+          auto const handler{flw::FindMessageHandler<Target>(
+              std::span(table, kRoutes.size()), message)};
+          return handler ? handler(target, nullptr, 1, 0) : std::nullopt;
+        })};
+    CHECK_EQ(routed.handled, searched.handled);
+    CHECK_EQ(routed.results, searched.results);
+    std::printf("%s,%zu,%.2f,%.2f\n", name.c_str(), messages.size(),
+                routed.ns_per_message, searched.ns_per_message);
+  }
+
+  return flw::test::Finish("message_dispatch_benchmark");
+}
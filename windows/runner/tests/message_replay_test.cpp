@@ -0,0 +1,125 @@
+#include <filesystem>
+#include <fstream>
+
+#include "test_support.h"
+
+#include "message_log.h"
+#include "message_replay.h"
+
+// Message logs read back the records written to them and stop at a truncated
+// record, and replaying a log sends its messages to the windows they were
+// recorded for and its method calls to the manager.
+
+namespace {
+
+auto LogPath(char const *name) -> std::filesystem::path {
+  return std::filesystem::temp_directory_path() / name;
+}
+
+} // namespace
+
+int main() {
+  auto const path{LogPath("message_replay_test.flwr")};
+  RECT const dpi_frame{100, 100, 700, 550};
+  std::vector<uint8_t> const dpi_payload{
+      reinterpret_cast<uint8_t const *>(&dpi_frame),
+      reinterpret_cast<uint8_t const *>(&dpi_frame) + sizeof(dpi_frame)};
+  auto const create_call{flutter::StandardMethodCodec::GetInstance()
+                             .EncodeMethodCall(flutter::MethodCall<>(
+                                 "createRegularWindow",
+                                 std::make_unique<flutter::EncodableValue>(
+                                     flutter::EncodableMap{
+                                         {flw::test::Key("width"),
+                                          flutter::EncodableValue(400)},
+                                         {flw::test::Key("height"),
+                                          flutter::EncodableValue(300)}})))};
+  {
+    flw::log::Writer writer;
+    CHECK(writer.Open(path));
+    writer.Write({.kind = flw::log::RecordKind::window_created,
+                  .delta_us = 1'000'000,
+                  .window = 0,
+                  .archetype = 0,
+                  .parent = -1});
+    writer.Write({.kind = flw::log::RecordKind::message,
+                  .delta_us = 16,
+                  .window = 0,
+                  .message = WM_DPICHANGED,
+                  .wparam = MAKEWPARAM(144, 144),
+                  .lparam = 0,
+                  .payload = dpi_payload});
+    // A message for a window the replay does not have.
+    writer.Write({.kind = flw::log::RecordKind::message,
+                  .window = 7,
+                  .message = WM_SIZE,
+                  .wparam = SIZE_RESTORED,
+                  .lparam = -1});
+    writer.Write({.kind = flw::log::RecordKind::method_call,
+                  .payload = *create_call});
+    writer.Flush();
+  }
+
+  {
+    flw::log::Reader reader;
+    CHECK(reader.Open(path));
+    auto const created{reader.Next()};
+    CHECK(created && created->kind == flw::log::RecordKind::window_created);
+    CHECK(created && created->delta_us == 1'000'000 && created->parent == -1);
+    auto const dpi_changed{reader.Next()};
+    CHECK(dpi_changed && dpi_changed->message == WM_DPICHANGED);
+    CHECK(dpi_changed && dpi_changed->payload == dpi_payload);
+    auto const resized{reader.Next()};
+    CHECK(resized && resized->window == 7 && resized->lparam == -1);
+    auto const call{reader.Next()};
+    CHECK(call && call->kind == flw::log::RecordKind::method_call);
+    CHECK(call && call->payload == *create_call);
+    CHECK(!reader.Next());
+  }
+
+  // A truncated log yields the records before the cut.
+  auto const truncated{LogPath("message_replay_test_truncated.flwr")};
+  std::filesystem::copy_file(
+      path, truncated, std::filesystem::copy_options::overwrite_existing);
+  std::filesystem::resize_file(truncated,
+                               std::filesystem::file_size(path) - 1);
+  {
+    flw::log::Reader reader;
+    CHECK(reader.Open(truncated));
+    auto records{0};
+    while (reader.Next()) {
+      ++records;
+    }
+    CHECK_EQ(records, 3);
+  }
+  std::ofstream(truncated, std::ios::binary | std::ios::trunc) << "FLWX";
+  {
+    flw::log::Reader reader;
+    CHECK(!reader.Open(truncated));
+  }
+
+  // Window 0 of the log is the first window created in this process.
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+  auto const window{manager.createRegularWindow(L"window", {0, 0}, {400, 300})};
+  CHECK(window.has_value());
+  auto const windows_before{manager.windows().size()};
+
+  auto const reports{ReplayScenarios({path, LogPath("missing.flwr")})};
+  CHECK_EQ(reports.size(), size_t{2});
+  if (reports.size() == 2) {
+    CHECK(reports[0].loaded);
+    CHECK_EQ(reports[0].messages, uint64_t{1});
+    CHECK_EQ(reports[0].method_calls, uint64_t{1});
+    // The created window is announced, and the DPI change resizes the other.
+    CHECK(reports[0].events_emitted >= 2);
+    CHECK(!reports[1].loaded);
+  }
+  CHECK_EQ(manager.windows().size(), windows_before + 1);
+  auto const &frame{manager.windows().at(*window)->geometry().frame};
+  CHECK_EQ(frame.left, dpi_frame.left);
+  CHECK_EQ(frame.right, dpi_frame.right);
+
+  std::filesystem::remove(path);
+  std::filesystem::remove(truncated);
+  return flw::test::Finish("message_replay_test");
+}
@@ -0,0 +1,86 @@
+#include "message_routes.h"
+#include "test_support.h"
+
+// Route tables are sorted at compile time, the router generated from a table
+// dispatches every message as a lookup in the table would, and each archetype
+// handles only the messages routed for it.
+
+namespace {
+
+struct Target {
+  int handled = 0;
+};
+
+template <LRESULT kResult>
+auto Handle(Target &target, HWND, WPARAM, LPARAM) -> std::optional<LRESULT> {
+  ++target.handled;
+  return kResult;
+}
+
+using Route = flw::MessageRoute<Target>;
+
+constexpr auto kRoutes{flw::MakeMessageRoutes<Target>(
+    Route{WM_SIZE, &Handle<1>}, Route{WM_DESTROY, &Handle<2>},
+    Route{WM_TIMER, &Handle<3>}, Route{WM_MOVE, &Handle<4>})};
+
+static_assert(std::ranges::is_sorted(kRoutes, {}, &Route::message));
+
+auto Dispatch(UINT message) -> std::optional<LRESULT> {
+  Target target;
+  auto const handler{
+      flw::FindMessageHandler<Target>(std::span(kRoutes), message)};
+  return handler ? handler(target, nullptr, 0, 0) : std::nullopt;
+}
+
+} // namespace
+
+int main() {
+  CHECK(Dispatch(WM_SIZE) == 1);
+  CHECK(Dispatch(WM_DESTROY) == 2);
+  CHECK(Dispatch(WM_TIMER) == 3);
+  CHECK(Dispatch(WM_MOVE) == 4);
+  // Messages before, between and after the routed ones.
+  CHECK(!Dispatch(0));
+  CHECK(!Dispatch(WM_CLOSE));
+  CHECK(!Dispatch(0xFFFF));
+  for (UINT message{0}; message < 0x400; ++message) {
+    Target target;
+    auto const routed{
+        flw::RouteMessage<Target, kRoutes>(target, nullptr, message, 0, 0)};
+    CHECK(routed == Dispatch(message));
+  }
+
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+  auto &backend{harness.backend()};
+  auto const handle{[&manager](flutter::FlutterViewId id) {
+    return manager.windows().at(id)->GetHandle();
+  }};
+
+  auto const main_window{
+      manager.createRegularWindow(L"main", {0, 0}, {400, 300})};
+  auto const popup{
+      manager.createPopupWindow(L"popup", {10, 10}, {50, 50}, *main_window)};
+  auto const tip{
+      manager.createTipWindow(L"tip", {20, 20}, {50, 20}, *main_window)};
+  CHECK(main_window && popup && tip);
+
+  // Tips never take activation; other windows do.
+  CHECK_EQ(backend.SendWindowMessage(handle(*tip), WM_MOUSEACTIVATE, 0, 0),
+           MA_NOACTIVATE);
+  CHECK_EQ(backend.SendWindowMessage(handle(*popup), WM_MOUSEACTIVATE, 0, 0),
+           MA_ACTIVATE);
+  CHECK_EQ(
+      backend.SendWindowMessage(handle(*main_window), WM_MOUSEACTIVATE, 0, 0),
+      MA_ACTIVATE);
+
+  // A window with popups keeps its title bar active. Popups have no route for
+  // WM_NCACTIVATE and get the default processing.
+  CHECK_EQ(
+      backend.SendWindowMessage(handle(*main_window), WM_NCACTIVATE, FALSE, 0),
+      TRUE);
+  CHECK_EQ(backend.SendWindowMessage(handle(*popup), WM_NCACTIVATE, FALSE, 0),
+           0);
+
+  return flw::test::Finish("message_routes_test");
+}
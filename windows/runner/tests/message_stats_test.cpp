@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "message_stats.h"
+#include "test_support.h"
+
+// LatencyHistogram reports exact counts, minimums, maximums and means, exact
+// percentiles below the first sub-bucketed power of two, and percentiles no
+// more than one sub-bucket (1/16) above the exact value elsewhere. Samples
+// are clamped to 2^40 - 1. MessageStats keeps one histogram per key.
+
+namespace {
+
+constexpr uint64_t kMaxValue{(uint64_t{1} << 40) - 1};
+constexpr double kPercentiles[]{0,  1,  10, 25,   50,   75,
+                                90, 95, 99, 99.9, 99.99, 100};
+
+// The sample that |percentile| percent of |sorted| are less than or equal to.
+auto ExactPercentile(std::vector<uint64_t> const &sorted, double percentile)
+    -> uint64_t {
+  auto const rank{std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * sorted.size())))};
+  return sorted[rank - 1];
+}
+
+// Records |samples| and checks the histogram against exact statistics.
+void CheckDistribution(std::vector<uint64_t> samples) {
+  LatencyHistogram histogram;
+  uint64_t sum{0};
+  for (auto const sample : samples) {
+    histogram.Record(sample);
+    sum += sample;
+  }
+  std::ranges::sort(samples);
+
+  CHECK_EQ(histogram.count(), samples.size());
+  CHECK_EQ(histogram.min(), samples.front());
+  CHECK_EQ(histogram.max(), samples.back());
+  CHECK_EQ(histogram.mean(), sum / samples.size());
+  for (auto const percentile : kPercentiles) {
+    auto const exact{ExactPercentile(samples, percentile)};
+    auto const reported{histogram.ValueAtPercentile(percentile)};
+    CHECK(reported >= exact);
+    CHECK(reported <= exact + exact / 16);
+  }
+}
+
+} // namespace
+
+int main() {
+  // No samples.
+  {
+    LatencyHistogram const histogram;
+    CHECK_EQ(histogram.count(), 0u);
+    CHECK_EQ(histogram.min(), 0u);
+    CHECK_EQ(histogram.max(), 0u);
+    CHECK_EQ(histogram.mean(), 0u);
+    CHECK_EQ(histogram.ValueAtPercentile(50), 0u);
+  }
+
+  // Values below 16 have a bucket each and are reported exactly.
+  {
+    LatencyHistogram histogram;
+    for (uint64_t value{0}; value < 16; ++value) {
+      histogram.Record(value);
+    }
+    for (uint64_t rank{1}; rank <= 16; ++rank) {
+      CHECK_EQ(histogram.ValueAtPercentile(rank * 100.0 / 16), rank - 1);
+    }
+    CHECK_EQ(histogram.ValueAtPercentile(0), 0u);
+    CHECK_EQ(histogram.mean(), 7u);
+  }
+
+  // A single sample is every percentile, whatever its bucket.
+  {
+    LatencyHistogram histogram;
+    histogram.Record(123456789);
+    for (auto const percentile : kPercentiles) {
+      CHECK_EQ(histogram.ValueAtPercentile(percentile), 123456789u);
+    }
+  }
+
+  // Uniform 1..1000, and every power of two with its neighbours, which sit at
+  // the edges of the sub-buckets.
+  {
+    std::vector<uint64_t> uniform;
+    for (uint64_t value{1}; value <= 1000; ++value) {
+      uniform.push_back(value);
+    }
+    CheckDistribution(uniform);
+
+    std::vector<uint64_t> edges;
+    for (int bit{0}; bit < 40; ++bit) {
+      auto const power{uint64_t{1} << bit};
+      edges.insert(edges.end(), {power - 1, power, power + 1});
+    }
+    CheckDistribution(edges);
+  }
+
+  // Log-uniform values over the whole range, as handler latencies spread, and
+  // a bimodal mix of fast handlers and slow outliers.
+  {
+    std::mt19937_64 random{26};
+    std::uniform_real_distribution<double> exponent{0.0, 39.9};
+    std::vector<uint64_t> log_uniform;
+    for (int i{0}; i < 100000; ++i) {
+      log_uniform.push_back(static_cast<uint64_t>(std::exp2(exponent(random))));
+    }
+    CheckDistribution(log_uniform);
+
+    std::normal_distribution<double> fast{2000, 300};
+    std::normal_distribution<double> slow{5000000, 1000000};
+    std::vector<uint64_t> bimodal;
+    for (int i{0}; i < 100000; ++i) {
+      auto const sample{i % 100 == 0 ? slow(random) : fast(random)};
+      bimodal.push_back(static_cast<uint64_t>(std::max(sample, 0.0)));
+    }
+    CheckDistribution(bimodal);
+  }
+
+  // Samples from 2^40 up are clamped into the top bucket, along with their
+  // sum, so the mean cannot overflow.
+  {
+    LatencyHistogram histogram;
+    histogram.Record(kMaxValue);
+    histogram.Record(kMaxValue + 1);
+    histogram.Record(uint64_t{1} << 50);
+    histogram.Record(UINT64_MAX);
+    CHECK_EQ(histogram.count(), 4u);
+    CHECK_EQ(histogram.min(), kMaxValue);
+    CHECK_EQ(histogram.max(), kMaxValue);
+    CHECK_EQ(histogram.mean(), kMaxValue);
+    CHECK_EQ(histogram.ValueAtPercentile(0), kMaxValue);
+    CHECK_EQ(histogram.ValueAtPercentile(100), kMaxValue);
+
+    histogram.Record(1000);
+    CHECK_EQ(histogram.min(), 1000u);
+    CHECK(histogram.ValueAtPercentile(20) >= 1000);
+    CHECK(histogram.ValueAtPercentile(20) <= 1000 + 1000 / 16);
+    CHECK_EQ(histogram.ValueAtPercentile(21), kMaxValue);
+
+    histogram.Reset();
+    CHECK_EQ(histogram.count(), 0u);
+    CHECK_EQ(histogram.max(), 0u);
+    CHECK_EQ(histogram.ValueAtPercentile(100), 0u);
+  }
+
+  // MessageStats keeps a histogram per archetype, message and phase, and
+  // visits only those with samples.
+  {
+    auto &stats{MessageStats::instance()};
+    stats.Reset();
+    stats.Record({.archetype = 3, .message = 0xC123,
+                  .phase = MessageStats::Phase::resize_frame},
+                 100);
+    stats.Record({.archetype = 3, .message = 0xC123,
+                  .phase = MessageStats::Phase::resize_frame},
+                 300);
+    stats.Record({.archetype = 3, .message = 0xC123,
+                  .phase = MessageStats::Phase::dispatch},
+                 7);
+    int visited{0};
+    stats.ForEach([&](MessageStats::Key const &key,
+                      LatencyHistogram const &histogram) {
+      ++visited;
+      CHECK_EQ(key.archetype, 3);
+      CHECK_EQ(key.message, 0xC123u);
+      if (key.phase == MessageStats::Phase::resize_frame) {
+        CHECK_EQ(histogram.count(), 2u);
+        CHECK_EQ(histogram.mean(), 200u);
+      } else {
+        CHECK(key.phase == MessageStats::Phase::dispatch);
+        CHECK_EQ(histogram.max(), 7u);
+      }
+    });
+    CHECK_EQ(visited, 2);
+
+    stats.Reset();
+    visited = 0;
+    stats.ForEach([&](auto const &, auto const &) { ++visited; });
+    CHECK_EQ(visited, 0);
+  }
+
+  return flw::test::Finish("message_stats_test");
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+
+#include "test_support.h"
+
+// Each engine talks to its own windows over its own flw/window channel, with
+// the view IDs its engine assigned, and never hears about the windows of
+// another engine.
+
+namespace {
+
+using flutter::EncodableList;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+using flw::test::IntList;
+using flw::test::Key;
+
+auto PopupArguments(int parent) -> EncodableValue {
+  return EncodableValue(EncodableMap{
+      {Key("parent"), EncodableValue(parent)},
+      {Key("size"), IntList({50, 40})},
+      {Key("anchorRect"), IntList({0, 0, 10, 10})},
+      {Key("positionerParentAnchor"), EncodableValue(0)},
+      {Key("positionerChildAnchor"), EncodableValue(0)},
+      {Key("positionerOffset"), IntList({0, 0})},
+      {Key("positionerConstraintAdjustment"), EncodableValue(0)}});
+}
+
+auto SnapshotViewIds(flw::test::Harness &harness, EngineId engine)
+    -> std::vector<int64_t> {
+  auto const response{
+      harness.Call("getWindowsSnapshot", EncodableValue(), engine)};
+  CHECK(response.ok());
+  std::vector<int64_t> view_ids;
+  if (auto const *const map{std::get_if<EncodableMap>(&response.value)}) {
+    for (auto const &window : std::get<EncodableList>(map->at(Key("windows")))) {
+      view_ids.push_back(
+          std::get<EncodableMap>(window).at(Key("viewId")).LongValue());
+    }
+  }
+  std::ranges::sort(view_ids);
+  return view_ids;
+}
+
+} // namespace
+
+int main() {
+  flw::test::Harness harness(2);
+  auto &manager{harness.manager()};
+
+  auto const first{manager.createRegularWindow(L"first", {0, 0}, {400, 300})};
+  auto const second{
+      manager.createRegularWindow(L"second", {0, 0}, {400, 300}, 1)};
+  CHECK(first && second);
+  // Both engines number their views from 0; the window IDs differ.
+  CHECK_EQ(ViewIdOf(*first), ViewIdOf(*second));
+  CHECK(*first != *second);
+  CHECK_EQ(EngineIdOf(*second), EngineId{1});
+
+  auto const created_on{[&harness](EngineId engine) {
+    std::vector<int64_t> view_ids;
+    for (auto const &call : harness.TakeSentCalls(engine)) {
+      if (call.method == "onWindowCreated") {
+        view_ids.push_back(*call.Int("viewId"));
+      }
+    }
+    return view_ids;
+  }};
+  CHECK(created_on(0) == std::vector<int64_t>{0});
+  CHECK(created_on(1) == std::vector<int64_t>{0});
+
+  // A popup created over engine 1's channel belongs to engine 1.
+  auto const popup{harness.Call("createPopupWindow", PopupArguments(0), 1)};
+  CHECK(popup.ok());
+  auto const popup_view_id{popup.value.LongValue()};
+  CHECK(manager.windows().contains(WindowIdFor(1, popup_view_id)));
+  CHECK(manager.windows().at(WindowIdFor(1, popup_view_id))->parent() ==
+        manager.windows().at(*second).get());
+  CHECK(created_on(0).empty());
+  CHECK(created_on(1) == std::vector<int64_t>{popup_view_id});
+
+  CHECK(SnapshotViewIds(harness, 0) == std::vector<int64_t>{0});
+  CHECK(SnapshotViewIds(harness, 1) == (std::vector<int64_t>{0, popup_view_id}));
+
+  // Destroying view 0 over engine 1's channel leaves engine 0's view 0.
+  CHECK(harness
+            .Call("destroyWindow",
+                  EncodableValue(EncodableList{EncodableValue(0)}), 1)
+            .ok());
+  CHECK(!manager.windows().at(*first)->closed());
+  CHECK(manager.windows().at(*second)->closed());
+  CHECK(harness.TakeSentCalls(0).empty());
+
+  return flw::test::Finish("multi_engine_test");
+}
@@ -0,0 +1,61 @@
+#include "test_support.h"
+
+#include "message_stats.h"
+
+// Resizes arm a single next-frame callback until the engine renders, and that
+// callback runs along with the others waiting for the same frame instead of
+// replacing them.
+
+namespace {
+
+auto ResizeFrameCount() -> uint64_t {
+  uint64_t count{0};
+  MessageStats::instance().ForEach(
+      [&count](MessageStats::Key const &key, LatencyHistogram const &histogram) {
+        if (key.phase == MessageStats::Phase::resize_frame) {
+          count += histogram.count();
+        }
+      });
+  return count;
+}
+
+} // namespace
+
+int main() {
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+  auto &engine{harness.engine()};
+
+  auto const window{manager.createRegularWindow(L"window", {0, 0}, {400, 300})};
+  CHECK(window.has_value());
+  engine.RenderFrame();
+  MessageStats::instance().Reset();
+
+  // A callback armed before the resizes, such as a view's first frame.
+  auto first_frame_calls{0};
+  engine.AddNextFrameCallback([&first_frame_calls] { ++first_frame_calls; });
+  for (unsigned i{1}; i <= 10; ++i) {
+    CHECK(manager.moveWindow(*window, {0, 0}, {400 + i, 300 + i}));
+  }
+  engine.RenderFrame();
+  CHECK_EQ(first_frame_calls, 1);
+  CHECK_EQ(ResizeFrameCount(), uint64_t{1});
+
+  // Nothing is left armed once the frame is rendered.
+  engine.RenderFrame();
+  CHECK_EQ(first_frame_calls, 1);
+  CHECK_EQ(ResizeFrameCount(), uint64_t{1});
+
+  // The next resize measures again.
+  CHECK(manager.moveWindow(*window, {0, 0}, {500, 400}));
+  engine.RenderFrame();
+  CHECK_EQ(ResizeFrameCount(), uint64_t{2});
+
+  // A window destroyed before the frame leaves its callback harmless.
+  CHECK(manager.moveWindow(*window, {0, 0}, {600, 400}));
+  CHECK(manager.destroyWindow(*window, true));
+  engine.RenderFrame();
+  CHECK_EQ(ResizeFrameCount(), uint64_t{3});
+
+  return flw::test::Finish("next_frame_callback_test");
+}
@@ -0,0 +1,83 @@
+#include "test_support.h"
+
+// Satellites and popups closed by the system leave their parent's lists, so
+// that moving or deactivating the parent after they are freed does not reach
+// them. Run with RUNNER_TESTS_SANITIZE to catch a stale pointer. Satellites
+// that keep up with their parent are counted as such.
+
+namespace {
+
+auto FrameOf(flutter::FlutterViewId window_id) -> RECT {
+  return FlutterWindowManager::instance()
+      .windows()
+      .at(window_id)
+      ->geometry()
+      .frame;
+}
+
+} // namespace
+
+int main() {
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+  auto &backend{harness.backend()};
+
+  auto const parent{manager.createRegularWindow(L"parent", {0, 0}, {400, 300})};
+  CHECK(parent.has_value());
+  auto const satellite{manager.createSatelliteWindow(L"satellite", {420, 0},
+                                                     {100, 100}, *parent)};
+  auto const popup{
+      manager.createPopupWindow(L"popup", {10, 10}, {50, 50}, *parent)};
+  CHECK(satellite && popup);
+
+  // The system closes both; WM_DESTROY clears their handles before OnDestroy.
+  backend.SendWindowMessage(manager.windows().at(*satellite)->GetHandle(),
+                            WM_CLOSE, 0, 0);
+  backend.SendWindowMessage(manager.windows().at(*popup)->GetHandle(),
+                            WM_CLOSE, 0, 0);
+  CHECK(manager.windows().at(*satellite)->closed());
+  CHECK(manager.windows().at(*popup)->closed());
+
+  // Creating a window erases the closed ones, freeing them.
+  auto const follower{manager.createSatelliteWindow(L"follower", {420, 200},
+                                                    {100, 100}, *parent)};
+  CHECK(follower.has_value());
+  CHECK(!manager.windows().contains(*satellite));
+  CHECK(!manager.windows().contains(*popup));
+
+  // Moving the parent moves only the live satellite along.
+  auto const follower_before{FrameOf(*follower)};
+  CHECK(manager.moveWindow(*parent, {50, 40}, {400, 300}));
+  auto const follower_after{FrameOf(*follower)};
+  CHECK_EQ(follower_after.left - follower_before.left, 50);
+  CHECK_EQ(follower_after.top - follower_before.top, 40);
+
+  // The satellite kept up, which is reported apart from the latencies.
+  auto const trail{harness.Call("getSatelliteTrail")};
+  CHECK(trail.ok());
+  if (trail.ok()) {
+    auto const &map{std::get<flutter::EncodableMap>(trail.value)};
+    CHECK(map.at(flw::test::Key("samples")).LongValue() == 1);
+    CHECK(map.at(flw::test::Key("trailingSamples")).LongValue() == 0);
+  }
+  auto const stats{harness.Call("getStats")};
+  CHECK(stats.ok());
+  if (stats.ok()) {
+    for (auto const &entry : std::get<flutter::EncodableList>(stats.value)) {
+      auto const &map{std::get<flutter::EncodableMap>(entry)};
+      CHECK(std::get<std::string>(map.at(flw::test::Key("phase"))) !=
+            "unknown");
+    }
+  }
+
+  // Deactivating the parent closes its child popups, of which none is left.
+  backend.SendWindowMessage(manager.windows().at(*parent)->GetHandle(),
+                            WM_ACTIVATE, WA_INACTIVE, 0);
+  CHECK(!manager.windows().at(*follower)->closed());
+
+  // A satellite outliving its parent's lists does not reach back to it.
+  CHECK(manager.destroyWindow(*follower, true));
+  CHECK(manager.destroyWindow(*parent, true));
+
+  return flw::test::Finish("owned_window_test");
+}
@@ -0,0 +1,86 @@
+#include "test_support.h"
+
+// A popup that may be drawn as an overlay gets one when it fits inside the
+// client area of its parent, and a window of its own otherwise.
+
+namespace {
+
+using flutter::EncodableList;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+using flw::test::IntList;
+using flw::test::Key;
+
+constexpr int kTopLeft{static_cast<int>(flw::Positioner::Anchor::top_left)};
+constexpr int kBottomLeft{
+    static_cast<int>(flw::Positioner::Anchor::bottom_left)};
+
+auto PopupArguments(int parent, int width, int height, bool allow_overlay)
+    -> EncodableValue {
+  return EncodableValue(EncodableMap{
+      {Key("parent"), EncodableValue(parent)},
+      {Key("size"), IntList({width, height})},
+      {Key("anchorRect"), IntList({10, 10, 20, 20})},
+      {Key("positionerParentAnchor"), EncodableValue(kBottomLeft)},
+      {Key("positionerChildAnchor"), EncodableValue(kTopLeft)},
+      {Key("positionerOffset"), IntList({0, 0})},
+      {Key("positionerConstraintAdjustment"), EncodableValue(0)},
+      {Key("allowOverlay"), EncodableValue(allow_overlay)}});
+}
+
+auto OverlayOf(flw::test::Response const &response)
+    -> std::optional<EncodableList> {
+  auto const *const map{std::get_if<EncodableMap>(&response.value)};
+  if (!map || !map->contains(Key("overlay"))) {
+    return std::nullopt;
+  }
+  return std::get<EncodableList>(map->at(Key("overlay")));
+}
+
+} // namespace
+
+int main() {
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+
+  auto const main_window{
+      manager.createRegularWindow(L"main", {100, 100}, {400, 300})};
+  CHECK(main_window.has_value());
+  auto const parent{static_cast<int>(*main_window)};
+  auto const windows_before{manager.windows().size()};
+  harness.TakeSentCalls();
+
+  // Below the anchor rect, well inside the parent: an overlay, and no window.
+  auto const fits{
+      harness.Call("createPopupWindow", PopupArguments(parent, 50, 40, true))};
+  CHECK(fits.ok());
+  auto const overlay{OverlayOf(fits)};
+  CHECK(overlay.has_value());
+  if (overlay) {
+    CHECK_EQ(overlay->size(), size_t{4});
+    CHECK_EQ(std::get<int>(overlay->at(0)), 10);
+    CHECK_EQ(std::get<int>(overlay->at(1)), 30);
+    CHECK_EQ(std::get<int>(overlay->at(2)), 50);
+    CHECK_EQ(std::get<int>(overlay->at(3)), 40);
+  }
+  CHECK_EQ(manager.windows().size(), windows_before);
+  CHECK(harness.TakeSentCalls().empty());
+
+  // Too large for the parent: a window.
+  auto const too_large{harness.Call("createPopupWindow",
+                                    PopupArguments(parent, 600, 40, true))};
+  CHECK(too_large.ok());
+  CHECK(!OverlayOf(too_large));
+  CHECK(std::holds_alternative<int64_t>(too_large.value) ||
+        std::holds_alternative<int32_t>(too_large.value));
+  CHECK_EQ(manager.windows().size(), windows_before + 1);
+
+  // Without allowOverlay, a popup that would fit still gets a window.
+  auto const not_allowed{harness.Call("createPopupWindow",
+                                      PopupArguments(parent, 50, 40, false))};
+  CHECK(not_allowed.ok());
+  CHECK(!OverlayOf(not_allowed));
+  CHECK_EQ(manager.windows().size(), windows_before + 2);
+
+  return flw::test::Finish("popup_overlay_test");
+}
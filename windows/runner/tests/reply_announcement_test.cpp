@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "test_support.h"
+
+// A window created with 'replyWithWindow' is announced by the reply alone:
+// no onWindowCreated or onWindowResized is sent for it, the reply carries the
+// state the events would have, and its sequence is at least that of every
+// event sent before it and below that of every event sent after it, so Dart
+// drops the earlier ones as stale. This holds for regular windows, popups,
+// new tips and tips reused from the pool, whose onWindowDestroyed from their
+// previous use is among the stale events. Without the flag, the events are
+// sent, one onWindowResized per window, and the reply is the view ID.
+
+namespace {
+
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+using flw::test::IntList;
+using flw::test::Key;
+using flw::test::SentCall;
+
+constexpr int kTopLeft{static_cast<int>(flw::Positioner::Anchor::top_left)};
+constexpr int kBottomLeft{
+    static_cast<int>(flw::Positioner::Anchor::bottom_left)};
+
+auto RegularArguments(bool reply) -> EncodableValue {
+  return EncodableValue(EncodableMap{{Key("width"), EncodableValue(300)},
+                                     {Key("height"), EncodableValue(200)},
+                                     {Key("replyWithWindow"),
+                                      EncodableValue(reply)}});
+}
+
+auto AnchoredArguments(int parent, bool reply) -> EncodableValue {
+  return EncodableValue(EncodableMap{
+      {Key("parent"), EncodableValue(parent)},
+      {Key("size"), IntList({80, 40})},
+      {Key("anchorRect"), IntList({10, 10, 20, 20})},
+      {Key("positionerParentAnchor"), EncodableValue(kBottomLeft)},
+      {Key("positionerChildAnchor"), EncodableValue(kTopLeft)},
+      {Key("positionerOffset"), IntList({0, 0})},
+      {Key("positionerConstraintAdjustment"), EncodableValue(0)},
+      {Key("replyWithWindow"), EncodableValue(reply)}});
+}
+
+auto ReplyInt(flw::test::Response const &response, char const *key)
+    -> std::optional<int64_t> {
+  auto const *const map{std::get_if<EncodableMap>(&response.value)};
+  if (!map || !map->contains(Key(key))) {
+    return std::nullopt;
+  }
+  return map->at(Key(key)).LongValue();
+}
+
+auto MaxSequence(std::vector<SentCall> const &calls) -> int64_t {
+  int64_t sequence{0};
+  for (auto const &call : calls) {
+    sequence = std::max(sequence, call.Int("sequence").value_or(0));
+  }
+  return sequence;
+}
+
+auto Find(std::vector<SentCall> const &calls, char const *method,
+          int64_t view_id) -> SentCall const * {
+  auto const it{std::ranges::find_if(calls, [method, view_id](auto const &call) {
+    return call.method == method && call.Int("viewId") == view_id;
+  })};
+  return it != calls.end() ? &*it : nullptr;
+}
+
+// Sends |method| with |arguments| and checks how the new window is announced.
+// |before| are the calls sent since the last check, which the reply must be
+// current as of. Returns the view ID of the window.
+auto CreateAndCheck(flw::test::Harness &harness, char const *method,
+                    EncodableValue const &arguments, bool reply,
+                    std::vector<SentCall> const &before) -> int64_t {
+  auto const response{harness.Call(method, arguments)};
+  CHECK(response.ok());
+  auto const calls{harness.TakeSentCalls()};
+  if (!reply) {
+    CHECK(std::holds_alternative<int32_t>(response.value) ||
+          std::holds_alternative<int64_t>(response.value));
+    auto const view_id{response.value.LongValue()};
+    auto const *const created{Find(calls, "onWindowCreated", view_id)};
+    auto const *const resized{Find(calls, "onWindowResized", view_id)};
+    CHECK(created && resized);
+    if (created && resized) {
+      CHECK(created->Int("sequence") > MaxSequence(before));
+      CHECK(created < resized);
+    }
+    CHECK_EQ(std::ranges::count_if(calls,
+                                   [view_id](auto const &call) {
+                                     return call.method == "onWindowResized" &&
+                                            call.Int("viewId") == view_id;
+                                   }),
+             1);
+    return view_id;
+  }
+
+  auto const view_id{ReplyInt(response, "viewId")};
+  auto const sequence{ReplyInt(response, "sequence")};
+  CHECK(view_id && sequence);
+  if (!view_id || !sequence) {
+    return -1;
+  }
+  CHECK(!Find(calls, "onWindowCreated", *view_id));
+  CHECK(!Find(calls, "onWindowResized", *view_id));
+  CHECK(*sequence >= MaxSequence(before));
+  CHECK(*sequence >= MaxSequence(calls));
+  CHECK(ReplyInt(response, "width").has_value());
+  CHECK(ReplyInt(response, "height").has_value());
+
+  // Later events are numbered after the reply, so Dart applies them.
+  auto &manager{harness.manager()};
+  auto const &frame{manager.windows().at(*view_id)->geometry().frame};
+  CHECK(manager.moveWindow(*view_id, {static_cast<int>(frame.left) + 5,
+                                      static_cast<int>(frame.top)},
+                           {120, 90}));
+  auto const after{harness.TakeSentCalls()};
+  auto const *const resized{Find(after, "onWindowResized", *view_id)};
+  CHECK(resized);
+  if (resized) {
+    CHECK(resized->Int("sequence") > *sequence);
+  }
+  return *view_id;
+}
+
+} // namespace
+
+int main() {
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+
+  auto const main_window{
+      manager.createRegularWindow(L"main", {100, 100}, {400, 300})};
+  CHECK(main_window.has_value());
+  auto const parent{static_cast<int>(*main_window)};
+
+  for (auto const reply : {false, true}) {
+    auto before{harness.TakeSentCalls()};
+    CreateAndCheck(harness, "createRegularWindow", RegularArguments(reply),
+                   reply, before);
+    CreateAndCheck(harness, "createPopupWindow",
+                   AnchoredArguments(parent, reply), reply, {});
+    auto const tip{CreateAndCheck(harness, "createTipWindow",
+                                  AnchoredArguments(parent, reply), reply, {})};
+
+    // The tip goes back to the pool. Its onWindowDestroyed is sent before the
+    // tip is reused under the same view ID.
+    CHECK(manager.destroyWindow(tip, true));
+    before = harness.TakeSentCalls();
+    auto const *const destroyed{Find(before, "onWindowDestroyed", tip)};
+    CHECK(destroyed);
+    auto const reused{CreateAndCheck(harness, "createTipWindow",
+                                     AnchoredArguments(parent, reply), reply,
+                                     before)};
+    // Kept open, so that the next tip is created anew.
+    CHECK_EQ(reused, tip);
+  }
+
+  // The reply carries the same state as the events.
+  harness.TakeSentCalls();
+  auto const by_events{harness.Call("createRegularWindow",
+                                    RegularArguments(false))};
+  auto const events{harness.TakeSentCalls()};
+  auto const by_reply{harness.Call("createRegularWindow",
+                                   RegularArguments(true))};
+  CHECK(by_events.ok() && by_reply.ok());
+  auto const *const resized{
+      Find(events, "onWindowResized", by_events.value.LongValue())};
+  CHECK(resized);
+  if (resized) {
+    CHECK(resized->Int("width") == ReplyInt(by_reply, "width"));
+    CHECK(resized->Int("height") == ReplyInt(by_reply, "height"));
+  }
+  CHECK_EQ(ReplyInt(by_reply, "archetype").value_or(-1),
+           static_cast<int64_t>(flw::Archetype::regular));
+
+  // 'replyWithWindow' must be a bool.
+  auto const invalid{harness.Call(
+      "createRegularWindow",
+      EncodableValue(EncodableMap{{Key("width"), EncodableValue(300)},
+                                  {Key("height"), EncodableValue(200)},
+                                  {Key("replyWithWindow"),
+                                   EncodableValue(1)}}))};
+  CHECK(invalid.error_code == "INVALID_VALUE");
+
+  return flw::test::Finish("reply_announcement_test");
+}
@@ -0,0 +1,193 @@
+#ifndef RUNNER_TESTS_TEST_SUPPORT_H_
+#define RUNNER_TESTS_TEST_SUPPORT_H_
+
+#include <flutter/method_result_functions.h>
+#include <flutter/standard_method_codec.h>
+
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "flutter_window_manager.h"
+#include "headless_flutter_engine.h"
+#include "headless_window_backend.h"
+
+// Helpers for the runner tests, which drive FlutterWindowManager on a
+// HeadlessWindowBackend and talk to it over the flw/window channel the way the
+// Dart side does. Each test is its own executable, since the manager is a
+// process-wide singleton.
+
+namespace flw::test {
+
+inline int &FailureCount() {
+  static int failures{0};
+  return failures;
+}
+
+} // namespace flw::test
+
+// Reports a failed check and carries on with the test.
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__,    \
+                   #condition);                                                \
+      ++flw::test::FailureCount();                                             \
+    }                                                                          \
+  } while (false)
+
+#define CHECK_EQ(actual, expected)                                             \
+  do {                                                                         \
+    auto const &flw_actual_{actual};                                           \
+    auto const &flw_expected_{expected};                                       \
+    if (!(flw_actual_ == flw_expected_)) {                                     \
+      std::fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %s (%lld vs %lld)\n", \
+                   __FILE__, __LINE__, #actual, #expected,                     \
+                   static_cast<long long>(flw_actual_),                        \
+                   static_cast<long long>(flw_expected_));                     \
+      ++flw::test::FailureCount();                                             \
+    }                                                                          \
+  } while (false)
+
+namespace flw::test {
+
+// The response Dart would receive for a method call.
+struct Response {
+  enum class Kind { success, error, not_implemented, none };
+  Kind kind = Kind::none;
+  flutter::EncodableValue value;
+  std::string error_code;
+
+  bool ok() const { return kind == Kind::success; }
+};
+
+// A method call the runner sent to Dart.
+struct SentCall {
+  std::string method;
+  flutter::EncodableValue arguments;
+
+  // Returns the integer argument |key| of a map argument, or std::nullopt.
+  std::optional<int64_t> Int(char const *key) const {
+    auto const *const map{std::get_if<flutter::EncodableMap>(&arguments)};
+    if (!map) {
+      return std::nullopt;
+    }
+    auto const it{map->find(flutter::EncodableValue(key))};
+    if (it == map->end() || it->second.IsNull()) {
+      return std::nullopt;
+    }
+    return it->second.LongValue();
+  }
+};
+
+inline auto Key(char const *key) -> flutter::EncodableValue {
+  return flutter::EncodableValue(key);
+}
+
+inline auto IntList(std::initializer_list<int> values)
+    -> flutter::EncodableValue {
+  flutter::EncodableList list;
+  for (auto const value : values) {
+    list.emplace_back(value);
+  }
+  return flutter::EncodableValue(std::move(list));
+}
+
+// A manager running on a headless backend with one or more engines.
+class Harness {
+public:
+  explicit Harness(size_t engine_count = 1) {
+    auto backend{std::make_unique<HeadlessWindowBackend>()};
+    backend_ = backend.get();
+    // Installed before the manager is first used, so that the manager and its
+    // windows are destroyed before the backend at exit.
+    WindowBackend::SetInstance(std::move(backend));
+    for (size_t i{0}; i < engine_count; ++i) {
+      engines_.push_back(std::make_shared<HeadlessFlutterEngine>(*backend_));
+      if (i == 0) {
+        manager().setEngine(engines_.back());
+      } else {
+        manager().addEngine(engines_.back());
+      }
+    }
+  }
+
+  auto backend() -> HeadlessWindowBackend & { return *backend_; }
+  auto engine(EngineId engine = 0) -> HeadlessFlutterEngine & {
+    return *engines_[engine];
+  }
+  static auto manager() -> FlutterWindowManager & {
+    return FlutterWindowManager::instance();
+  }
+
+  // Sends |method| to the manager on the channel of |engine|, encoded as Dart
+  // would, and returns the response.
+  auto Call(std::string const &method,
+            flutter::EncodableValue arguments = flutter::EncodableValue(),
+            EngineId engine = 0) -> Response {
+    auto const &codec{flutter::StandardMethodCodec::GetInstance()};
+    auto const message{codec.EncodeMethodCall(flutter::MethodCall<>(
+        method, std::make_unique<flutter::EncodableValue>(arguments)))};
+    Response response;
+    flutter::MethodResultFunctions<> result(
+        [&response](flutter::EncodableValue const *value) {
+          response.kind = Response::Kind::success;
+          response.value = value ? *value : flutter::EncodableValue();
+        },
+        [&response](std::string const &code, std::string const &,
+                    flutter::EncodableValue const *) {
+          response.kind = Response::Kind::error;
+          response.error_code = code;
+        },
+        [&response] { response.kind = Response::Kind::not_implemented; });
+    auto const delivered{engines_[engine]->headless_messenger().Deliver(
+        "flw/window", *message,
+        [&codec, &result](uint8_t const *reply, size_t reply_size) {
+          codec.DecodeAndProcessResponseEnvelope(reply, reply_size, &result);
+        })};
+    CHECK(delivered);
+    return response;
+  }
+
+  // Returns the method calls sent to Dart on the flw/window channel of
+  // |engine| since the last call, and forgets them.
+  auto TakeSentCalls(EngineId engine = 0) -> std::vector<SentCall> {
+    auto &messenger{engines_[engine]->headless_messenger()};
+    std::vector<SentCall> calls;
+    for (auto const &message : messenger.sent_messages()) {
+      if (message.channel != "flw/window") {
+        continue;
+      }
+      auto const call{
+          flutter::StandardMethodCodec::GetInstance().DecodeMethodCall(
+              message.data)};
+      CHECK(call != nullptr);
+      if (call) {
+        calls.push_back({.method = call->method_name(),
+                         .arguments = call->arguments()
+                                          ? *call->arguments()
+                                          : flutter::EncodableValue()});
+      }
+    }
+    messenger.ClearSentMessages();
+    return calls;
+  }
+
+private:
+  HeadlessWindowBackend *backend_;
+  std::vector<std::shared_ptr<HeadlessFlutterEngine>> engines_;
+};
+
+// Returns the exit code of a test.
+inline int Finish(char const *name) {
+  auto const failures{FailureCount()};
+  std::printf("%s: %s (%d failed checks)\n", name,
+              failures == 0 ? "PASSED" : "FAILED", failures);
+  return failures == 0 ? 0 : 1;
+}
+
+} // namespace flw::test
+
+#endif // RUNNER_TESTS_TEST_SUPPORT_H_
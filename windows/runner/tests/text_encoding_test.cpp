@@ -0,0 +1,118 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "test_support.h"
+#include "text_encoding.h"
+
+// Checks the transcoder against strings that put ASCII runs and multi-byte
+// sequences at every offset across the vector width, and against malformed
+// input. Reports the ASCII throughput.
+
+namespace {
+
+using flw::text::Utf16FromUtf8;
+using flw::text::Utf8FromUtf16;
+
+// Encodes |code_point| as UTF-8 and UTF-16, one scalar value at a time.
+void Append(char32_t code_point, std::string &utf8, std::u16string &utf16) {
+  if (code_point < 0x80) {
+    utf8 += static_cast<char>(code_point);
+  } else if (code_point < 0x800) {
+    utf8 += static_cast<char>(0xC0 | (code_point >> 6));
+    utf8 += static_cast<char>(0x80 | (code_point & 0x3F));
+  } else if (code_point < 0x10000) {
+    utf8 += static_cast<char>(0xE0 | (code_point >> 12));
+    utf8 += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    utf8 += static_cast<char>(0x80 | (code_point & 0x3F));
+  } else {
+    utf8 += static_cast<char>(0xF0 | (code_point >> 18));
+    utf8 += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+    utf8 += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    utf8 += static_cast<char>(0x80 | (code_point & 0x3F));
+  }
+  if (code_point < 0x10000) {
+    utf16 += static_cast<char16_t>(code_point);
+  } else {
+    utf16 += static_cast<char16_t>(0xD800 + ((code_point - 0x10000) >> 10));
+    utf16 += static_cast<char16_t>(0xDC00 + ((code_point - 0x10000) & 0x3FF));
+  }
+}
+
+void CheckRoundTrip(std::string const &utf8, std::u16string const &utf16) {
+  auto const narrowed{Utf8FromUtf16(utf16)};
+  auto const widened{Utf16FromUtf8(utf8)};
+  CHECK(narrowed && *narrowed == utf8);
+  CHECK(widened && *widened == utf16);
+}
+
+} // namespace
+
+int main() {
+  // ASCII runs of every length up to a few vector widths, with a multi-byte
+  // sequence of each length after them.
+  for (char32_t const tail : {U'\0', U'\u00e9', U'\u20ac', U'\U0001f600'}) {
+    for (int length{0}; length <= 100; ++length) {
+      std::string utf8;
+      std::u16string utf16;
+      for (int i{0}; i < length; ++i) {
+        Append(U'a' + static_cast<char32_t>(i % 26), utf8, utf16);
+      }
+      if (tail != U'\0') {
+        Append(tail, utf8, utf16);
+        Append(U'z', utf8, utf16);
+      }
+      CheckRoundTrip(utf8, utf16);
+    }
+  }
+
+  // Non-ASCII throughout, including the boundaries of each sequence length.
+  {
+    std::string utf8;
+    std::u16string utf16;
+    for (char32_t const code_point :
+         {U'\u007f', U'\u0080', U'\u07ff', U'\u0800', U'\ud7ff', U'\ue000',
+          U'\uffff', U'\U00010000', U'\U0010ffff'}) {
+      Append(code_point, utf8, utf16);
+    }
+    CheckRoundTrip(utf8, utf16);
+  }
+
+  // Wide strings are UTF-16 on Windows and UTF-32 elsewhere.
+  auto const wide{flw::text::WideFromUtf8("h\xc3\xa9llo \xf0\x9f\x98\x80")};
+  CHECK(wide.has_value());
+  if (wide) {
+    auto const utf8{flw::text::Utf8FromWide(*wide)};
+    CHECK(utf8 && *utf8 == "h\xc3\xa9llo \xf0\x9f\x98\x80");
+  }
+
+  // Unpaired surrogates.
+  for (std::u16string const invalid :
+       {u"\xd800", u"a\xd800", u"\xd800z", u"\xdc00", u"\xdc00\xd800"}) {
+    CHECK(!Utf8FromUtf16(invalid));
+  }
+  // Overlong, surrogate, out of range, truncated and stray sequences.
+  for (std::string const invalid :
+       {"\xc0\x80", "\xc1\xbf", "\xe0\x80\x80", "\xed\xa0\x80",
+        "\xf0\x80\x80\x80", "\xf4\x90\x80\x80", "\xf8\x88\x80\x80\x80",
+        "\xc3", "abc\xe2\x82", "\x80", "abcdefghijklmnopqrstuvwxyz\xbf"}) {
+    CHECK(!Utf16FromUtf8(invalid));
+  }
+
+  // ASCII throughput, the common case for titles and channel arguments.
+  std::string const ascii(1 << 16, 'x');
+  constexpr int kIterations{2000};
+  size_t total{0};
+  auto const start{std::chrono::steady_clock::now()};
+  for (int i{0}; i < kIterations; ++i) {
+    total += Utf16FromUtf8(ascii)->size();
+    total += Utf8FromUtf16(std::u16string(ascii.size(), u'x'))->size();
+  }
+  auto const elapsed{std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start)};
+  CHECK_EQ(total, size_t{2} * kIterations * ascii.size());
+  std::printf("ASCII transcoding: %.2f GB/s\n",
+              static_cast<double>(total) / elapsed.count() / 1e9);
+
+  return flw::test::Finish("text_encoding_test");
+}
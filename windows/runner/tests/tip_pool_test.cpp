@@ -0,0 +1,88 @@
+#include "test_support.h"
+
+#include <algorithm>
+
+// A tip reused from the pool is announced like a new one: Dart learns its size
+// again, and the memory budget is enforced with it counted.
+
+namespace {
+
+auto TotalBytes() -> uint64_t {
+  uint64_t total{0};
+  for (auto const &[id, window] : FlutterWindowManager::instance().windows()) {
+    if (window->flutter_view()) {
+      total += window->memory().total_bytes();
+    }
+  }
+  return total;
+}
+
+} // namespace
+
+int main() {
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+  auto &backend{harness.backend()};
+
+  auto const main_window{
+      manager.createRegularWindow(L"main", {0, 0}, {400, 300})};
+  auto const popup{
+      manager.createPopupWindow(L"popup", {10, 10}, {60, 60}, *main_window)};
+  CHECK(main_window && popup);
+
+  // The popup is covered along with its owner, so the budget may reclaim it.
+  backend.SetOcclusion(manager.windows().at(*main_window)->GetHandle(),
+                       {.cloaked = false, .occluded = true});
+  backend.FireTimers();
+  CHECK(manager.windows().at(*popup)->visibility_tracker().visibility() !=
+        flw::Visibility::visible);
+
+  auto const tip{
+      manager.createTipWindow(L"tip", {20, 20}, {50, 20}, *main_window)};
+  CHECK(tip.has_value());
+  CHECK(manager.destroyWindow(*tip, true));
+  CHECK(!manager.windows().contains(*tip));
+
+  // Everything but the pooled tip fits.
+  manager.setMemoryBudget(TotalBytes());
+  CHECK(manager.windows().contains(*popup));
+  harness.TakeSentCalls();
+
+  auto const reused{
+      manager.createTipWindow(L"tip", {30, 30}, {80, 30}, *main_window)};
+  CHECK(reused.has_value());
+  CHECK_EQ(*reused, *tip);
+
+  auto const calls{harness.TakeSentCalls()};
+  auto const find{[&calls](char const *method, flutter::FlutterViewId id) {
+    return std::ranges::find_if(calls, [method, id](auto const &call) {
+      return call.method == method && call.Int("viewId") == id;
+    });
+  }};
+  auto const created{find("onWindowCreated", *tip)};
+  auto const resized{find("onWindowResized", *tip)};
+  CHECK(created != calls.end());
+  CHECK(resized != calls.end());
+  if (created != calls.end() && resized != calls.end()) {
+    CHECK(created < resized);
+    CHECK_EQ(resized->Int("width").value_or(0), 80);
+    CHECK_EQ(resized->Int("height").value_or(0), 30);
+  }
+
+  // The shown tip pushes the windows over the budget, evicting the popup.
+  CHECK(find("onWindowDestroyed", *popup) != calls.end());
+  CHECK(!manager.windows().contains(*popup) ||
+        manager.windows().at(*popup)->closed());
+
+  // Dart learns the size of a tip reused at the size it was hidden with too.
+  CHECK(manager.destroyWindow(*reused, true));
+  harness.TakeSentCalls();
+  CHECK(manager.createTipWindow(L"tip", {40, 40}, {80, 30}, *main_window));
+  auto const same_size_calls{harness.TakeSentCalls()};
+  CHECK(std::ranges::any_of(same_size_calls, [&tip](auto const &call) {
+    return call.method == "onWindowResized" && call.Int("viewId") == *tip &&
+           call.Int("width") == 80;
+  }));
+
+  return flw::test::Finish("tip_pool_test");
+}
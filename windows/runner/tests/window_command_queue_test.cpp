@@ -0,0 +1,155 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "test_support.h"
+#include "window_command_queue.h"
+
+// Commands posted from other threads run on the platform thread in the order
+// they were posted, a batch per wake-up, and posting blocks once kCapacity
+// commands are pending. A wake-up that cannot be posted is posted again by the
+// next command, and the message loop runs the commands left waiting.
+
+namespace {
+
+constexpr int kProducers{4};
+constexpr int kMovesPerProducer{200};
+
+// Runs posted tasks on the calling thread until |done| holds.
+// Posts a move of |view_id| from another thread.
+auto MoveFromOtherThread(flutter::FlutterViewId view_id, int x)
+    -> std::future<bool> {
+  std::future<bool> future;
+  std::thread([&future, view_id, x] {
+    future = WindowCommandQueue::instance().MoveWindow(view_id, {x, 0},
+                                                       {400, 300});
+  }).join();
+  return future;
+}
+
+auto Ready(std::future<bool> const &future) -> bool {
+  return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+template <typename Done>
+auto RunUntil(HeadlessWindowBackend &backend, Done &&done) -> size_t {
+  size_t tasks{0};
+  while (!done()) {
+    tasks += backend.RunPostedTasks();
+    std::this_thread::yield();
+  }
+  return tasks + backend.RunPostedTasks();
+}
+
+} // namespace
+
+int main() {
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+  auto &backend{harness.backend()};
+  auto &queue{WindowCommandQueue::instance()};
+  queue.AttachToCurrentThread();
+
+  // On the platform thread, commands run at once.
+  auto main_future{queue.CreateRegularWindow(L"main", {0, 0}, {400, 300})};
+  CHECK(main_future.wait_for(std::chrono::seconds(0)) ==
+        std::future_status::ready);
+  auto const main_window{main_future.get()};
+  CHECK(main_window.has_value());
+
+  // A producer posting more than kCapacity commands blocks until they run.
+  constexpr int kBurst{static_cast<int>(WindowCommandQueue::kCapacity) + 16};
+  std::atomic<int> posted{0};
+  std::vector<std::future<bool>> burst;
+  std::thread producer([&] {
+    for (int i{0}; i < kBurst; ++i) {
+      burst.push_back(queue.MoveWindow(*main_window, {i, 0}, {400, 300}));
+      posted.fetch_add(1);
+    }
+  });
+  auto const deadline{std::chrono::steady_clock::now() +
+                      std::chrono::seconds(5)};
+  while (posted.load() < static_cast<int>(WindowCommandQueue::kCapacity) &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  CHECK_EQ(posted.load(), static_cast<int>(WindowCommandQueue::kCapacity));
+  auto const burst_tasks{
+      RunUntil(backend, [&posted] { return posted.load() == kBurst; })};
+  producer.join();
+  for (auto &future : burst) {
+    CHECK(future.get());
+  }
+  // The commands ran in order, so the window ends where the last move put it.
+  CHECK_EQ(manager.windows().at(*main_window)->geometry().frame.left,
+           kBurst - 1);
+  // Far fewer wake-ups than commands.
+  CHECK(burst_tasks < static_cast<size_t>(kBurst) / 2);
+
+  // Several producers, each moving its own window in order.
+  std::vector<flutter::FlutterViewId> windows;
+  for (int i{0}; i < kProducers; ++i) {
+    auto const window{queue.CreatePopupWindow(L"popup", {0, 0}, {50, 50},
+                                              *main_window)
+                          .get()};
+    CHECK(window.has_value());
+    windows.push_back(window.value_or(*main_window));
+  }
+  std::atomic<int> finished{0};
+  std::vector<std::thread> producers;
+  std::vector<std::vector<std::future<bool>>> moves(kProducers);
+  for (int p{0}; p < kProducers; ++p) {
+    producers.emplace_back([&, p] {
+      for (int i{0}; i < kMovesPerProducer; ++i) {
+        moves[p].push_back(queue.MoveWindow(windows[p], {i, p}, {50, 50}));
+      }
+      finished.fetch_add(1);
+    });
+  }
+  RunUntil(backend, [&finished] { return finished.load() == kProducers; });
+  for (auto &thread : producers) {
+    thread.join();
+  }
+  backend.RunPostedTasks();
+  for (int p{0}; p < kProducers; ++p) {
+    for (auto &future : moves[p]) {
+      CHECK(future.get());
+    }
+    auto const &frame{manager.windows().at(windows[p])->geometry().frame};
+    CHECK_EQ(frame.left, kMovesPerProducer - 1);
+    CHECK_EQ(frame.top, p);
+  }
+
+  // The wake-up for the first move is lost. The second move posts one, which
+  // runs both.
+  backend.SetPostTaskFails(true);
+  auto lost{MoveFromOtherThread(*main_window, 1)};
+  backend.SetPostTaskFails(false);
+  CHECK_EQ(backend.RunPostedTasks(), 0u);
+  CHECK(!Ready(lost));
+  auto next{MoveFromOtherThread(*main_window, 2)};
+  CHECK_EQ(backend.RunPostedTasks(), 1u);
+  CHECK(Ready(lost) && Ready(next));
+  CHECK(lost.get() && next.get());
+  CHECK_EQ(manager.windows().at(*main_window)->geometry().frame.left, 2);
+
+  // Without a next command, the message loop's next turn runs it.
+  backend.SetPostTaskFails(true);
+  auto stalled{MoveFromOtherThread(*main_window, 3)};
+  backend.SetPostTaskFails(false);
+  CHECK(!Ready(stalled));
+  queue.RunStalled();
+  CHECK(Ready(stalled) && stalled.get());
+  CHECK_EQ(manager.windows().at(*main_window)->geometry().frame.left, 3);
+  queue.RunStalled();
+  CHECK_EQ(backend.RunPostedTasks(), 0u);
+
+  // A command for a window that does not exist reports it.
+  CHECK(!queue.MoveWindow(*main_window + 1000, {0, 0}, {50, 50}).get());
+  CHECK(!queue.DestroyWindow(*main_window + 1000).get());
+
+  return flw::test::Finish("window_command_queue_test");
+}
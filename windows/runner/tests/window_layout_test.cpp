@@ -0,0 +1,327 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "test_support.h"
+#include "window_layout.h"
+
+// Regular windows and satellites saved to the layout file come back from
+// TakeSaved and restoreLayout with their frames, titles, engines and parents,
+// popups and tips are not saved, a file of another version or slot size is
+// cleared, windows past kCapacity are not saved, and titles are cut at a code
+// point boundary. Reports how long restoreLayout takes for 10 to 200 windows.
+
+namespace {
+
+// Byte offsets into the layout file's header.
+constexpr std::streamoff kVersionOffset{4};
+constexpr std::streamoff kSlotSizeOffset{12};
+
+auto LayoutPath() -> std::filesystem::path {
+  return std::filesystem::temp_directory_path() / "window_layout_test.flwl";
+}
+
+auto SameRect(RECT const &a, RECT const &b) -> bool {
+  return a.left == b.left && a.top == b.top && a.right == b.right &&
+         a.bottom == b.bottom;
+}
+
+auto ReadHeaderField(std::streamoff offset) -> uint32_t {
+  std::ifstream file(LayoutPath(), std::ios::binary);
+  file.seekg(offset);
+  uint32_t value{0};
+  file.read(reinterpret_cast<char *>(&value), sizeof(value));
+  return value;
+}
+
+void WriteHeaderField(std::streamoff offset, uint32_t value) {
+  std::fstream file(LayoutPath(),
+                    std::ios::in | std::ios::out | std::ios::binary);
+  file.seekp(offset);
+  file.write(reinterpret_cast<char const *>(&value), sizeof(value));
+}
+
+// Starts saving to an empty layout file.
+void OpenEmpty() {
+  std::filesystem::remove(LayoutPath());
+  CHECK(flw::WindowLayout::instance().Open(LayoutPath()));
+}
+
+// Starts a new run as far as the layout file is concerned: maps the file
+// again, so that the open windows are no longer tracked, and closes them. The
+// main window stops quitting on close first, which would freeze the layout.
+void Relaunch() {
+  auto &manager{FlutterWindowManager::instance()};
+  CHECK(flw::WindowLayout::instance().Open(LayoutPath()));
+  std::vector<flutter::FlutterViewId> ids;
+  for (auto const &[id, window] : manager.windows()) {
+    window->SetQuitOnClose(false);
+    ids.push_back(id);
+  }
+  for (auto const id : ids) {
+    if (manager.windows().contains(id) && !manager.windows().at(id)->closed()) {
+      manager.destroyWindow(id, true);
+    }
+  }
+  CHECK(std::ranges::all_of(manager.windows(), [](auto const &window) {
+    return window.second->closed();
+  }));
+}
+
+// Unmaps the layout file, so that it can be changed behind the layout's back.
+void CloseLayout() {
+  auto const other{std::filesystem::temp_directory_path() /
+                   "window_layout_test_other.flwl"};
+  CHECK(flw::WindowLayout::instance().Open(other));
+  std::filesystem::remove(other);
+}
+
+auto FindWindow(RECT const &frame) -> FlutterWindow const * {
+  for (auto const &[id, window] : FlutterWindowManager::instance().windows()) {
+    if (SameRect(window->geometry().frame, frame)) {
+      return window.get();
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+int main() {
+  flw::test::Harness harness(2);
+  auto &manager{harness.manager()};
+  auto &layout{flw::WindowLayout::instance()};
+
+  // Regular windows on both engines, satellites of each, and a popup and a
+  // tip, which are not saved.
+  {
+    OpenEmpty();
+    auto const main_window{
+        manager.createRegularWindow(L"main", {10, 20}, {400, 300})};
+    auto const second{
+        manager.createRegularWindow(L"second", {600, 20}, {300, 200}, 1)};
+    CHECK(main_window && second);
+    auto const satellite{manager.createSatelliteWindow(
+        L"satellite", {420, 20}, {100, 100}, *main_window)};
+    auto const second_satellite{manager.createSatelliteWindow(
+        L"second satellite", {910, 20}, {80, 80}, *second)};
+    CHECK(satellite && second_satellite);
+    CHECK(manager.createPopupWindow(L"popup", {30, 40}, {50, 50}, *main_window)
+              .has_value());
+    CHECK(manager.createTipWindow(L"tip", {30, 100}, {50, 20}, *main_window)
+              .has_value());
+    // The satellite follows and is saved where it ends up.
+    CHECK(manager.moveWindow(*main_window, {50, 60}, {420, 320}));
+
+    struct Expected {
+      RECT frame;
+      flw::Archetype archetype;
+      EngineId engine;
+      std::optional<RECT> parent;
+      bool quit_on_close;
+    };
+    auto const frame{[&manager](flutter::FlutterViewId id) {
+      return manager.windows().at(id)->geometry().frame;
+    }};
+    std::vector<Expected> const expected{
+        {frame(*main_window), flw::Archetype::regular, 0, std::nullopt, true},
+        {frame(*second), flw::Archetype::regular, 1, std::nullopt, false},
+        {frame(*satellite), flw::Archetype::satellite, 0,
+         frame(*main_window), false},
+        {frame(*second_satellite), flw::Archetype::satellite, 1,
+         frame(*second), false},
+    };
+
+    Relaunch();
+    CHECK(manager.restoreLayout());
+    CHECK_EQ(manager.windows().size(), expected.size());
+    for (auto const &window : expected) {
+      auto const *const restored{FindWindow(window.frame)};
+      CHECK(restored);
+      if (!restored) {
+        continue;
+      }
+      CHECK(restored->archetype() == window.archetype);
+      CHECK_EQ(restored->engine_id(), window.engine);
+      CHECK_EQ(restored->GetQuitOnClose(), window.quit_on_close);
+      CHECK_EQ(restored->parent() != nullptr, window.parent.has_value());
+      if (restored->parent() && window.parent) {
+        CHECK(SameRect(restored->parent()->geometry().frame, *window.parent));
+      }
+    }
+
+    // The restored windows are saved in turn.
+    Relaunch();
+    auto const saved{layout.TakeSaved()};
+    CHECK_EQ(saved.size(), expected.size());
+    for (auto const &window : saved) {
+      std::string const title{window.title};
+      if (title == "main" || title == "second") {
+        CHECK_EQ(window.archetype,
+                 static_cast<uint32_t>(flw::Archetype::regular));
+        CHECK_EQ(window.parent, -1);
+        CHECK_EQ(window.engine, title == "main" ? 0u : 1u);
+        CHECK_EQ((window.flags & flw::SavedWindow::kQuitOnClose) != 0,
+                 title == "main");
+        CHECK_EQ(window.dpi, 96u);
+      } else {
+        CHECK(title == "satellite" || title == "second satellite");
+        CHECK_EQ(window.archetype,
+                 static_cast<uint32_t>(flw::Archetype::satellite));
+        CHECK(window.parent >= 0 &&
+              window.parent < static_cast<int32_t>(saved.size()));
+        if (window.parent >= 0 &&
+            window.parent < static_cast<int32_t>(saved.size())) {
+          CHECK(std::string(saved[window.parent].title) ==
+                (title == "satellite" ? "main" : "second"));
+        }
+      }
+    }
+    // Taken windows are gone from the file.
+    CHECK(layout.TakeSaved().empty());
+    CHECK(!manager.restoreLayout());
+  }
+
+  // A regular window saved on an engine that has not been added comes back on
+  // engine 0.
+  {
+    OpenEmpty();
+    CHECK(manager.createRegularWindow(L"main", {10, 20}, {400, 300})
+              .has_value());
+    CHECK(manager.createRegularWindow(L"second", {600, 20}, {300, 200}, 1)
+              .has_value());
+    Relaunch();
+    CloseLayout();
+    {
+      std::fstream file(LayoutPath(),
+                        std::ios::in | std::ios::out | std::ios::binary);
+      // The engine field of the second slot.
+      file.seekp(16 + sizeof(flw::SavedWindow) +
+                 offsetof(flw::SavedWindow, engine));
+      uint32_t const engine{7};
+      file.write(reinterpret_cast<char const *>(&engine), sizeof(engine));
+    }
+    CHECK(layout.Open(LayoutPath()));
+    CHECK(manager.restoreLayout());
+    CHECK_EQ(manager.windows().size(), 2u);
+    for (auto const &[id, window] : manager.windows()) {
+      CHECK_EQ(window->engine_id(), 0u);
+    }
+    Relaunch();
+  }
+
+  // A file written by another version, or with slots of another size, is
+  // cleared and rewritten with the current header.
+  for (auto const offset : {kVersionOffset, kSlotSizeOffset}) {
+    OpenEmpty();
+    CHECK(manager.createRegularWindow(L"main", {10, 20}, {400, 300})
+              .has_value());
+    Relaunch();
+    CloseLayout();
+    auto const current{ReadHeaderField(offset)};
+    WriteHeaderField(offset, current + 1);
+    CHECK(layout.Open(LayoutPath()));
+    CHECK(layout.TakeSaved().empty());
+    CHECK_EQ(ReadHeaderField(offset), current);
+  }
+  CHECK_EQ(ReadHeaderField(kSlotSizeOffset), sizeof(flw::SavedWindow));
+
+  // Windows past kCapacity open but are not saved, and a slot freed by a
+  // closed window is reused.
+  {
+    OpenEmpty();
+    std::vector<flutter::FlutterViewId> ids;
+    for (uint32_t i{0}; i < flw::WindowLayout::kCapacity + 44; ++i) {
+      auto const id{manager.createRegularWindow(
+          L"window", {static_cast<int>(i % 100), 20}, {200, 150})};
+      CHECK(id.has_value());
+      if (id) {
+        ids.push_back(*id);
+      }
+    }
+    Relaunch();
+    CHECK_EQ(layout.TakeSaved().size(), flw::WindowLayout::kCapacity);
+
+    OpenEmpty();
+    ids.clear();
+    for (uint32_t i{0}; i < flw::WindowLayout::kCapacity; ++i) {
+      if (auto const id{manager.createRegularWindow(
+              L"window", {static_cast<int>(i % 100), 20}, {200, 150})}) {
+        ids.push_back(*id);
+      }
+    }
+    CHECK(manager.destroyWindow(ids.back(), true));
+    CHECK(manager.createRegularWindow(L"reused", {10, 20}, {200, 150})
+              .has_value());
+    Relaunch();
+    auto const saved{layout.TakeSaved()};
+    CHECK_EQ(saved.size(), flw::WindowLayout::kCapacity);
+    CHECK(std::string(saved.back().title) == "reused");
+  }
+
+  // Titles are stored in 63 bytes of UTF-8, cut before a code point that does
+  // not fit whole.
+  {
+    OpenEmpty();
+    std::wstring const x59(59, L'x');
+    std::wstring const titles[]{
+        std::wstring(70, L'x'),
+        std::wstring(62, L'x') + L"é",
+        std::wstring(61, L'x') + L"\U0001F600",
+        x59 + L"\U0001F600",
+        L"été",
+    };
+    std::string const expected[]{
+        std::string(63, 'x'),
+        std::string(62, 'x'),
+        std::string(61, 'x'),
+        std::string(59, 'x') + "\xF0\x9F\x98\x80",
+        "\xC3\xA9t\xC3\xA9",
+    };
+    for (auto const &title : titles) {
+      CHECK(manager.createRegularWindow(title, {10, 20}, {200, 150})
+                .has_value());
+    }
+    Relaunch();
+    auto const saved{layout.TakeSaved()};
+    CHECK_EQ(saved.size(), std::size(expected));
+    for (size_t i{0}; i < std::min(saved.size(), std::size(expected)); ++i) {
+      CHECK(std::string(saved[i].title) == expected[i]);
+    }
+  }
+
+  // Restores of half regular windows, half satellites of them.
+  std::printf("windows, restoreLayout us, us per window\n");
+  for (auto const count : {10, 50, 100, 200}) {
+    OpenEmpty();
+    for (int i{0}; i < count / 2; ++i) {
+      auto const parent{manager.createRegularWindow(
+          L"window", {(i % 20) * 40, (i / 20) * 40}, {200, 150})};
+      CHECK(parent.has_value());
+      if (parent) {
+        CHECK(manager
+                  .createSatelliteWindow(L"satellite",
+                                         {(i % 20) * 40 + 200, (i / 20) * 40},
+                                         {60, 60}, *parent)
+                  .has_value());
+      }
+    }
+    Relaunch();
+    auto const begin{std::chrono::steady_clock::now()};
+    CHECK(manager.restoreLayout());
+    auto const elapsed{std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - begin)};
+    CHECK_EQ(manager.windows().size(), static_cast<size_t>(count));
+    std::printf("%d, %.0f, %.1f\n", count, elapsed.count(),
+                elapsed.count() / count);
+    Relaunch();
+  }
+
+  CloseLayout();
+  std::filesystem::remove(LayoutPath());
+  return flw::test::Finish("window_layout_test");
+}
@@ -0,0 +1,57 @@
+#include "test_support.h"
+
+// New regular windows are placed in the work area of their monitor, including
+// a monitor left of the primary one, where origins are negative.
+
+namespace {
+
+constexpr RECT kMonitor{-1920, 0, 0, 1080};
+constexpr RECT kWorkArea{-1920, 0, 0, 1040};
+
+auto Overlap(RECT const &a, RECT const &b) -> bool {
+  return a.left < b.right && b.left < a.right && a.top < b.bottom &&
+         b.top < a.bottom;
+}
+
+} // namespace
+
+int main() {
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+  harness.backend().SetMonitorRect(kMonitor, kWorkArea);
+
+  auto const main_window{
+      manager.createRegularWindow(L"main", {-1900, 20}, {400, 300})};
+  CHECK(main_window.has_value());
+  auto const &geometry{manager.windows().at(*main_window)->geometry()};
+  // Popups are positioned against the whole monitor; windows placed in its
+  // work area.
+  CHECK_EQ(geometry.monitor.bottom, kMonitor.bottom);
+  CHECK_EQ(geometry.work_area.bottom, kWorkArea.bottom);
+
+  std::vector<RECT> frames{geometry.frame};
+  for (int i{0}; i < 6; ++i) {
+    auto const response{harness.Call(
+        "createRegularWindow",
+        flutter::EncodableValue(flutter::EncodableMap{
+            {flw::test::Key("width"), flutter::EncodableValue(400)},
+            {flw::test::Key("height"), flutter::EncodableValue(300)},
+            {flw::test::Key("placement"),
+             flutter::EncodableValue(
+                 static_cast<int>(flw::Placement::tile))}}))};
+    CHECK(response.ok());
+    if (!response.ok()) {
+      continue;
+    }
+    auto const &frame{
+        manager.windows().at(response.value.LongValue())->geometry().frame};
+    CHECK(frame.left >= kWorkArea.left && frame.right <= kWorkArea.right);
+    CHECK(frame.top >= kWorkArea.top && frame.bottom <= kWorkArea.bottom);
+    for (auto const &other : frames) {
+      CHECK(!Overlap(frame, other));
+    }
+    frames.push_back(frame);
+  }
+
+  return flw::test::Finish("window_placement_test");
+}
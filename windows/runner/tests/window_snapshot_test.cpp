@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "test_support.h"
+
+// A snapshot reflects every event numbered up to its sequence and none after:
+// the windows Dart builds from the events up to the sequence are the windows
+// of the snapshot, and the snapshot updated with the later events is the
+// current state. Windows are created, moved, hidden and destroyed in a random
+// interleaving, with snapshots taken between operations and, as Dart may
+// while events are still queued, from within the sending of an event.
+
+namespace {
+
+using flw::test::SentCall;
+
+// A window as Dart knows it from events or a snapshot. Events carry no
+// position, so the frame is compared by size.
+struct KnownWindow {
+  int archetype = 0;
+  int64_t parent = -1;
+  int64_t width = 0;
+  int64_t height = 0;
+  std::optional<int64_t> visibility;
+};
+
+using Windows = std::map<int64_t, KnownWindow>;
+
+struct TakenSnapshot {
+  uint64_t sequence = 0;
+  Windows windows;
+  // Whether taken while an event numbered below |sequence| was being sent.
+  bool while_queued = false;
+};
+
+auto ToWindows(FlutterWindowManager::Snapshot const &snapshot) -> Windows {
+  Windows windows;
+  for (auto const &window : snapshot.windows) {
+    windows[window.view_id] = {
+        .archetype = static_cast<int>(window.archetype),
+        .parent = window.parent_view_id.value_or(-1),
+        .width = window.frame.right - window.frame.left,
+        .height = window.frame.bottom - window.frame.top,
+        .visibility = static_cast<int64_t>(window.visibility)};
+  }
+  return windows;
+}
+
+// Applies |call| to |windows| as Dart does.
+void Apply(SentCall const &call, Windows &windows) {
+  auto const view_id{call.Int("viewId").value_or(-1)};
+  if (call.method == "onWindowCreated") {
+    windows[view_id] = {
+        .archetype = static_cast<int>(call.Int("archetype").value_or(-1)),
+        .parent = call.Int("parentViewId").value_or(-1),
+        .width = 0,
+        .height = 0,
+        .visibility = std::nullopt};
+  } else if (call.method == "onWindowDestroyed") {
+    windows.erase(view_id);
+  } else if (auto const it{windows.find(view_id)}; it != windows.end()) {
+    if (call.method == "onWindowResized") {
+      it->second.width = call.Int("width").value_or(-1);
+      it->second.height = call.Int("height").value_or(-1);
+    } else if (call.method == "onWindowVisibilityChanged") {
+      it->second.visibility = call.Int("visibility");
+    }
+  }
+}
+
+// Checks that |actual|, built from events, matches |expected|. Visibility is
+// compared once an event has reported it.
+auto Matches(Windows const &actual, Windows const &expected) -> bool {
+  if (actual.size() != expected.size()) {
+    return false;
+  }
+  return std::ranges::all_of(actual, [&expected](auto const &entry) {
+    auto const &[view_id, window]{entry};
+    auto const it{expected.find(view_id)};
+    return it != expected.end() &&
+           window.archetype == it->second.archetype &&
+           window.parent == it->second.parent &&
+           window.width == it->second.width &&
+           window.height == it->second.height &&
+           (!window.visibility || window.visibility == it->second.visibility);
+  });
+}
+
+} // namespace
+
+int main() {
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+  auto &backend{harness.backend()};
+
+  std::vector<TakenSnapshot> snapshots;
+  auto const take_snapshot{[&manager, &snapshots](uint64_t sending = 0) {
+    auto const snapshot{manager.snapshot(0)};
+    snapshots.push_back({.sequence = snapshot.sequence,
+                         .windows = ToWindows(snapshot),
+                         .while_queued = sending > 0 &&
+                                         sending < snapshot.sequence});
+  }};
+  int sent{0};
+  harness.engine().headless_messenger().SetSendObserver(
+      [&sent, &take_snapshot](auto const &message) {
+        if (message.channel != "flw/window" || ++sent % 3 != 0) {
+          return;
+        }
+        auto const call{
+            flutter::StandardMethodCodec::GetInstance().DecodeMethodCall(
+                message.data)};
+        take_snapshot(SentCall{.method = call->method_name(),
+                               .arguments = *call->arguments()}
+                          .Int("sequence")
+                          .value_or(0));
+      });
+
+  auto const main_window{
+      manager.createRegularWindow(L"main", {0, 0}, {640, 480})};
+  CHECK(main_window.has_value());
+
+  std::mt19937 random{49};
+  auto const pick{[&random](int count) {
+    return std::uniform_int_distribution<int>{0, count - 1}(random);
+  }};
+  auto const open_windows{[&manager] {
+    std::vector<flutter::FlutterViewId> ids;
+    for (auto const &[id, window] : manager.windows()) {
+      if (!window->closed() && window->flutter_view()) {
+        ids.push_back(id);
+      }
+    }
+    std::ranges::sort(ids);
+    return ids;
+  }};
+
+  for (int step{0}; step < 400; ++step) {
+    auto const ids{open_windows()};
+    auto const any{ids[pick(static_cast<int>(ids.size()))]};
+    Win32Window::Point const origin{pick(800), pick(600)};
+    Win32Window::Size const size{static_cast<unsigned int>(60 + pick(300)),
+                                 static_cast<unsigned int>(40 + pick(200))};
+    switch (pick(8)) {
+    case 0:
+      CHECK(manager.createRegularWindow(L"regular", origin, size).has_value());
+      break;
+    case 1:
+      CHECK(manager.createPopupWindow(L"popup", origin, size, any)
+                .has_value());
+      break;
+    case 2:
+      CHECK(manager.createSatelliteWindow(L"satellite", origin, size, any)
+                .has_value());
+      break;
+    case 3:
+      CHECK(manager.createTipWindow(L"tip", origin, size, any).has_value());
+      break;
+    case 4:
+    case 5:
+      CHECK(manager.moveWindow(any, origin, size));
+      break;
+    case 6:
+      if (any != *main_window) {
+        CHECK(manager.destroyWindow(any, true));
+      }
+      break;
+    case 7:
+      backend.SetOcclusion(manager.windows().at(any)->GetHandle(),
+                           {.cloaked = false, .occluded = pick(2) == 0});
+      backend.FireTimers();
+      break;
+    }
+    if (step % 5 == 0) {
+      take_snapshot();
+    }
+  }
+  take_snapshot();
+  harness.engine().headless_messenger().SetSendObserver(nullptr);
+
+  auto const calls{harness.TakeSentCalls()};
+  CHECK(calls.size() > 400);
+  CHECK(snapshots.size() > 100);
+  CHECK(std::ranges::is_sorted(calls, {}, [](SentCall const &call) {
+    return call.Int("sequence").value_or(0);
+  }));
+  // Some snapshots were taken with events numbered up to them still queued.
+  CHECK(std::ranges::any_of(snapshots, &TakenSnapshot::while_queued));
+
+  auto const &current{snapshots.back().windows};
+  int mismatched_before{0};
+  int mismatched_after{0};
+  for (auto const &snapshot : snapshots) {
+    Windows from_events;
+    auto updated{snapshot.windows};
+    for (auto const &call : calls) {
+      if (static_cast<uint64_t>(call.Int("sequence").value_or(0)) <=
+          snapshot.sequence) {
+        Apply(call, from_events);
+      } else {
+        Apply(call, updated);
+      }
+    }
+    mismatched_before += !Matches(from_events, snapshot.windows);
+    mismatched_after += !Matches(updated, current);
+  }
+  CHECK_EQ(mismatched_before, 0);
+  CHECK_EQ(mismatched_after, 0);
+
+  return flw::test::Finish("window_snapshot_test");
+}
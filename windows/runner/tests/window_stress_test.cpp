@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "test_support.h"
+
+// Creates and destroys 100k regular windows and popups in rounds, and checks
+// that every native window is released and every window is announced to Dart
+// as created and as destroyed exactly once. Reports the time per window.
+
+namespace {
+
+constexpr int kRounds{200};
+constexpr int kRegularWindowsPerRound{100};
+constexpr int kPopupsPerRegularWindow{4};
+
+} // namespace
+
+int main() {
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+
+  // Keeps the runner from quitting when a round destroys its regular windows.
+  auto const anchor{manager.createRegularWindow(L"anchor", {0, 0}, {64, 64})};
+  CHECK(anchor.has_value());
+  harness.TakeSentCalls();
+  auto const native_windows_before{harness.backend().window_count()};
+
+  uint64_t created{0};
+  uint64_t destroyed{0};
+  uint64_t windows{0};
+  auto const start{std::chrono::steady_clock::now()};
+  for (int round{0}; round < kRounds; ++round) {
+    std::vector<flutter::FlutterViewId> regular_windows;
+    for (int i{0}; i < kRegularWindowsPerRound; ++i) {
+      auto const window{manager.createRegularWindow(
+          L"regular", {i * 8, 0}, {320, 240})};
+      CHECK(window.has_value());
+      if (!window) {
+        continue;
+      }
+      regular_windows.push_back(*window);
+      for (int j{0}; j < kPopupsPerRegularWindow; ++j) {
+        CHECK(manager
+                  .createPopupWindow(L"popup", {j, 0},
+                                     {64, 32}, *window)
+                  .has_value());
+      }
+      windows += 1 + kPopupsPerRegularWindow;
+    }
+    // Destroying a regular window destroys its popups with it.
+    for (auto const window : regular_windows) {
+      CHECK(manager.destroyWindow(window, true));
+    }
+    manager.flushEvents();
+    for (auto const &call : harness.TakeSentCalls()) {
+      created += call.method == "onWindowCreated";
+      destroyed += call.method == "onWindowDestroyed";
+    }
+    // Closed windows are erased by the next create.
+    CHECK_EQ(std::ranges::count_if(manager.windows(),
+                                   [](auto const &window) {
+                                     return !window.second->closed();
+                                   }),
+             1);
+    CHECK_EQ(harness.backend().window_count(), native_windows_before);
+  }
+  auto const elapsed{std::chrono::duration<double, std::micro>(
+      std::chrono::steady_clock::now() - start)};
+
+  CHECK_EQ(created, windows);
+  CHECK_EQ(destroyed, windows);
+  CHECK(!harness.backend().quit_requested());
+  std::printf("%llu windows created and destroyed, %.2f us per window\n",
+              static_cast<unsigned long long>(windows),
+              elapsed.count() / static_cast<double>(windows));
+  return flw::test::Finish("window_stress_test");
+}
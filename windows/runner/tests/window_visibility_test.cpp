@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <chrono>
+
+#include "test_support.h"
+#include "window_visibility.h"
+
+// The visibility tracker derives one visibility from the hidden causes and
+// times the surface release from when the window stopped being visible.
+// Hidden windows report their visibility to Dart and stop resizing their
+// content, which catches up when they are shown again.
+
+namespace {
+
+using flw::Visibility;
+using flw::VisibilityTracker;
+using namespace std::chrono_literals;
+
+auto VisibilityEvents(flw::test::Harness &harness,
+                      flutter::FlutterViewId view_id) -> std::vector<int64_t> {
+  std::vector<int64_t> visibilities;
+  for (auto const &call : harness.TakeSentCalls()) {
+    if (call.method == "onWindowVisibilityChanged" &&
+        call.Int("viewId") == view_id) {
+      visibilities.push_back(*call.Int("visibility"));
+    }
+  }
+  return visibilities;
+}
+
+} // namespace
+
+int main() {
+  {
+    VisibilityTracker tracker;
+    VisibilityTracker::Clock::time_point const start{};
+    CHECK(tracker.visibility() == Visibility::visible);
+    CHECK(tracker.SetOccluded(true, start));
+    CHECK(tracker.visibility() == Visibility::occluded);
+    // Minimized outranks the other causes, and the grace period keeps running
+    // from when the window was first hidden.
+    CHECK(tracker.SetMinimized(true, start + 2s));
+    CHECK(tracker.visibility() == Visibility::minimized);
+    CHECK(!tracker.SetCloaked(true, start + 3s));
+    CHECK(!tracker.ShouldReleaseSurface(5s, start + 4s));
+    CHECK(tracker.ShouldReleaseSurface(5s, start + 5s));
+    tracker.OnSurfaceReleased();
+    CHECK(!tracker.ShouldReleaseSurface(5s, start + 6s));
+    CHECK(tracker.SetMinimized(false, start + 7s));
+    CHECK(tracker.visibility() == Visibility::cloaked);
+    CHECK(!tracker.ShouldRestoreSurface());
+    CHECK(tracker.SetCloaked(false, start + 8s));
+    CHECK(tracker.SetOccluded(false, start + 8s));
+    CHECK(tracker.ShouldRestoreSurface());
+  }
+
+  flw::test::Harness harness;
+  auto &manager{harness.manager()};
+  auto &backend{harness.backend()};
+  auto const window{manager.createRegularWindow(L"window", {0, 0}, {400, 300})};
+  CHECK(window.has_value());
+  auto &flutter_window{*manager.windows().at(*window)};
+  auto const handle{flutter_window.GetHandle()};
+  harness.TakeSentCalls();
+
+  // Occlusion is polled.
+  backend.SetOcclusion(handle, {.cloaked = false, .occluded = true});
+  backend.FireTimers();
+  CHECK(VisibilityEvents(harness, *window) ==
+        std::vector<int64_t>{static_cast<int64_t>(Visibility::occluded)});
+  backend.FireTimers();
+  CHECK(VisibilityEvents(harness, *window).empty());
+  backend.SetOcclusion(handle, {.cloaked = false, .occluded = false});
+  backend.FireTimers();
+  CHECK(VisibilityEvents(harness, *window) ==
+        std::vector<int64_t>{static_cast<int64_t>(Visibility::visible)});
+
+  // A minimized window keeps its content at the size it had.
+  auto const content{flutter_window.flutter_view()->GetNativeWindow()};
+  auto const content_before{backend.GetClientRect(content)};
+  backend.SendWindowMessage(handle, WM_SIZE, SIZE_MINIMIZED, 0);
+  CHECK(VisibilityEvents(harness, *window) ==
+        std::vector<int64_t>{static_cast<int64_t>(Visibility::minimized)});
+  auto const content_minimized{backend.GetClientRect(content)};
+  CHECK_EQ(content_minimized.right, content_before.right);
+  CHECK_EQ(content_minimized.bottom, content_before.bottom);
+  backend.SendWindowMessage(handle, WM_SIZE, SIZE_RESTORED, 0);
+  CHECK(VisibilityEvents(harness, *window) ==
+        std::vector<int64_t>{static_cast<int64_t>(Visibility::visible)});
+
+  // Only the window without an owner polls, and its owned windows take their
+  // state from it: those within its frame are covered along with it.
+  auto const satellite{
+      manager.createSatelliteWindow(L"satellite", {500, 0}, {100, 100}, *window)};
+  auto const popup{
+      manager.createPopupWindow(L"popup", {10, 10}, {60, 60}, *window)};
+  auto const tip{manager.createTipWindow(L"tip", {20, 20}, {50, 20}, *popup)};
+  CHECK(popup && tip && satellite);
+  auto const visibility_of{[&manager](flutter::FlutterViewId id) {
+    return manager.windows().at(id)->visibility_tracker().visibility();
+  }};
+  auto const queries_before{backend.counters().occlusion_queries};
+  backend.FireTimers();
+  CHECK_EQ(backend.counters().occlusion_queries, queries_before + 1u);
+
+  backend.SetOcclusion(handle, {.cloaked = false, .occluded = true});
+  backend.FireTimers();
+  CHECK(visibility_of(*popup) == Visibility::occluded);
+  CHECK(visibility_of(*tip) == Visibility::occluded);
+  CHECK(visibility_of(*satellite) == Visibility::visible);
+  backend.SetOcclusion(handle, {.cloaked = true, .occluded = false});
+  backend.FireTimers();
+  CHECK(visibility_of(*popup) == Visibility::cloaked);
+  CHECK(visibility_of(*satellite) == Visibility::cloaked);
+  backend.SetOcclusion(handle, {.cloaked = false, .occluded = false});
+  backend.FireTimers();
+  CHECK(visibility_of(*tip) == Visibility::visible);
+  CHECK(visibility_of(*satellite) == Visibility::visible);
+
+  return flw::test::Finish("window_visibility_test");
+}
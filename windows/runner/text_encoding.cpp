@@ -0,0 +1,299 @@
+#include "text_encoding.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FLW_TEXT_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLW_TEXT_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define FLW_TEXT_NEON
+#endif
+
+namespace flw::text {
+
+namespace {
+
+// Copies the ASCII code units at the start of |in| to |out|, a block at a
+// time. Returns the number of units copied, which stops short of the first
+// block holding a non-ASCII unit.
+template <typename Char16>
+auto NarrowAscii(Char16 const *in, size_t size, char *out) -> size_t {
+  size_t i{0};
+#if defined(FLW_TEXT_AVX2)
+  auto const mask{_mm256_set1_epi16(static_cast<short>(0xFF80))};
+  for (; i + 16 <= size; i += 16) {
+    auto const units{
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(in + i))};
+    if (!_mm256_testz_si256(units, mask)) {
+      break;
+    }
+    auto const bytes{_mm_packus_epi16(_mm256_castsi256_si128(units),
+                                      _mm256_extracti128_si256(units, 1))};
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), bytes);
+  }
+#elif defined(FLW_TEXT_SSE2)
+  auto const mask{_mm_set1_epi16(static_cast<short>(0xFF80))};
+  for (; i + 8 <= size; i += 8) {
+    auto const units{
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(in + i))};
+    auto const high{_mm_cmpeq_epi16(_mm_and_si128(units, mask),
+                                    _mm_setzero_si128())};
+    if (_mm_movemask_epi8(high) != 0xFFFF) {
+      break;
+    }
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out + i),
+                     _mm_packus_epi16(units, units));
+  }
+#elif defined(FLW_TEXT_NEON)
+  for (; i + 8 <= size; i += 8) {
+    auto const units{vld1q_u16(reinterpret_cast<uint16_t const *>(in + i))};
+    if (vmaxvq_u16(units) >= 0x80) {
+      break;
+    }
+    vst1_u8(reinterpret_cast<uint8_t *>(out + i), vmovn_u16(units));
+  }
+#endif
+  return i;
+}
+
+// Widens the ASCII bytes at the start of |in| into |out|, a block at a time.
+// Returns the number of bytes widened, which stops short of the first block
+// holding a non-ASCII byte.
+template <typename Char16>
+auto WidenAscii(unsigned char const *in, size_t size, Char16 *out) -> size_t {
+  size_t i{0};
+#if defined(FLW_TEXT_AVX2)
+  for (; i + 32 <= size; i += 32) {
+    auto const bytes{
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(in + i))};
+    if (_mm256_movemask_epi8(bytes) != 0) {
+      break;
+    }
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(out + i),
+        _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(out + i + 16),
+        _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)));
+  }
+#elif defined(FLW_TEXT_SSE2)
+  auto const zero{_mm_setzero_si128()};
+  for (; i + 16 <= size; i += 16) {
+    auto const bytes{
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(in + i))};
+    if (_mm_movemask_epi8(bytes) != 0) {
+      break;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                     _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 8),
+                     _mm_unpackhi_epi8(bytes, zero));
+  }
+#elif defined(FLW_TEXT_NEON)
+  for (; i + 16 <= size; i += 16) {
+    auto const bytes{vld1q_u8(in + i)};
+    if (vmaxvq_u8(bytes) >= 0x80) {
+      break;
+    }
+    vst1q_u16(reinterpret_cast<uint16_t *>(out + i),
+              vmovl_u8(vget_low_u8(bytes)));
+    vst1q_u16(reinterpret_cast<uint16_t *>(out + i + 8),
+              vmovl_high_u8(bytes));
+  }
+#endif
+  return i;
+}
+
+constexpr auto IsSurrogate(char32_t c) -> bool {
+  return c >= 0xD800 && c <= 0xDFFF;
+}
+
+// Encodes |in|, UTF-16 or UTF-32 depending on the size of Char, as UTF-8 into
+// |out|. Returns the number of bytes written.
+template <typename Char>
+auto EncodeUtf8(Char const *in, size_t size, char *out)
+    -> std::optional<size_t> {
+  size_t i{0};
+  size_t o{0};
+  while (i < size) {
+    // Text in other scripts rarely switches back to ASCII for long; only look
+    // for a run where one starts.
+    if constexpr (sizeof(Char) == 2) {
+      if (in[i] < 0x80) {
+        auto const ascii{NarrowAscii(in + i, size - i, out + o)};
+        i += ascii;
+        o += ascii;
+        if (i == size) {
+          break;
+        }
+      }
+    }
+    auto c{static_cast<char32_t>(in[i++])};
+    if (c < 0x80) {
+      out[o++] = static_cast<char>(c);
+      continue;
+    }
+    if (c < 0x800) {
+      out[o++] = static_cast<char>(0xC0 | (c >> 6));
+      out[o++] = static_cast<char>(0x80 | (c & 0x3F));
+      continue;
+    }
+    if (IsSurrogate(c)) {
+      if constexpr (sizeof(Char) != 2) {
+        return std::nullopt;
+      } else {
+        if (c >= 0xDC00 || i == size) {
+          return std::nullopt;
+        }
+        auto const low{static_cast<char32_t>(in[i])};
+        if (low < 0xDC00 || low > 0xDFFF) {
+          return std::nullopt;
+        }
+        ++i;
+        c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+      }
+    }
+    if (c < 0x10000) {
+      out[o++] = static_cast<char>(0xE0 | (c >> 12));
+    } else if (c <= 0x10FFFF) {
+      out[o++] = static_cast<char>(0xF0 | (c >> 18));
+      out[o++] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+    } else {
+      return std::nullopt;
+    }
+    out[o++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    out[o++] = static_cast<char>(0x80 | (c & 0x3F));
+  }
+  return o;
+}
+
+// Decodes the UTF-8 |in| into |out|, as UTF-16 or UTF-32 depending on the size
+// of Char. Returns the number of code units written.
+template <typename Char>
+auto DecodeUtf8(unsigned char const *in, size_t size, Char *out)
+    -> std::optional<size_t> {
+  size_t i{0};
+  size_t o{0};
+  while (i < size) {
+    if constexpr (sizeof(Char) == 2) {
+      if (in[i] < 0x80) {
+        auto const ascii{WidenAscii(in + i, size - i, out + o)};
+        i += ascii;
+        o += ascii;
+        if (i == size) {
+          break;
+        }
+      }
+    }
+    auto const lead{in[i]};
+    if (lead < 0x80) {
+      out[o++] = static_cast<Char>(lead);
+      ++i;
+      continue;
+    }
+    size_t length;
+    char32_t c;
+    char32_t min;
+    if ((lead & 0xE0) == 0xC0) {
+      length = 2;
+      c = lead & 0x1F;
+      min = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+      length = 3;
+      c = lead & 0x0F;
+      min = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+      length = 4;
+      c = lead & 0x07;
+      min = 0x10000;
+    } else {
+      return std::nullopt;
+    }
+    if (size - i < length) {
+      return std::nullopt;
+    }
+    for (size_t k{1}; k < length; ++k) {
+      auto const byte{in[i + k]};
+      if ((byte & 0xC0) != 0x80) {
+        return std::nullopt;
+      }
+      c = (c << 6) | (byte & 0x3F);
+    }
+    if (c < min || c > 0x10FFFF || IsSurrogate(c)) {
+      return std::nullopt;
+    }
+    i += length;
+    if constexpr (sizeof(Char) == 2) {
+      if (c >= 0x10000) {
+        c -= 0x10000;
+        out[o++] = static_cast<Char>(0xD800 + (c >> 10));
+        out[o++] = static_cast<Char>(0xDC00 + (c & 0x3FF));
+        continue;
+      }
+    }
+    out[o++] = static_cast<Char>(c);
+  }
+  return o;
+}
+
+template <typename Char>
+auto ToUtf8(std::basic_string_view<Char> in) -> std::optional<std::string> {
+  // A UTF-16 unit takes at most 3 bytes, a surrogate pair 4 for 2 units.
+  constexpr size_t kMaxBytesPerUnit{sizeof(Char) == 2 ? 3 : 4};
+  std::string out;
+  auto valid{true};
+  out.resize_and_overwrite(in.size() * kMaxBytesPerUnit,
+                           [&](char *data, size_t) {
+                             auto const size{
+                                 EncodeUtf8(in.data(), in.size(), data)};
+                             valid = size.has_value();
+                             return size.value_or(0);
+                           });
+  if (!valid) {
+    return std::nullopt;
+  }
+  return out;
+}
+
+template <typename Char>
+auto FromUtf8(std::string_view in) -> std::optional<std::basic_string<Char>> {
+  // Each byte yields at most one code unit.
+  std::basic_string<Char> out;
+  auto valid{true};
+  out.resize_and_overwrite(in.size(), [&](Char *data, size_t) {
+    auto const size{DecodeUtf8(
+        reinterpret_cast<unsigned char const *>(in.data()), in.size(), data)};
+    valid = size.has_value();
+    return size.value_or(0);
+  });
+  if (!valid) {
+    return std::nullopt;
+  }
+  return out;
+}
+
+} // namespace
+
+auto Utf8FromUtf16(std::u16string_view utf16) -> std::optional<std::string> {
+  return ToUtf8(utf16);
+}
+
+auto Utf16FromUtf8(std::string_view utf8) -> std::optional<std::u16string> {
+  return FromUtf8<char16_t>(utf8);
+}
+
+auto Utf8FromWide(std::wstring_view wide) -> std::optional<std::string> {
+  return ToUtf8(wide);
+}
+
+auto WideFromUtf8(std::string_view utf8) -> std::optional<std::wstring> {
+  return FromUtf8<wchar_t>(utf8);
+}
+
+} // namespace flw::text
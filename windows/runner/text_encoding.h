@@ -0,0 +1,25 @@
+#ifndef RUNNER_TEXT_ENCODING_H_
+#define RUNNER_TEXT_ENCODING_H_
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace flw::text {
+
+// Transcodes between the UTF-8 of Flutter channels and the UTF-16 of Win32.
+// Input holding an unpaired surrogate or a malformed, overlong or out of range
+// UTF-8 sequence yields std::nullopt. Runs of ASCII are copied a vector
+// register at a time, with AVX2, SSE2 or NEON depending on the target, and
+// the output is sized in one pass over the input.
+auto Utf8FromUtf16(std::u16string_view utf16) -> std::optional<std::string>;
+auto Utf16FromUtf8(std::string_view utf8) -> std::optional<std::u16string>;
+
+// As above for std::wstring, which holds UTF-16 on Windows and UTF-32
+// elsewhere.
+auto Utf8FromWide(std::wstring_view wide) -> std::optional<std::string>;
+auto WideFromUtf8(std::string_view utf8) -> std::optional<std::wstring>;
+
+} // namespace flw::text
+
+#endif // RUNNER_TEXT_ENCODING_H_
@@ -0,0 +1,176 @@
+#include "trace_event.h"
+
+#if defined(FLW_ENABLE_TRACING)
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+namespace flw::trace {
+
+namespace {
+
+// Every flow arrow shares the same category and name, as required for the
+// start, step and end events of a flow to be matched by their id.
+constexpr char kCategory[]{"flw"};
+constexpr char kFlowName[]{"flw/window request"};
+
+void WriteEscaped(std::ofstream &out, std::string const &value) {
+  out << '"';
+  for (auto const c : value) {
+    switch (c) {
+    case '"':
+      out << "\\\"";
+      break;
+    case '\\':
+      out << "\\\\";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[8];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x",
+                      static_cast<unsigned int>(c));
+        out << escaped;
+      } else {
+        out << c;
+      }
+    }
+  }
+  out << '"';
+}
+
+} // namespace
+
+void TraceLog::Complete(std::string name, TrackId track, double start_us,
+                        double duration_us) {
+  Push({.phase = 'X',
+        .name = std::move(name),
+        .track = track,
+        .timestamp_us = start_us,
+        .duration_us = duration_us,
+        .flow = 0});
+}
+
+void TraceLog::Instant(std::string name, TrackId track) {
+  Push({.phase = 'i',
+        .name = std::move(name),
+        .track = track,
+        .timestamp_us = Now(),
+        .duration_us = 0,
+        .flow = 0});
+}
+
+void TraceLog::NameTrack(TrackId track, std::string name) {
+  Push({.phase = 'M',
+        .name = std::move(name),
+        .track = track,
+        .timestamp_us = 0,
+        .duration_us = 0,
+        .flow = 0});
+}
+
+FlowId TraceLog::BeginFlow(TrackId track) {
+  FlowId flow;
+  {
+    std::lock_guard const lock(mutex_);
+    flow = next_flow_++;
+  }
+  Push({.phase = 's',
+        .name = kFlowName,
+        .track = track,
+        .timestamp_us = Now(),
+        .duration_us = 0,
+        .flow = flow});
+  return flow;
+}
+
+void TraceLog::StepFlow(FlowId flow, TrackId track) {
+  if (flow) {
+    Push({.phase = 't',
+          .name = kFlowName,
+          .track = track,
+          .timestamp_us = Now(),
+          .duration_us = 0,
+          .flow = flow});
+  }
+}
+
+void TraceLog::EndFlow(FlowId flow, TrackId track) {
+  if (flow) {
+    Push({.phase = 'f',
+          .name = kFlowName,
+          .track = track,
+          .timestamp_us = Now(),
+          .duration_us = 0,
+          .flow = flow});
+  }
+}
+
+// static
+FlowId &TraceLog::CurrentFlow() {
+  thread_local FlowId flow{0};
+  return flow;
+}
+
+double TraceLog::Now() const {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now() - start_)
+      .count();
+}
+
+void TraceLog::Flush(char const *path) {
+  std::vector<Event> events;
+  {
+    std::lock_guard const lock(mutex_);
+    events.swap(events_);
+  }
+
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) {
+    return;
+  }
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  out << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{"
+         "\"name\":\"flutter runner\"}}";
+  out << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":"
+      << kManagerTrack << ",\"args\":{\"name\":\"FlutterWindowManager\"}}";
+  for (auto const &event : events) {
+    out << ",\n{\"pid\":1,\"tid\":" << event.track;
+    if (event.phase == 'M') {
+      out << ",\"ph\":\"M\",\"name\":\"thread_name\",\"args\":{\"name\":";
+      WriteEscaped(out, event.name);
+      out << "}}";
+      continue;
+    }
+    out << ",\"ph\":\"" << event.phase << "\",\"cat\":\"" << kCategory
+        << "\",\"name\":";
+    WriteEscaped(out, event.name);
+    out << ",\"ts\":" << event.timestamp_us;
+    switch (event.phase) {
+    case 'X':
+      out << ",\"dur\":" << event.duration_us;
+      break;
+    case 'i':
+      out << ",\"s\":\"t\"";
+      break;
+    case 'f':
+      out << ",\"bp\":\"e\",\"id\":" << event.flow;
+      break;
+    default:
+      out << ",\"id\":" << event.flow;
+      break;
+    }
+    out << '}';
+  }
+  out << "\n]}\n";
+}
+
+void TraceLog::Push(Event event) {
+  std::lock_guard const lock(mutex_);
+  events_.push_back(std::move(event));
+}
+
+} // namespace flw::trace
+
+#endif // defined(FLW_ENABLE_TRACING)
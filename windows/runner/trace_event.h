@@ -0,0 +1,152 @@
+#ifndef RUNNER_TRACE_EVENT_H_
+#define RUNNER_TRACE_EVENT_H_
+
+// Trace-event instrumentation of the window lifecycle, written as a Chrome
+// JSON trace that can be opened in chrome://tracing or ui.perfetto.dev.
+//
+// Tracing is opt-in at build time through the FLW_ENABLE_TRACING CMake option.
+// When it is off, every FLW_TRACE_* macro expands to nothing and its arguments
+// are never evaluated.
+//
+// Events land on "tracks": the manager track for work that is not yet tied to
+// a view, and one track per Flutter view. Flows link the handling of a Dart
+// request on the flw/window channel to the native work it causes, up to the
+// first frame of the created view.
+
+#if defined(FLW_ENABLE_TRACING)
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace flw::trace {
+
+using TrackId = int64_t;
+using FlowId = uint64_t;
+
+inline constexpr TrackId kManagerTrack{0};
+
+// Returns the track dedicated to the Flutter view |view_id|.
+constexpr TrackId ViewTrack(int64_t view_id) { return view_id + 1; }
+
+class TraceLog {
+public:
+  static TraceLog &instance() {
+    static TraceLog instance;
+    return instance;
+  }
+
+  void Complete(std::string name, TrackId track, double start_us,
+                double duration_us);
+  void Instant(std::string name, TrackId track);
+  void NameTrack(TrackId track, std::string name);
+
+  // Flow events bind to the slice enclosing them on |track|.
+  FlowId BeginFlow(TrackId track);
+  void StepFlow(FlowId flow, TrackId track);
+  void EndFlow(FlowId flow, TrackId track);
+
+  // The flow started by the innermost channel call on this thread, or 0.
+  static FlowId &CurrentFlow();
+
+  double Now() const;
+
+  // Writes all recorded events to |path| and clears the log.
+  void Flush(char const *path);
+
+private:
+  struct Event {
+    char phase;
+    std::string name;
+    TrackId track;
+    double timestamp_us;
+    double duration_us;
+    FlowId flow;
+  };
+
+  TraceLog() = default;
+
+  void Push(Event event);
+
+  std::chrono::steady_clock::time_point const start_{
+      std::chrono::steady_clock::now()};
+  std::mutex mutex_;
+  std::vector<Event> events_;
+  FlowId next_flow_{1};
+};
+
+// Records a complete event spanning from construction to End() or
+// destruction, whichever comes first.
+class TraceScope {
+public:
+  TraceScope(std::string name, TrackId track)
+      : name_(std::move(name)), track_(track),
+        start_us_(TraceLog::instance().Now()) {}
+  ~TraceScope() { End(); }
+  TraceScope(TraceScope const &) = delete;
+  TraceScope &operator=(TraceScope const &) = delete;
+
+  void End() {
+    if (!ended_) {
+      ended_ = true;
+      auto &log{TraceLog::instance()};
+      log.Complete(std::move(name_), track_, start_us_,
+                   log.Now() - start_us_);
+    }
+  }
+
+private:
+  std::string name_;
+  TrackId track_;
+  double start_us_;
+  bool ended_ = false;
+};
+
+} // namespace flw::trace
+
+#define FLW_TRACE_CONCAT_INNER(a, b) a##b
+#define FLW_TRACE_CONCAT(a, b) FLW_TRACE_CONCAT_INNER(a, b)
+
+#define FLW_TRACE_VIEW_TRACK(view_id) flw::trace::ViewTrack(view_id)
+#define FLW_TRACE_SCOPE(name)                                                  \
+  flw::trace::TraceScope const FLW_TRACE_CONCAT(flw_trace_scope_, __LINE__)(  \
+      name, flw::trace::kManagerTrack)
+#define FLW_TRACE_SCOPE_ON(name, track)                                        \
+  flw::trace::TraceScope const FLW_TRACE_CONCAT(flw_trace_scope_, __LINE__)(  \
+      name, track)
+#define FLW_TRACE_SCOPE_NAMED(var, name)                                       \
+  flw::trace::TraceScope var(name, flw::trace::kManagerTrack)
+#define FLW_TRACE_SCOPE_END(var) var.End()
+#define FLW_TRACE_NAME_TRACK(track, name)                                      \
+  flw::trace::TraceLog::instance().NameTrack(track, name)
+#define FLW_TRACE_INSTANT(name, track)                                         \
+  flw::trace::TraceLog::instance().Instant(name, track)
+#define FLW_TRACE_FLOW_BEGIN()                                                 \
+  flw::trace::TraceLog::CurrentFlow() =                                        \
+      flw::trace::TraceLog::instance().BeginFlow(flw::trace::kManagerTrack)
+#define FLW_TRACE_FLOW_STEP(track)                                             \
+  flw::trace::TraceLog::instance().StepFlow(                                   \
+      flw::trace::TraceLog::CurrentFlow(), track)
+#define FLW_TRACE_FLOW_CLEAR() flw::trace::TraceLog::CurrentFlow() = 0
+#define FLW_TRACE_FLUSH()                                                      \
+  flw::trace::TraceLog::instance().Flush(FLW_TRACE_FILE)
+
+#else
+
+#define FLW_TRACE_VIEW_TRACK(view_id)
+#define FLW_TRACE_SCOPE(name)
+#define FLW_TRACE_SCOPE_ON(name, track)
+#define FLW_TRACE_SCOPE_NAMED(var, name)
+#define FLW_TRACE_SCOPE_END(var)
+#define FLW_TRACE_NAME_TRACK(track, name)
+#define FLW_TRACE_INSTANT(name, track)
+#define FLW_TRACE_FLOW_BEGIN()
+#define FLW_TRACE_FLOW_STEP(track)
+#define FLW_TRACE_FLOW_CLEAR()
+#define FLW_TRACE_FLUSH()
+
+#endif // defined(FLW_ENABLE_TRACING)
+
+#endif // RUNNER_TRACE_EVENT_H_
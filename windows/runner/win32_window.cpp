@@ -1,207 +1,333 @@
 #include "win32_window.h"
 
-#include <dwmapi.h>
+#include <algorithm>
+#include <cstdio>
+#include <optional>
+#include <utility>
 
 #include "flutter_window_manager.h"
-
-#include "resource.h"
+#include "geometry_transaction.h"
+#include "message_replay.h"
+#include "message_routes.h"
+#include "message_stats.h"
+#include "trace_event.h"
+#include "window_backend.h"
+#include "window_layout.h"
+#include "window_placement.h"
 
 namespace {
 
-constexpr const wchar_t kWindowClassName[] = L"FLUTTER_RUNNER_WIN32_WINDOW";
-
 // The number of Win32Window objects that currently exist.
 int g_active_window_count = 0;
 
+Win32Window::LiveResizeOptions g_live_resize_options;
+
+// Timer polling whether the window is cloaked or occluded, which Windows does
+// not notify.
+constexpr uintptr_t kVisibilityTimerId{1};
+constexpr std::chrono::milliseconds kVisibilityPollInterval{1000};
+
+// How long a window stays hidden before its content's surface is released.
+constexpr std::chrono::seconds kHiddenSurfaceGracePeriod{5};
+
+// Where Windows parks minimized top-level windows.
+constexpr int kMinimizedPosition{-32000};
+
 // Scale helper to convert logical scaler values to physical using passed in
 // scale factor
 int Scale(int source, double scale_factor) {
   return static_cast<int>(source * scale_factor);
 }
 
-// Dynamically loads the |EnableNonClientDpiScaling| from the User32 module.
-// This API is only needed for PerMonitor V1 awareness mode.
-void EnableFullDpiSupportIfAvailable(HWND hwnd) {
-  HMODULE user32_module = LoadLibraryA("User32.dll");
-  if (!user32_module) {
-    return;
-  }
+// Returns the frame, in physical pixels, of a window at |origin| with |size| in
+// logical pixels on the monitor containing |origin|.
+RECT ScaledFrame(const Win32Window::Point &origin,
+                 const Win32Window::Size &size) {
+  const POINT target_point = {static_cast<LONG>(origin.x),
+                              static_cast<LONG>(origin.y)};
+  UINT const dpi = WindowBackend::instance().GetDpiForPoint(target_point);
+  auto const scale_factor = dpi / 96.0;
+  auto const left{Scale(origin.x, scale_factor)};
+  auto const top{Scale(origin.y, scale_factor)};
+  return RECT{left, top, left + Scale(size.width, scale_factor),
+              top + Scale(size.height, scale_factor)};
+}
 
-  using EnableNonClientDpiScaling = BOOL __stdcall(HWND hwnd);
+} // namespace
 
-  auto enable_non_client_dpi_scaling =
-      reinterpret_cast<EnableNonClientDpiScaling *>(
-          GetProcAddress(user32_module, "EnableNonClientDpiScaling"));
-  if (enable_non_client_dpi_scaling != nullptr) {
-    enable_non_client_dpi_scaling(hwnd);
+// The window messages handled by each archetype. Messages without a route go
+// straight to DefWindowProc.
+struct Win32Window::MessageRoutes {
+  using Route = flw::MessageRoute<Win32Window>;
+  using Result = std::optional<LRESULT>;
+
+  // Returns the router of |archetype|.
+  static auto For(flw::Archetype archetype) -> flw::MessageRouter<Win32Window>;
+
+  template <flw::Archetype A, typename... Extra>
+  static consteval auto Make(Extra... extra) {
+    return flw::MakeMessageRoutes<Win32Window>(
+        Route{WM_DESTROY, &HandleDestroy},
+        Route{WM_DPICHANGED, &HandleDpiChanged}, Route{WM_SIZE, &HandleSize},
+        Route{WM_TIMER, &HandleTimer},
+        Route{WM_ENTERSIZEMOVE, &HandleEnterSizeMove},
+        Route{WM_WINDOWPOSCHANGING, &HandleWindowPosChanging},
+        Route{WM_WINDOWPOSCHANGED, &HandleWindowPosChanged},
+        Route{WM_DISPLAYCHANGE, &HandleDisplayChange},
+        Route{WM_MOVE, &HandleMove},
+        Route{WM_EXITSIZEMOVE, &HandleExitSizeMove<A>},
+        Route{WM_ACTIVATE, &HandleActivate<A>},
+        Route{WM_ACTIVATEAPP, &HandleActivateApp},
+        Route{WM_MOUSEACTIVATE, &HandleMouseActivate<A>}, extra...);
   }
 
-  FreeLibrary(user32_module);
-}
-
-void EnableTransparentWindowBackground(HWND hwnd) {
-  HMODULE user32_module = LoadLibraryA("User32.dll");
-  if (!user32_module) {
-    return;
+  static auto HandleDestroy(Win32Window &window, HWND, WPARAM, LPARAM)
+      -> Result {
+    if (window.quit_on_close_) {
+      // The windows closed on the way out stay in the saved layout.
+      flw::WindowLayout::instance().Freeze();
+    }
+    window.window_handle_ = nullptr;
+    window.Destroy();
+    if (window.quit_on_close_) {
+      WindowBackend::instance().PostQuit(0);
+    }
+    return 0;
   }
 
-  enum WINDOWCOMPOSITIONATTRIB { WCA_ACCENT_POLICY = 19 };
-
-  struct WINDOWCOMPOSITIONATTRIBDATA {
-    WINDOWCOMPOSITIONATTRIB Attrib;
-    PVOID pvData;
-    SIZE_T cbData;
-  };
-
-  using SetWindowCompositionAttribute =
-      BOOL(__stdcall *)(HWND, WINDOWCOMPOSITIONATTRIBDATA *);
-
-  auto set_window_composition_attribute =
-      reinterpret_cast<SetWindowCompositionAttribute>(
-          GetProcAddress(user32_module, "SetWindowCompositionAttribute"));
-  if (set_window_composition_attribute != nullptr) {
-    enum ACCENT_STATE { ACCENT_DISABLED = 0 };
+  static auto HandleDpiChanged(Win32Window &window, HWND hwnd, WPARAM wparam,
+                               LPARAM lparam) -> Result {
+    auto *newRectSize = reinterpret_cast<RECT *>(lparam);
 
-    struct ACCENT_POLICY {
-      ACCENT_STATE AccentState;
-      DWORD AccentFlags;
-      DWORD GradientColor;
-      DWORD AnimationId;
-    };
+    // Compute the final frame and content size up front and apply them as a
+    // single update: the WM_SIZE sent by the commit finds the content in
+    // place and reports nothing, and subclasses hear of the change once,
+    // after the window has its new size and DPI.
+    GeometryTransaction transaction;
+    transaction.SetFrame(hwnd, *newRectSize);
+    if (window.child_content_ != nullptr) {
+      transaction.SetFrame(window.child_content_,
+                           WindowBackend::instance().GetClientRectForFrame(
+                               hwnd, *newRectSize, HIWORD(wparam)));
+    }
+    window.in_dpi_change_ = true;
+    transaction.Commit();
+    window.in_dpi_change_ = false;
+    window.RefreshGeometry();
+    if (window.child_content_ != nullptr) {
+      auto const content{
+          WindowBackend::instance().GetClientRect(window.child_content_)};
+      window.memory_->SetSurfaceSize(content.right - content.left,
+                                     content.bottom - content.top);
+    }
+    window.OnContentResized();
+    return 0;
+  }
 
-    ACCENT_POLICY accent = {ACCENT_DISABLED, 2, static_cast<DWORD>(0), 0};
-    WINDOWCOMPOSITIONATTRIBDATA data{.Attrib = WCA_ACCENT_POLICY,
-                                     .pvData = &accent,
-                                     .cbData = sizeof(accent)};
-    set_window_composition_attribute(hwnd, &data);
+  static auto HandleSize(Win32Window &window, HWND, WPARAM wparam, LPARAM)
+      -> Result {
+    // Maximizing, minimizing and restoring change the non-client area, which
+    // WM_WINDOWPOSCHANGED does not describe.
+    if (wparam != SIZE_RESTORED || window.last_size_type_ != SIZE_RESTORED) {
+      window.RefreshGeometry();
+    }
+    window.last_size_type_ = wparam;
+    auto const changed{window.visibility_.SetMinimized(
+        wparam == SIZE_MINIMIZED, std::chrono::steady_clock::now())};
+    if (window.visibility_.ShouldRestoreSurface()) {
+      window.visibility_.OnSurfaceRestored();
+    }
+    // Minimized windows keep their content as it is until the grace period
+    // elapses, so that restoring them soon after costs no reallocation.
+    if (window.child_content_ != nullptr && wparam != SIZE_MINIMIZED &&
+        !window.visibility_.surface_released() &&
+        !window.DeferContentResize()) {
+      window.ResizeContent();
+    }
+    if (changed) {
+      window.OnVisibilityChanged(window.visibility_.visibility());
+    }
+    return 0;
+  }
 
-    MARGINS const margins = {-1};
-    ::DwmExtendFrameIntoClientArea(hwnd, &margins);
-    BOOL const enable = TRUE;
-    INT effect_value = 1;
-    ::DwmSetWindowAttribute(hwnd, DWMWA_SYSTEMBACKDROP_TYPE, &effect_value,
-                            sizeof(enable));
+  static auto HandleTimer(Win32Window &window, HWND, WPARAM wparam, LPARAM)
+      -> Result {
+    if (wparam == kVisibilityTimerId) {
+      window.UpdateOcclusion();
+      return 0;
+    }
+    return std::nullopt;
   }
 
-  FreeLibrary(user32_module);
-}
+  static auto HandleEnterSizeMove(Win32Window &window, HWND, WPARAM, LPARAM)
+      -> Result {
+    window.in_size_move_ = true;
+    return std::nullopt;
+  }
 
-/// Window attribute that enables dark mode window decorations.
-///
-/// Redefined in case the developer's machine has a Windows SDK older than
-/// version 10.0.22000.0.
-/// See:
-/// https://docs.microsoft.com/windows/win32/api/dwmapi/ne-dwmapi-dwmwindowattribute
-#ifndef DWMWA_USE_IMMERSIVE_DARK_MODE
-#define DWMWA_USE_IMMERSIVE_DARK_MODE 20
-#endif
+  static auto HandleWindowPosChanging(Win32Window &window, HWND, WPARAM,
+                                      LPARAM lparam) -> Result {
+    window.MoveSatellites(*reinterpret_cast<WINDOWPOS const *>(lparam));
+    return std::nullopt;
+  }
 
-// Update the window frame's theme to match the system theme.
-void UpdateTheme(HWND window) {
-  // Registry key for app theme preference.
-  const wchar_t kGetPreferredBrightnessRegKey[] =
-      L"Software\\Microsoft\\Windows\\CurrentVersion\\Themes\\Personalize";
-  const wchar_t kGetPreferredBrightnessRegValue[] = L"AppsUseLightTheme";
+  static auto HandleWindowPosChanged(Win32Window &window, HWND, WPARAM,
+                                     LPARAM lparam) -> Result {
+    // Update the cache before the default processing sends WM_MOVE and
+    // WM_SIZE.
+    window.UpdateGeometry(*reinterpret_cast<WINDOWPOS const *>(lparam));
+    return std::nullopt;
+  }
 
-  // A value of 0 indicates apps should use dark mode. A non-zero or missing
-  // value indicates apps should use light mode.
-  DWORD light_mode;
-  DWORD light_mode_size = sizeof(light_mode);
-  LSTATUS const result =
-      RegGetValue(HKEY_CURRENT_USER, kGetPreferredBrightnessRegKey,
-                  kGetPreferredBrightnessRegValue, RRF_RT_REG_DWORD, nullptr,
-                  &light_mode, &light_mode_size);
+  static auto HandleDisplayChange(Win32Window &window, HWND, WPARAM, LPARAM)
+      -> Result {
+    window.RefreshGeometry();
+    return std::nullopt;
+  }
 
-  if (result == ERROR_SUCCESS) {
-    BOOL enable_dark_mode = light_mode == 0;
-    DwmSetWindowAttribute(window, DWMWA_USE_IMMERSIVE_DARK_MODE,
-                          &enable_dark_mode, sizeof(enable_dark_mode));
+  static auto HandleMove(Win32Window &window, HWND, WPARAM, LPARAM) -> Result {
+    if (!window.satellites_.empty()) {
+      window.RecordSatelliteTrail();
+    }
+    return std::nullopt;
   }
-}
 
-} // namespace
+  template <flw::Archetype A>
+  static auto HandleExitSizeMove(Win32Window &window, HWND, WPARAM, LPARAM)
+      -> Result {
+    window.in_size_move_ = false;
+    if constexpr (A == flw::Archetype::satellite) {
+      // The user moved the satellite itself; keep it where it was dropped.
+      window.UpdateSatelliteOffset();
+    }
+    if (window.child_content_ != nullptr) {
+      auto &backend{WindowBackend::instance()};
+      auto const content{backend.GetClientRect(window.child_content_)};
+      auto const client{window.GetClientArea()};
+      // Finish on the exact size if sizes were skipped or bucketed.
+      if (window.content_resize_pending_ || content.right != client.right ||
+          content.bottom != client.bottom) {
+        window.ResizeContent();
+      }
+    }
+    return std::nullopt;
+  }
 
-// Manages the Win32Window's window class registration.
-class WindowClassRegistrar {
-public:
-  ~WindowClassRegistrar() = default;
+  template <flw::Archetype A>
+  static auto HandleActivate(Win32Window &window, HWND, WPARAM wparam, LPARAM)
+      -> Result {
+    if (wparam != WA_INACTIVE) {
+      window.UpdateOcclusion();
+      if constexpr (A != flw::Archetype::popup) {
+        // If this window is not a popup and is being activated, close the
+        // popups anchored to other windows
+        for (auto const &[_, other] :
+             FlutterWindowManager::instance().windows()) {
+          other->CloseChildPopups();
+        }
+      }
+      // Close child popups if this window is being activated
+      window.CloseChildPopups();
+    }
 
-  // Returns the singleton registrar instance.
-  static WindowClassRegistrar *GetInstance() {
-    if (!instance_) {
-      instance_ = new WindowClassRegistrar();
+    if (window.child_content_ != nullptr) {
+      WindowBackend::instance().SetFocus(window.child_content_);
     }
-    return instance_;
+    return 0;
   }
 
-  // Returns the name of the window class, registering the class if it hasn't
-  // previously been registered.
-  const wchar_t *GetWindowClass();
-
-  // Unregisters the window class. Should only be called if there are no
-  // instances of the window.
-  void UnregisterWindowClass();
+  // Not routed for popups, which have no popups of their own.
+  static auto HandleNcActivate(Win32Window &window, HWND, WPARAM wparam,
+                               LPARAM) -> Result {
+    if (wparam == FALSE && !window.child_popups_.empty()) {
+      // If an inactive title bar is to be drawn, and this is a top-level
+      // window with popups, force the title bar to be drawn in its active
+      // colors
+      return TRUE;
+    }
+    return std::nullopt;
+  }
 
-private:
-  WindowClassRegistrar() = default;
+  static auto HandleActivateApp(Win32Window &window, HWND, WPARAM wparam,
+                                LPARAM) -> Result {
+    if (wparam == FALSE) {
+      // Close child popups if a window belonging to a different application
+      // is being activated
+      window.CloseChildPopups();
+    }
+    return 0;
+  }
 
-  static WindowClassRegistrar *instance_;
+  template <flw::Archetype A>
+  static auto HandleMouseActivate(Win32Window &window, HWND, WPARAM, LPARAM)
+      -> Result {
+    if constexpr (A == flw::Archetype::tip) {
+      return MA_NOACTIVATE;
+    } else {
+      if (window.child_content_ != nullptr) {
+        WindowBackend::instance().SetFocus(window.child_content_);
+      }
+      return MA_ACTIVATE;
+    }
+  }
 
-  bool class_registered_ = false;
+  // The routes of archetype A, sorted by message.
+  template <flw::Archetype A> static consteval auto Table() {
+    if constexpr (A == flw::Archetype::popup) {
+      return Make<A>();
+    } else {
+      return Make<A>(Route{WM_NCACTIVATE, &HandleNcActivate});
+    }
+  }
+  template <flw::Archetype A> static constexpr auto kRoutes{Table<A>()};
 };
 
-WindowClassRegistrar *WindowClassRegistrar::instance_ = nullptr;
-
-const wchar_t *WindowClassRegistrar::GetWindowClass() {
-  if (!class_registered_) {
-    WNDCLASS window_class{};
-    window_class.hCursor = LoadCursor(nullptr, IDC_ARROW);
-    window_class.lpszClassName = kWindowClassName;
-    window_class.style = CS_HREDRAW | CS_VREDRAW;
-    window_class.cbClsExtra = 0;
-    window_class.cbWndExtra = 0;
-    window_class.hInstance = GetModuleHandle(nullptr);
-    window_class.hIcon =
-        LoadIcon(window_class.hInstance, MAKEINTRESOURCE(IDI_APP_ICON));
-    window_class.hbrBackground = 0;
-    window_class.lpszMenuName = nullptr;
-    window_class.lpfnWndProc = Win32Window::WndProc;
-    RegisterClass(&window_class);
-    class_registered_ = true;
+auto Win32Window::MessageRoutes::For(flw::Archetype archetype)
+    -> flw::MessageRouter<Win32Window> {
+  using enum flw::Archetype;
+  switch (archetype) {
+  case satellite:
+    return &flw::RouteMessage<Win32Window, kRoutes<satellite>>;
+  case popup:
+    return &flw::RouteMessage<Win32Window, kRoutes<popup>>;
+  case tip:
+    return &flw::RouteMessage<Win32Window, kRoutes<tip>>;
+  default:
+    return &flw::RouteMessage<Win32Window, kRoutes<regular>>;
   }
-  return kWindowClassName;
 }
 
-void WindowClassRegistrar::UnregisterWindowClass() {
-  UnregisterClass(kWindowClassName, nullptr);
-  class_registered_ = false;
+Win32Window::Win32Window()
+    : memory_(flw::memory::MemoryAccounting::instance().CreateCounters()) {
+  ++g_active_window_count;
 }
 
-Win32Window::Win32Window() { ++g_active_window_count; }
-
 Win32Window::~Win32Window() {
+  FLW_RECORD_WINDOW_DESTROYED(this);
   --g_active_window_count;
   Destroy();
+  flw::memory::MemoryAccounting::instance().ReleaseCounters(memory_);
+}
+
+// static
+void Win32Window::SetLiveResizeOptions(LiveResizeOptions const &options) {
+  g_live_resize_options = options;
 }
 
 bool Win32Window::Create(const std::wstring &title, const Point &origin,
                          const Size &size, flw::Archetype archetype,
                          HWND parent) {
+  FLW_TRACE_SCOPE("Win32Window::Create");
   Destroy();
 
   archetype_ = archetype;
+  router_ = MessageRoutes::For(archetype);
 
-  const wchar_t *window_class =
-      WindowClassRegistrar::GetInstance()->GetWindowClass();
-
-  const POINT target_point = {static_cast<LONG>(origin.x),
-                              static_cast<LONG>(origin.y)};
-  HMONITOR monitor = MonitorFromPoint(target_point, MONITOR_DEFAULTTONEAREST);
-  UINT const dpi = FlutterDesktopGetDpiForMonitor(monitor);
-  auto const scale_factor = dpi / 96.0;
+  auto &backend{WindowBackend::instance()};
 
   // TODO(loicsharma): Hide the window until the first frame is rendered.
   DWORD window_style{WS_VISIBLE};
+  DWORD window_ex_style{0};
 
   switch (archetype) {
   case flw::Archetype::regular:
@@ -210,133 +336,356 @@ bool Win32Window::Create(const std::wstring &title, const Point &origin,
   case flw::Archetype::popup:
     if (auto *const parent_window{GetThisFromHandle(parent)}) {
       if (parent_window->child_content_ != nullptr) {
-        SetFocus(parent_window->child_content_);
+        backend.SetFocus(parent_window->child_content_);
       }
       parent_window->child_popups_.insert(this);
+      owner_ = parent_window;
     }
     window_style |= WS_POPUP;
     break;
+  case flw::Archetype::tip:
+    // Tips never take activation or focus, so showing one leaves the popups of
+    // the window under the cursor open. They are shown once created, as
+    // creating a visible window activates it.
+    window_style = WS_POPUP;
+    window_ex_style |= WS_EX_NOACTIVATE | WS_EX_TOOLWINDOW;
+    if (auto *const parent_window{GetThisFromHandle(parent)}) {
+      parent_window->tips_.insert(this);
+      owner_ = parent_window;
+    }
+    break;
+  case flw::Archetype::satellite:
+    if (auto *const parent_window{GetThisFromHandle(parent)}) {
+      parent_window->satellites_.insert(this);
+      owner_ = parent_window;
+    }
+    window_style |= WS_POPUP | WS_CAPTION | WS_SYSMENU | WS_THICKFRAME;
+    window_ex_style |= WS_EX_TOOLWINDOW;
+    break;
   // TODO: Handle the remaining archetypes
   default:
     std::unreachable();
   }
 
-  HWND window{CreateWindow(
-      window_class, title.c_str(), window_style, Scale(origin.x, scale_factor),
-      Scale(origin.y, scale_factor), Scale(size.width, scale_factor),
-      Scale(size.height, scale_factor), parent, nullptr,
-      GetModuleHandle(nullptr), this)};
+  FLW_RECORD_WINDOW_CREATED(this, archetype, GetThisFromHandle(parent));
+
+  FLW_TRACE_SCOPE_NAMED(create_window, "CreateWindow");
+  HWND window{backend.CreateNativeWindow(this, title, window_style,
+                                         window_ex_style,
+                                         ScaledFrame(origin, size), parent)};
+  FLW_TRACE_SCOPE_END(create_window);
 
   if (!window) {
     return false;
   }
 
-  UpdateTheme(window);
-
-  return OnCreate();
-}
-
-// static
-LRESULT CALLBACK Win32Window::WndProc(HWND window, UINT message, WPARAM wparam,
-                                      LPARAM lparam) {
-  if (message == WM_NCCREATE) {
-    auto *window_struct = reinterpret_cast<CREATESTRUCT *>(lparam);
-    SetWindowLongPtr(window, GWLP_USERDATA,
-                     reinterpret_cast<LONG_PTR>(window_struct->lpCreateParams));
-
-    auto *that = static_cast<Win32Window *>(window_struct->lpCreateParams);
-    EnableFullDpiSupportIfAvailable(window);
-    EnableTransparentWindowBackground(window);
-    that->window_handle_ = window;
-  } else if (Win32Window *that = GetThisFromHandle(window)) {
-    return that->MessageHandler(window, message, wparam, lparam);
+  RefreshGeometry();
+  if (archetype_ == flw::Archetype::satellite) {
+    UpdateSatelliteOffset();
+  }
+  flw::WindowLayout::instance().Track(*this, GetThisFromHandle(parent), title);
+  backend.UpdateTheme(window);
+  if (owner_ == nullptr) {
+    backend.SetTimer(window, kVisibilityTimerId, kVisibilityPollInterval);
   }
 
-  return DefWindowProc(window, message, wparam, lparam);
+  if (!OnCreate()) {
+    return false;
+  }
+  if (archetype_ == flw::Archetype::tip) {
+    backend.SetVisible(window, true);
+  }
+  return true;
 }
 
 LRESULT
 Win32Window::MessageHandler(HWND hwnd, UINT message, WPARAM wparam,
                             LPARAM lparam) {
-  switch (message) {
-  case WM_DESTROY:
-    window_handle_ = nullptr;
-    Destroy();
-    if (quit_on_close_) {
-      PostQuitMessage(0);
+  if (message_filter_) {
+    if (auto const result{message_filter_(*this, hwnd, message, wparam,
+                                          lparam)}) {
+      return *result;
     }
-    return 0;
+  }
 
-  case WM_DPICHANGED: {
-    auto *newRectSize = reinterpret_cast<RECT *>(lparam);
-    LONG const newWidth = newRectSize->right - newRectSize->left;
-    LONG const newHeight = newRectSize->bottom - newRectSize->top;
+  ScopedMessageTimer const timer(static_cast<int>(archetype_), message,
+                                 MessageStats::Phase::handler);
+  if (router_) {
+    if (auto const result{router_(*this, hwnd, message, wparam, lparam)}) {
+      return *result;
+    }
+  }
 
-    SetWindowPos(hwnd, nullptr, newRectSize->left, newRectSize->top, newWidth,
-                 newHeight, SWP_NOZORDER | SWP_NOACTIVATE);
+  return WindowBackend::instance().DefaultWindowProc(window_handle_, message,
+                                                     wparam, lparam);
+}
 
-    return 0;
+bool Win32Window::DeferContentResize() {
+  if (!g_live_resize_options.enabled || !in_size_move_) {
+    return false;
   }
-  case WM_SIZE: {
-    RECT const rect = GetClientArea();
-    if (child_content_ != nullptr) {
-      // Size and position the child window.
-      MoveWindow(child_content_, rect.left, rect.top, rect.right - rect.left,
-                 rect.bottom - rect.top, TRUE);
+  if (std::chrono::steady_clock::now() - last_content_resize_ <
+      g_live_resize_options.interval) {
+    content_resize_pending_ = true;
+    return true;
+  }
+  return false;
+}
+
+void Win32Window::ResizeContent() {
+  auto &backend{WindowBackend::instance()};
+  auto rect{GetClientArea()};
+  if (auto const bucket{g_live_resize_options.bucket};
+      g_live_resize_options.enabled && in_size_move_ && bucket > 0) {
+    rect.right = (rect.right + bucket - 1) / bucket * bucket;
+    rect.bottom = (rect.bottom + bucket - 1) / bucket * bucket;
+  }
+
+  auto const current{backend.GetClientRect(child_content_)};
+  {
+    // Time the commits that reallocate the content's surface.
+    std::optional<ScopedMessageTimer> timer;
+    if (current.right != rect.right || current.bottom != rect.bottom) {
+      timer.emplace(static_cast<int>(archetype_), WM_SIZE,
+                    MessageStats::Phase::surface_resize);
     }
-    return 0;
+    // Size and position the child window.
+    SetContentFrame(rect);
   }
 
-  case WM_ACTIVATE:
-    if (wparam != WA_INACTIVE) {
-      if (archetype_ != flw::Archetype::popup) {
-        // If this window is not a popup and is being activated, close the
-        // popups anchored to other windows
-        for (auto const &[_, window] : FlutterWindowManager::instance().windows()) {
-          window->CloseChildPopups();
-        }
-      }
-      // Close child popups if this window is being activated
-      CloseChildPopups();
+  last_content_resize_ = std::chrono::steady_clock::now();
+  content_resize_pending_ = false;
+  if (!in_dpi_change_) {
+    OnContentResized();
+  }
+}
+
+void Win32Window::RefreshGeometry() {
+  auto &backend{WindowBackend::instance()};
+  geometry_ = {.frame = backend.GetWindowRect(window_handle_),
+               .client = backend.GetClientRect(window_handle_),
+               .extended_frame = backend.GetExtendedFrameBounds(window_handle_),
+               .monitor = backend.GetMonitorRect(window_handle_),
+               .work_area = backend.GetWorkArea(window_handle_),
+               .dpi = backend.GetDpiForWindow(window_handle_)};
+  flw::WindowLayout::instance().Update(*this);
+  flw::WindowPlacement::instance().Update(*this);
+}
+
+void Win32Window::UpdateGeometry(WINDOWPOS const &position) {
+  if ((position.flags & SWP_NOMOVE) && (position.flags & SWP_NOSIZE)) {
+    return;
+  }
+  if (in_dpi_change_) {
+    // The non-client area is being rescaled.
+    RefreshGeometry();
+    return;
+  }
+
+  auto const previous{geometry_.frame};
+  auto frame{previous};
+  if (!(position.flags & SWP_NOMOVE)) {
+    frame.left = position.x;
+    frame.top = position.y;
+  }
+  auto const width{(position.flags & SWP_NOSIZE)
+                       ? previous.right - previous.left
+                       : static_cast<LONG>(position.cx)};
+  auto const height{(position.flags & SWP_NOSIZE)
+                        ? previous.bottom - previous.top
+                        : static_cast<LONG>(position.cy)};
+  frame.right = frame.left + width;
+  frame.bottom = frame.top + height;
+
+  // The non-client area keeps its thickness, so the client and extended frame
+  // follow the frame.
+  auto const grow_x{width - (previous.right - previous.left)};
+  auto const grow_y{height - (previous.bottom - previous.top)};
+  geometry_.client.right = std::max(LONG{0}, geometry_.client.right + grow_x);
+  geometry_.client.bottom =
+      std::max(LONG{0}, geometry_.client.bottom + grow_y);
+  geometry_.extended_frame.left += frame.left - previous.left;
+  geometry_.extended_frame.top += frame.top - previous.top;
+  geometry_.extended_frame.right += frame.right - previous.right;
+  geometry_.extended_frame.bottom += frame.bottom - previous.bottom;
+  geometry_.frame = frame;
+
+  // Only ask for the monitor once the window is centered on another one.
+  auto const center_x{(frame.left + frame.right) / 2};
+  auto const center_y{(frame.top + frame.bottom) / 2};
+  auto const &monitor{geometry_.monitor};
+  if (center_x < monitor.left || center_x >= monitor.right ||
+      center_y < monitor.top || center_y >= monitor.bottom) {
+    auto &backend{WindowBackend::instance()};
+    geometry_.monitor = backend.GetMonitorRect(window_handle_);
+    geometry_.work_area = backend.GetWorkArea(window_handle_);
+  }
+  flw::WindowLayout::instance().Update(*this);
+  flw::WindowPlacement::instance().Update(*this);
+}
+
+void Win32Window::CheckGeometry() const {
+  if (window_handle_ == nullptr) {
+    return;
+  }
+  auto &backend{WindowBackend::instance()};
+  auto const check{[this](char const *name, RECT const &cached,
+                          RECT const &actual) {
+    if (cached.left != actual.left || cached.top != actual.top ||
+        cached.right != actual.right || cached.bottom != actual.bottom) {
+      std::fprintf(stderr,
+                   "Stale %s of window %p: cached (%d, %d, %d, %d), "
+                   "actual (%d, %d, %d, %d)\n",
+                   name, static_cast<void *>(window_handle_),
+                   static_cast<int>(cached.left), static_cast<int>(cached.top),
+                   static_cast<int>(cached.right),
+                   static_cast<int>(cached.bottom),
+                   static_cast<int>(actual.left), static_cast<int>(actual.top),
+                   static_cast<int>(actual.right),
+                   static_cast<int>(actual.bottom));
     }
+  }};
+  check("frame", geometry_.frame, backend.GetWindowRect(window_handle_));
+  check("client", geometry_.client, backend.GetClientRect(window_handle_));
+  check("extended frame", geometry_.extended_frame,
+        backend.GetExtendedFrameBounds(window_handle_));
+  check("monitor", geometry_.monitor, backend.GetMonitorRect(window_handle_));
+  check("work area", geometry_.work_area, backend.GetWorkArea(window_handle_));
+  if (auto const dpi{backend.GetDpiForWindow(window_handle_)};
+      dpi != geometry_.dpi) {
+    std::fprintf(stderr, "Stale DPI of window %p: cached %u, actual %u\n",
+                 static_cast<void *>(window_handle_), geometry_.dpi, dpi);
+  }
+}
 
-    if (child_content_ != nullptr) {
-      SetFocus(child_content_);
+void Win32Window::UpdateSatelliteOffset() {
+  if (owner_ == nullptr) {
+    return;
+  }
+  auto const &frame{geometry_.frame};
+  auto const &parent_frame{owner_->geometry_.frame};
+  satellite_offset_ = {frame.left - parent_frame.left,
+                       frame.top - parent_frame.top};
+}
+
+void Win32Window::MoveSatellites(WINDOWPOS const &position) {
+  if (satellites_.empty() || (position.flags & SWP_NOMOVE) ||
+      position.x == kMinimizedPosition) {
+    return;
+  }
+  // Move every satellite in one batch while the window itself moves, so that
+  // none of them is drawn a frame behind.
+  GeometryTransaction transaction;
+  for (auto *const satellite : satellites_) {
+    auto const &frame{satellite->geometry_.frame};
+    auto const left{position.x + satellite->satellite_offset_.x};
+    auto const top{position.y + satellite->satellite_offset_.y};
+    transaction.SetFrame(satellite->window_handle_,
+                         RECT{left, top, left + (frame.right - frame.left),
+                              top + (frame.bottom - frame.top)});
+  }
+}
+
+void Win32Window::RecordSatelliteTrail() {
+  auto const &frame{geometry_.frame};
+  if (frame.left == kMinimizedPosition) {
+    return;
+  }
+  for (auto *const satellite : satellites_) {
+    auto const &satellite_frame{satellite->geometry_.frame};
+    auto const in_place{
+        satellite_frame.left == frame.left + satellite->satellite_offset_.x &&
+        satellite_frame.top == frame.top + satellite->satellite_offset_.y};
+    satellite->trailing_moves_ = in_place ? 0 : satellite->trailing_moves_ + 1;
+    MessageStats::instance().RecordSatelliteTrail(satellite->trailing_moves_);
+  }
+}
+
+void Win32Window::ProbeVisibility() {
+  visibility_.SetOccluded(true, std::chrono::steady_clock::now());
+  WindowBackend::instance().PostTask([handle = window_handle_] {
+    if (auto *const window{GetThisFromHandle(handle)}) {
+      window->UpdateOcclusion();
     }
-    return 0;
+  });
+}
 
-  case WM_NCACTIVATE:
-    if (wparam == FALSE && archetype_ != flw::Archetype::popup &&
-        !child_popups_.empty()) {
-      // If an inactive title bar is to be drawn, and this is a top-level window
-      // with popups, force the title bar to be drawn in its active colors
-      return TRUE;
+void Win32Window::UpdateOcclusion() {
+  if (owner_ != nullptr) {
+    auto *root{owner_};
+    while (root->owner_ != nullptr) {
+      root = root->owner_;
     }
-    break;
+    root->UpdateOcclusion();
+    return;
+  }
 
-  case WM_ACTIVATEAPP:
-    if (wparam == FALSE) {
-      // Close child popups if a window belonging to a different application is
-      // being activated
-      CloseChildPopups();
+  // Owned windows stay above their owner, so one Z-order walk answers for all
+  // of them: they are cloaked or minimized along with it, and can only be
+  // covered by what covers it if they lie within its frame. Those outside it
+  // are assumed uncovered.
+  auto const occlusion{
+      WindowBackend::instance().QueryOcclusion(window_handle_)};
+  auto const minimized{visibility_.visibility() ==
+                       flw::Visibility::minimized};
+  auto const frame{geometry_.extended_frame};
+  std::vector<HWND> owned;
+  CollectOwned(owned);
+  ApplyOcclusion(occlusion);
+  // Looked up again, as reporting a change may destroy windows.
+  for (auto *const handle : owned) {
+    auto *const window{GetThisFromHandle(handle)};
+    if (window == nullptr) {
+      continue;
     }
-    return 0;
+    auto const &bounds{window->geometry_.extended_frame};
+    auto const inside{bounds.left >= frame.left && bounds.top >= frame.top &&
+                      bounds.right <= frame.right &&
+                      bounds.bottom <= frame.bottom};
+    window->ApplyOcclusion(
+        {.cloaked = occlusion.cloaked,
+         .occluded = minimized || (occlusion.occluded && inside)});
+  }
+}
 
-  case WM_MOUSEACTIVATE:
+void Win32Window::ApplyOcclusion(WindowOcclusion const &occlusion) {
+  auto const now{std::chrono::steady_clock::now()};
+  auto changed{visibility_.SetCloaked(occlusion.cloaked, now)};
+  changed = visibility_.SetOccluded(occlusion.occluded, now) || changed;
+
+  if (visibility_.ShouldRestoreSurface()) {
+    visibility_.OnSurfaceRestored();
     if (child_content_ != nullptr) {
-      SetFocus(child_content_);
+      ResizeContent();
     }
-    return MA_ACTIVATE;
+  }
+  if (changed) {
+    OnVisibilityChanged(visibility_.visibility());
+  }
 
-  case WM_DWMCOLORIZATIONCOLORCHANGED:
-    UpdateTheme(hwnd);
-    return 0;
+  if (child_content_ != nullptr &&
+      visibility_.ShouldReleaseSurface(kHiddenSurfaceGracePeriod, now)) {
+    // An empty content window lets the engine drop the view's surface.
+    SetContentFrame(RECT{0, 0, 0, 0});
+    visibility_.OnSurfaceReleased();
+  }
+}
 
-  default:
-    break;
+void Win32Window::CollectOwned(std::vector<HWND> &handles) const {
+  for (auto const *const windows : {&child_popups_, &satellites_, &tips_}) {
+    for (auto const *const window : *windows) {
+      handles.push_back(window->window_handle_);
+      window->CollectOwned(handles);
+    }
   }
+}
 
-  return DefWindowProc(window_handle_, message, wparam, lparam);
+void Win32Window::DetachFromOwner() {
+  if (auto *const owner{std::exchange(owner_, nullptr)}) {
+    owner->child_popups_.erase(this);
+    owner->satellites_.erase(this);
+    owner->tips_.erase(this);
+  }
 }
 
 void Win32Window::CloseChildPopups() {
@@ -351,42 +700,113 @@ void Win32Window::CloseChildPopups() {
 
 void Win32Window::Destroy() {
   OnDestroy();
+  flw::WindowLayout::instance().Forget(*this);
+  flw::WindowPlacement::instance().Forget(*this);
 
   if (window_handle_) {
-    DestroyWindow(window_handle_);
+    WindowBackend::instance().DestroyNativeWindow(window_handle_);
     window_handle_ = nullptr;
   }
+  // The system destroys owned windows first, so any left are not destroyed
+  // yet and must not reach back to this one.
+  for (auto *const window : child_popups_) {
+    window->owner_ = nullptr;
+  }
+  child_popups_.clear();
+  for (auto *const window : satellites_) {
+    window->owner_ = nullptr;
+  }
+  satellites_.clear();
+  for (auto *const window : tips_) {
+    window->owner_ = nullptr;
+  }
+  tips_.clear();
   if (g_active_window_count == 0) {
-    WindowClassRegistrar::GetInstance()->UnregisterWindowClass();
+    WindowBackend::instance().OnLastWindowDestroyed();
   }
 }
 
 Win32Window *Win32Window::GetThisFromHandle(HWND window) noexcept {
-  return reinterpret_cast<Win32Window *>(
-      GetWindowLongPtr(window, GWLP_USERDATA));
+  return WindowBackend::instance().GetWindowFromHandle(window);
 }
 
 void Win32Window::SetChildContent(HWND content) {
+  auto &backend{WindowBackend::instance()};
   child_content_ = content;
-  SetParent(content, window_handle_);
-  RECT const frame = GetClientArea();
+  backend.SetParent(content, window_handle_);
+  SetContentFrame(GetClientArea());
+
+  if (archetype_ != flw::Archetype::tip) {
+    backend.SetFocus(child_content_);
+  }
+}
+
+void Win32Window::Hide() {
+  ScopedMessageTimer const timer(static_cast<int>(archetype_), WM_SHOWWINDOW,
+                                 MessageStats::Phase::hide);
+  auto &backend{WindowBackend::instance()};
+  backend.SetVisible(window_handle_, false);
+  backend.KillTimer(window_handle_, kVisibilityTimerId);
+  // Detach from the owner, whose destruction would otherwise take the hidden
+  // window with it.
+  backend.SetOwner(window_handle_, nullptr);
+  DetachFromOwner();
+  if (child_content_ != nullptr && !visibility_.surface_released()) {
+    SetContentFrame(RECT{0, 0, 0, 0});
+    visibility_.OnSurfaceReleased();
+  }
+}
+
+void Win32Window::ShowAt(const Point &origin, const Size &size, HWND parent) {
+  ScopedMessageTimer const timer(static_cast<int>(archetype_), WM_SHOWWINDOW,
+                                 MessageStats::Phase::show);
+  auto &backend{WindowBackend::instance()};
+  backend.SetOwner(window_handle_, parent);
+  {
+    // The WM_SIZE sent by the commit restores the content if the size changed.
+    GeometryTransaction transaction;
+    transaction.SetFrame(window_handle_, ScaledFrame(origin, size));
+  }
+  if (child_content_ != nullptr && visibility_.surface_released()) {
+    visibility_.OnSurfaceRestored();
+    ResizeContent();
+  }
+  backend.SetVisible(window_handle_, true);
+  if (auto *const parent_window{GetThisFromHandle(parent)}) {
+    parent_window->tips_.insert(this);
+    owner_ = parent_window;
+  } else {
+    backend.SetTimer(window_handle_, kVisibilityTimerId,
+                     kVisibilityPollInterval);
+  }
+}
 
-  MoveWindow(content, frame.left, frame.top, frame.right - frame.left,
-             frame.bottom - frame.top, true);
+void Win32Window::MoveTo(const Point &origin, const Size &size) {
+  GeometryTransaction transaction;
+  transaction.SetFrame(window_handle_, ScaledFrame(origin, size));
+}
 
-  SetFocus(child_content_);
+void Win32Window::SetContentFrame(RECT const &frame) {
+  GeometryTransaction transaction;
+  transaction.SetFrame(child_content_, frame);
+  transaction.Commit();
+  memory_->SetSurfaceSize(frame.right - frame.left, frame.bottom - frame.top);
 }
 
-RECT Win32Window::GetClientArea() {
-  RECT frame;
-  GetClientRect(window_handle_, &frame);
-  return frame;
+RECT Win32Window::GetClientArea() { return geometry().client; }
+
+auto Win32Window::geometry() const -> Geometry const & {
+#if defined(FLW_CHECK_GEOMETRY_CACHE)
+  CheckGeometry();
+#endif
+  return geometry_;
 }
 
 HWND Win32Window::GetHandle() { return window_handle_; }
 
 void Win32Window::SetQuitOnClose(bool quit_on_close) {
   quit_on_close_ = quit_on_close;
+  flw::WindowLayout::instance().Update(*this);
 }
 
 auto Win32Window::GetQuitOnClose() const -> bool { return quit_on_close_; }
@@ -396,10 +816,12 @@ bool Win32Window::OnCreate() {
   return true;
 }
 
-void Win32Window::OnDestroy() {
-  if (archetype_ == flw::Archetype::popup) {
-    if (auto *const parent_window{GetParent(window_handle_)}) {
-      GetThisFromHandle(parent_window)->child_popups_.erase(this);
-    }
-  }
-}
\ No newline at end of file
+void Win32Window::OnContentResized() {
+  // No-op; provided for subclasses.
+}
+
+void Win32Window::OnVisibilityChanged(flw::Visibility) {
+  // No-op; provided for subclasses.
+}
+
+void Win32Window::OnDestroy() { DetachFromOwner(); }
\ No newline at end of file
@@ -1,22 +1,31 @@
 #ifndef RUNNER_WIN32_WINDOW_H_
 #define RUNNER_WIN32_WINDOW_H_
 
-#include <windows.h>
-
+#include "memory_accounting.h"
+#include "message_routes.h"
+#include "platform_window_types.h"
+#include "window_visibility.h"
 #include "windowing_types.h"
 
+#include <chrono>
 #include <set>
+#include <span>
 #include <string>
+#include <vector>
+
+struct WindowOcclusion;
 
 // A class abstraction for a high DPI-aware Win32 Window. Intended to be
 // inherited from by classes that wish to specialize with custom
 // rendering and input handling
 class Win32Window {
 public:
+  // Signed, as monitors left of or above the primary one have negative
+  // coordinates.
   struct Point {
-    unsigned int x;
-    unsigned int y;
-    Point(unsigned int x, unsigned int y) : x(x), y(y) {}
+    int x;
+    int y;
+    Point(int x, int y) : x(x), y(y) {}
   };
 
   struct Size {
@@ -26,9 +35,38 @@ public:
         : width(width), height(height) {}
   };
 
+  // Controls how the hosted content follows interactive resizes, between
+  // WM_ENTERSIZEMOVE and WM_EXITSIZEMOVE. When |enabled|, the content is
+  // resized at most once per |interval| and, if |bucket| is non-zero, to the
+  // client size rounded up to a multiple of |bucket| physical pixels. The
+  // content always gets the exact client size when the resize ends.
+  struct LiveResizeOptions {
+    bool enabled = false;
+    std::chrono::milliseconds interval{0};
+    int bucket = 0;
+  };
+
+  // The geometry of the window, in physical pixels.
+  struct Geometry {
+    RECT frame;
+    RECT client;
+    // The frame as drawn by DWM, without the invisible resize borders.
+    RECT extended_frame;
+    // The bounds of the monitor the window is on.
+    RECT monitor;
+    // The work area of that monitor, without the taskbar and docked app bars.
+    RECT work_area;
+    UINT dpi;
+
+    auto device_pixel_ratio() const -> double { return dpi / 96.0; }
+  };
+
   Win32Window();
   virtual ~Win32Window();
 
+  // Sets the live-resize options of all windows.
+  static void SetLiveResizeOptions(LiveResizeOptions const &options);
+
   // Creates a win32 window with |title| that is positioned and sized using
   // |origin| and |size|. New windows are created on the default monitor. Window
   // sizes are specified to the OS in physical pixels, hence to ensure a
@@ -44,6 +82,17 @@ public:
   // Inserts |content| into the window tree.
   void SetChildContent(HWND content);
 
+  // Hides the window and releases its content's surface, keeping both for
+  // ShowAt.
+  void Hide();
+
+  // Shows the window hidden by Hide again, at |origin| with |size| and owned by
+  // |parent|, without activating it.
+  void ShowAt(const Point &origin, const Size &size, HWND parent);
+
+  // Moves and resizes the window to |origin| and |size|, scaled like Create.
+  void MoveTo(const Point &origin, const Size &size);
+
   // Returns the backing Window handle to enable clients to set icon and other
   // window properties. Returns nullptr if the window has been destroyed.
   HWND GetHandle();
@@ -55,12 +104,38 @@ public:
   // Return a RECT representing the bounds of the current client area.
   RECT GetClientArea();
 
+  // Returns the geometry of the window. It is cached from the window's own
+  // messages, so reading it makes no system call. With
+  // FLW_CHECK_GEOMETRY_CACHE defined, every read is checked against the OS and
+  // mismatches are printed to stderr.
+  auto geometry() const -> Geometry const &;
+
+  auto archetype() const -> flw::Archetype { return archetype_; }
+  auto visibility_tracker() const -> flw::VisibilityTracker const & {
+    return visibility_;
+  }
+
+  // Returns the memory charged to this window.
+  auto memory() const -> flw::memory::MemoryCounters const & {
+    return *memory_;
+  }
+
 protected:
-  // Processes and route salient window messages for mouse handling,
-  // size change and DPI. Delegates handling of these to member overloads that
-  // inheriting classes can handle.
-  virtual LRESULT MessageHandler(HWND hwnd, UINT message, WPARAM wparam,
-                                 LPARAM lparam);
+  // The counters that allocations made while creating this window's view are
+  // charged to.
+  auto memory_counters() const -> flw::memory::MemoryCounters * {
+    return memory_;
+  }
+
+  // Offers a window message to the window's content before the routes of its
+  // archetype, as the plugins of a Flutter view must see every message.
+  // Returns the result if the content handled the message.
+  using MessageFilter = auto (*)(Win32Window &window, HWND hwnd, UINT message,
+                                 WPARAM wparam, LPARAM lparam)
+      -> std::optional<LRESULT>;
+
+  // Sets the filter of the window's messages.
+  void SetMessageFilter(MessageFilter filter) { message_filter_ = filter; }
 
   // Called when CreateAndShow is called, allowing subclass window-related
   // setup. Subclasses should return false if setup fails.
@@ -69,19 +144,42 @@ protected:
   // Called when Destroy is called.
   virtual void OnDestroy();
 
+  // Called when the hosted content has been sized to follow a resize of the
+  // window, or once per DPI change. Not called for the sizes skipped during a
+  // live resize.
+  virtual void OnContentResized();
+
+  // Called when the window becomes visible, or hidden by being minimized,
+  // cloaked or fully occluded.
+  virtual void OnVisibilityChanged(flw::Visibility visibility);
+
+  // Counts the window as occluded and queries its occlusion once the windows
+  // being created alongside it are in place, so that OnVisibilityChanged
+  // reports it visible as soon as it is.
+  void ProbeVisibility();
+
   flw::Archetype archetype_{flw::Archetype::regular};
   std::set<Win32Window *> child_popups_;
+  std::set<Win32Window *> satellites_;
+  std::set<Win32Window *> tips_;
+
+  // The window whose child_popups_, satellites_ or tips_ this one is in, if
+  // any. Kept rather than looked up from the handle, which is cleared before
+  // OnDestroy when the system destroys the window.
+  Win32Window *owner_ = nullptr;
 
 private:
-  friend class WindowClassRegistrar;
+  friend class WindowBackend;
 
-  // OS callback called by message pump. Handles the WM_NCCREATE message which
-  // is passed when the non-client area is being created and enables automatic
-  // non-client DPI scaling so that the non-client area automatically
-  // responds to changes in DPI. All other messages are handled by
-  // MessageHandler.
-  static LRESULT CALLBACK WndProc(HWND window, UINT message, WPARAM wparam,
-                                  LPARAM lparam);
+  // The message handlers of each archetype, see win32_window.cpp.
+  struct MessageRoutes;
+
+  // Processes and route salient window messages for mouse handling,
+  // size change and DPI. Messages go through the filter, then the router of
+  // the window's archetype, generated at compile time; messages it does not
+  // route go straight to DefWindowProc.
+  LRESULT MessageHandler(HWND hwnd, UINT message, WPARAM wparam,
+                         LPARAM lparam);
 
   // // Retrieves a class instance pointer for |window|
   static Win32Window *GetThisFromHandle(HWND window) noexcept;
@@ -94,7 +192,83 @@ private:
   // window handle for hosted content.
   HWND child_content_ = nullptr;
 
+  // Whether the window is in an interactive move or resize.
+  bool in_size_move_ = false;
+
+  // Whether the window is applying the geometry of a DPI change.
+  bool in_dpi_change_ = false;
+
+  // Whether a content resize was skipped during the current live resize.
+  bool content_resize_pending_ = false;
+
+  std::chrono::steady_clock::time_point last_content_resize_;
+
+  // Routes the messages handled for the archetype.
+  flw::MessageRouter<Win32Window> router_ = nullptr;
+
+  MessageFilter message_filter_ = nullptr;
+
+  flw::VisibilityTracker visibility_;
+
+  flw::memory::MemoryCounters *const memory_;
+
+  Geometry geometry_{};
+
+  // The type of the last WM_SIZE, to tell maximize and minimize transitions.
+  WPARAM last_size_type_ = SIZE_RESTORED;
+
+  // For satellites, the offset of the frame from the parent's frame, in
+  // physical pixels.
+  POINT satellite_offset_{0, 0};
+
+  // For satellites, the number of consecutive parent moves that left the
+  // satellite out of place.
+  uint64_t trailing_moves_ = 0;
+
   void CloseChildPopups();
+
+  // Sets the frame of the hosted content and records the size of its surface.
+  void SetContentFrame(RECT const &frame);
+
+  // Returns whether the content resize for the current WM_SIZE should be
+  // skipped under the live-resize options.
+  bool DeferContentResize();
+
+  // Sizes the hosted content to the client area.
+  void ResizeContent();
+
+  // Reads the whole geometry of the window from the OS.
+  void RefreshGeometry();
+
+  // Updates the cached geometry for the window having moved to |position|.
+  void UpdateGeometry(WINDOWPOS const &position);
+
+  // Reports on stderr where the cached geometry differs from the OS.
+  void CheckGeometry() const;
+
+  // Records the offset of this satellite from its parent.
+  void UpdateSatelliteOffset();
+
+  // Moves the satellites along with this window, about to move to |position|.
+  void MoveSatellites(WINDOWPOS const &position);
+
+  // Records in MessageStats whether the satellites kept up with this window.
+  void RecordSatelliteTrail();
+
+  // Polls whether the window is cloaked or occluded, and releases or restores
+  // the content's surface accordingly. Only windows without an owner poll: an
+  // owned window updates its owner, which derives its state.
+  void UpdateOcclusion();
+
+  // Records |occlusion| as the window's own.
+  void ApplyOcclusion(WindowOcclusion const &occlusion);
+
+  // Appends the handles of the windows this one owns, and of those they own,
+  // to |handles|.
+  void CollectOwned(std::vector<HWND> &handles) const;
+
+  // Removes the window from its owner's child_popups_, satellites_ or tips_.
+  void DetachFromOwner();
 };
 
 #endif // RUNNER_WIN32_WINDOW_H_
@@ -0,0 +1,375 @@
+#include "win32_window_backend.h"
+
+#include <dwmapi.h>
+#include <flutter_windows.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "resource.h"
+#include "system_settings.h"
+#include "win32_window.h"
+
+namespace {
+
+constexpr const wchar_t kWindowClassName[] = L"FLUTTER_RUNNER_WIN32_WINDOW";
+constexpr const wchar_t kTaskWindowClassName[] = L"FLUTTER_RUNNER_TASK_WINDOW";
+
+// Carries a PostTask task, as a heap-allocated std::function in LPARAM.
+constexpr UINT kRunTaskMessage = WM_APP;
+
+} // namespace
+
+// Manages the Win32Window's window class registration.
+class WindowClassRegistrar {
+public:
+  ~WindowClassRegistrar() = default;
+
+  // Returns the singleton registrar instance.
+  static WindowClassRegistrar *GetInstance() {
+    if (!instance_) {
+      instance_ = new WindowClassRegistrar();
+    }
+    return instance_;
+  }
+
+  // Returns the name of the window class, registering the class if it hasn't
+  // previously been registered.
+  const wchar_t *GetWindowClass();
+
+  // Unregisters the window class. Should only be called if there are no
+  // instances of the window.
+  void UnregisterWindowClass();
+
+private:
+  WindowClassRegistrar() = default;
+
+  static WindowClassRegistrar *instance_;
+
+  bool class_registered_ = false;
+};
+
+WindowClassRegistrar *WindowClassRegistrar::instance_ = nullptr;
+
+const wchar_t *WindowClassRegistrar::GetWindowClass() {
+  if (!class_registered_) {
+    WNDCLASS window_class{};
+    window_class.hCursor = LoadCursor(nullptr, IDC_ARROW);
+    window_class.lpszClassName = kWindowClassName;
+    window_class.style = CS_HREDRAW | CS_VREDRAW;
+    window_class.cbClsExtra = 0;
+    window_class.cbWndExtra = 0;
+    window_class.hInstance = GetModuleHandle(nullptr);
+    window_class.hIcon =
+        LoadIcon(window_class.hInstance, MAKEINTRESOURCE(IDI_APP_ICON));
+    window_class.hbrBackground = 0;
+    window_class.lpszMenuName = nullptr;
+    window_class.lpfnWndProc = Win32WindowBackend::WndProc;
+    RegisterClass(&window_class);
+    class_registered_ = true;
+  }
+  return kWindowClassName;
+}
+
+void WindowClassRegistrar::UnregisterWindowClass() {
+  UnregisterClass(kWindowClassName, nullptr);
+  class_registered_ = false;
+}
+
+Win32WindowBackend::Win32WindowBackend() {
+  WNDCLASS window_class{};
+  window_class.lpszClassName = kTaskWindowClassName;
+  window_class.hInstance = GetModuleHandle(nullptr);
+  window_class.lpfnWndProc = Win32WindowBackend::TaskWndProc;
+  RegisterClass(&window_class);
+  task_window_ = CreateWindow(kTaskWindowClassName, L"", 0, 0, 0, 0, 0,
+                              HWND_MESSAGE, nullptr, GetModuleHandle(nullptr),
+                              nullptr);
+}
+
+Win32WindowBackend::~Win32WindowBackend() {
+  if (task_window_) {
+    DestroyWindow(task_window_);
+  }
+  UnregisterClass(kTaskWindowClassName, nullptr);
+}
+
+HWND Win32WindowBackend::CreateNativeWindow(Win32Window *owner,
+                                            std::wstring const &title,
+                                            DWORD style, DWORD ex_style,
+                                            RECT const &frame, HWND parent) {
+  const wchar_t *window_class =
+      WindowClassRegistrar::GetInstance()->GetWindowClass();
+  return CreateWindowEx(ex_style, window_class, title.c_str(), style,
+                        frame.left, frame.top, frame.right - frame.left,
+                        frame.bottom - frame.top, parent, nullptr,
+                        GetModuleHandle(nullptr), owner);
+}
+
+void Win32WindowBackend::DestroyNativeWindow(HWND window) {
+  DestroyWindow(window);
+}
+
+void Win32WindowBackend::OnLastWindowDestroyed() {
+  WindowClassRegistrar::GetInstance()->UnregisterWindowClass();
+}
+
+Win32Window *Win32WindowBackend::GetWindowFromHandle(HWND window) {
+  return reinterpret_cast<Win32Window *>(
+      GetWindowLongPtr(window, GWLP_USERDATA));
+}
+
+HWND Win32WindowBackend::GetParentHandle(HWND window) {
+  return GetParent(window);
+}
+
+void Win32WindowBackend::SetParent(HWND child, HWND parent) {
+  ::SetParent(child, parent);
+}
+
+void Win32WindowBackend::SetOwner(HWND window, HWND owner) {
+  SetWindowLongPtr(window, GWLP_HWNDPARENT, reinterpret_cast<LONG_PTR>(owner));
+}
+
+void Win32WindowBackend::SetVisible(HWND window, bool visible) {
+  ShowWindow(window, visible ? SW_SHOWNOACTIVATE : SW_HIDE);
+}
+
+void Win32WindowBackend::CommitGeometry(
+    std::span<GeometryChange const> changes) {
+  UINT const flags{SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOACTIVATE};
+
+  // Drop the changes that would leave a window in place, and group the others
+  // by parent, as a deferred-window-position batch can only hold siblings.
+  // Child windows go first so that hosted content already has its new size
+  // when the top-level window receives WM_SIZE.
+  struct Batch {
+    HWND parent;
+    std::vector<GeometryChange> changes;
+  };
+  std::vector<Batch> batches;
+  auto *const desktop{GetDesktopWindow()};
+  for (auto const &change : changes) {
+    RECT current{};
+    ::GetWindowRect(change.window, &current);
+    auto *const parent{GetAncestor(change.window, GA_PARENT)};
+    if (parent && parent != desktop) {
+      MapWindowPoints(nullptr, parent, reinterpret_cast<POINT *>(&current), 2);
+    }
+    if (EqualRect(&current, &change.frame)) {
+      continue;
+    }
+    auto it{std::ranges::find(batches, parent, &Batch::parent)};
+    if (it == batches.end()) {
+      it = batches.insert(parent == desktop ? batches.end() : batches.begin(),
+                          Batch{.parent = parent, .changes = {}});
+    }
+    it->changes.push_back(change);
+  }
+
+  for (auto const &batch : batches) {
+    HDWP positions{BeginDeferWindowPos(static_cast<int>(batch.changes.size()))};
+    for (auto const &[window, frame] : batch.changes) {
+      if (!positions) {
+        break;
+      }
+      positions = DeferWindowPos(positions, window, nullptr, frame.left,
+                                 frame.top, frame.right - frame.left,
+                                 frame.bottom - frame.top, flags);
+    }
+    if (positions) {
+      EndDeferWindowPos(positions);
+      continue;
+    }
+    // The batch could not be allocated; position the windows one by one.
+    for (auto const &[window, frame] : batch.changes) {
+      SetWindowPos(window, nullptr, frame.left, frame.top,
+                   frame.right - frame.left, frame.bottom - frame.top, flags);
+    }
+  }
+}
+
+RECT Win32WindowBackend::GetClientRectForFrame(HWND window, RECT const &frame,
+                                               UINT dpi) {
+  RECT borders{0, 0, 0, 0};
+  AdjustWindowRectExForDpi(
+      &borders, static_cast<DWORD>(GetWindowLongPtr(window, GWL_STYLE)), FALSE,
+      static_cast<DWORD>(GetWindowLongPtr(window, GWL_EXSTYLE)), dpi);
+  return {0, 0,
+          std::max(0L, (frame.right - frame.left) -
+                           (borders.right - borders.left)),
+          std::max(0L, (frame.bottom - frame.top) -
+                           (borders.bottom - borders.top))};
+}
+
+void Win32WindowBackend::SetFocus(HWND window) { ::SetFocus(window); }
+
+RECT Win32WindowBackend::GetClientRect(HWND window) {
+  RECT frame{};
+  ::GetClientRect(window, &frame);
+  return frame;
+}
+
+POINT Win32WindowBackend::GetClientOrigin(HWND window) {
+  POINT origin{0, 0};
+  ::ClientToScreen(window, &origin);
+  return origin;
+}
+
+RECT Win32WindowBackend::GetWindowRect(HWND window) {
+  RECT frame{};
+  ::GetWindowRect(window, &frame);
+  return frame;
+}
+
+RECT Win32WindowBackend::GetExtendedFrameBounds(HWND window) {
+  RECT frame;
+  if (FAILED(DwmGetWindowAttribute(window, DWMWA_EXTENDED_FRAME_BOUNDS, &frame,
+                                   sizeof(frame)))) {
+    ::GetWindowRect(window, &frame);
+  }
+  return frame;
+}
+
+RECT Win32WindowBackend::GetMonitorRect(HWND window) {
+  auto *monitor{MonitorFromWindow(window, MONITOR_DEFAULTTONEAREST)};
+  MONITORINFO mi;
+  mi.cbSize = sizeof(MONITORINFO);
+  return GetMonitorInfo(monitor, &mi) ? mi.rcMonitor : RECT{0, 0, 0, 0};
+}
+
+RECT Win32WindowBackend::GetWorkArea(HWND window) {
+  auto *monitor{MonitorFromWindow(window, MONITOR_DEFAULTTONEAREST)};
+  MONITORINFO mi;
+  mi.cbSize = sizeof(MONITORINFO);
+  return GetMonitorInfo(monitor, &mi) ? mi.rcWork : RECT{0, 0, 0, 0};
+}
+
+UINT Win32WindowBackend::GetDpiForWindow(HWND window) {
+  return FlutterDesktopGetDpiForHWND(window);
+}
+
+UINT Win32WindowBackend::GetDpiForPoint(POINT point) {
+  HMONITOR monitor = MonitorFromPoint(point, MONITOR_DEFAULTTONEAREST);
+  return SystemSettings::instance().GetDpiForMonitor(monitor);
+}
+
+WindowOcclusion Win32WindowBackend::QueryOcclusion(HWND window) {
+  auto const is_cloaked{[](HWND hwnd) {
+    DWORD cloaked{0};
+    return SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked,
+                                           sizeof(cloaked))) &&
+           cloaked != 0;
+  }};
+
+  WindowOcclusion occlusion{.cloaked = is_cloaked(window), .occluded = false};
+  if (occlusion.cloaked || !IsWindowVisible(window) || IsIconic(window)) {
+    return occlusion;
+  }
+
+  // Subtract the windows above |window| in the Z order from its bounds until
+  // nothing is left. Layered and transparent windows may let it show through,
+  // so they are not counted.
+  auto const frame{GetExtendedFrameBounds(window)};
+  auto *const remaining{CreateRectRgnIndirect(&frame)};
+  for (auto *above{::GetWindow(window, GW_HWNDPREV)}; above;
+       above = ::GetWindow(above, GW_HWNDPREV)) {
+    if (!IsWindowVisible(above) || IsIconic(above) || is_cloaked(above) ||
+        (GetWindowLongPtr(above, GWL_EXSTYLE) &
+         (WS_EX_LAYERED | WS_EX_TRANSPARENT))) {
+      continue;
+    }
+    auto const bounds{GetExtendedFrameBounds(above)};
+    auto *const covered{CreateRectRgnIndirect(&bounds)};
+    auto const region_kind{
+        CombineRgn(remaining, remaining, covered, RGN_DIFF)};
+    DeleteObject(covered);
+    if (region_kind == NULLREGION) {
+      occlusion.occluded = true;
+      break;
+    }
+  }
+  DeleteObject(remaining);
+  return occlusion;
+}
+
+void Win32WindowBackend::SetTimer(HWND window, uintptr_t id,
+                                  std::chrono::milliseconds interval) {
+  ::SetTimer(window, id, static_cast<UINT>(interval.count()), nullptr);
+}
+
+void Win32WindowBackend::KillTimer(HWND window, uintptr_t id) {
+  ::KillTimer(window, id);
+}
+
+void Win32WindowBackend::UpdateTheme(HWND window) {
+  SystemSettings::instance().ApplyTheme(window);
+}
+
+LRESULT Win32WindowBackend::SendWindowMessage(HWND window, UINT message,
+                                              WPARAM wparam, LPARAM lparam) {
+  return SendMessage(window, message, wparam, lparam);
+}
+
+LRESULT Win32WindowBackend::DefaultWindowProc(HWND window, UINT message,
+                                              WPARAM wparam, LPARAM lparam) {
+  return DefWindowProc(window, message, wparam, lparam);
+}
+
+void Win32WindowBackend::PostQuit(int exit_code) { PostQuitMessage(exit_code); }
+
+bool Win32WindowBackend::PostTask(std::function<void()> task) {
+  auto *const posted{new std::function<void()>(std::move(task))};
+  if (!PostMessage(task_window_, kRunTaskMessage, 0,
+                   reinterpret_cast<LPARAM>(posted))) {
+    delete posted;
+    return false;
+  }
+  return true;
+}
+
+// static
+LRESULT CALLBACK Win32WindowBackend::TaskWndProc(HWND window, UINT message,
+                                                 WPARAM wparam,
+                                                 LPARAM lparam) {
+  if (message == kRunTaskMessage) {
+    std::unique_ptr<std::function<void()>> const task{
+        reinterpret_cast<std::function<void()> *>(lparam)};
+    (*task)();
+    return 0;
+  }
+  return DefWindowProc(window, message, wparam, lparam);
+}
+
+// static
+LRESULT CALLBACK Win32WindowBackend::WndProc(HWND window, UINT message,
+                                             WPARAM wparam, LPARAM lparam) {
+  if (message == WM_NCCREATE) {
+    auto *window_struct = reinterpret_cast<CREATESTRUCT *>(lparam);
+    SetWindowLongPtr(window, GWLP_USERDATA,
+                     reinterpret_cast<LONG_PTR>(window_struct->lpCreateParams));
+
+    auto *that = static_cast<Win32Window *>(window_struct->lpCreateParams);
+    SystemSettings::instance().AttachWindow(window);
+    AttachHandle(that, window);
+  } else if (auto *const that{reinterpret_cast<Win32Window *>(
+                 GetWindowLongPtr(window, GWLP_USERDATA))}) {
+    switch (message) {
+    case WM_SETTINGCHANGE:
+    case WM_DWMCOLORIZATIONCOLORCHANGED:
+    case WM_DISPLAYCHANGE:
+    case WM_DPICHANGED:
+      SystemSettings::instance().OnSettingChange(window, message);
+      break;
+    case WM_NCDESTROY:
+      SystemSettings::instance().DetachWindow(window);
+      break;
+    default:
+      break;
+    }
+    return Dispatch(that, window, message, wparam, lparam);
+  }
+
+  return DefWindowProc(window, message, wparam, lparam);
+}
@@ -0,0 +1,70 @@
+#ifndef RUNNER_WIN32_WINDOW_BACKEND_H_
+#define RUNNER_WIN32_WINDOW_BACKEND_H_
+
+#include <windows.h>
+
+#include "window_backend.h"
+
+// WindowBackend implementation backed by the Win32 desktop.
+class Win32WindowBackend : public WindowBackend {
+public:
+  Win32WindowBackend();
+  ~Win32WindowBackend() override;
+
+  // WindowBackend:
+  HWND CreateNativeWindow(Win32Window *owner, std::wstring const &title,
+                          DWORD style, DWORD ex_style, RECT const &frame,
+                          HWND parent) override;
+  void DestroyNativeWindow(HWND window) override;
+  void OnLastWindowDestroyed() override;
+  Win32Window *GetWindowFromHandle(HWND window) override;
+  HWND GetParentHandle(HWND window) override;
+  void SetParent(HWND child, HWND parent) override;
+  void SetOwner(HWND window, HWND owner) override;
+  void SetVisible(HWND window, bool visible) override;
+  void CommitGeometry(std::span<GeometryChange const> changes) override;
+  RECT GetClientRectForFrame(HWND window, RECT const &frame,
+                             UINT dpi) override;
+  void SetFocus(HWND window) override;
+  RECT GetClientRect(HWND window) override;
+  POINT GetClientOrigin(HWND window) override;
+  RECT GetWindowRect(HWND window) override;
+  RECT GetExtendedFrameBounds(HWND window) override;
+  RECT GetMonitorRect(HWND window) override;
+  RECT GetWorkArea(HWND window) override;
+  UINT GetDpiForWindow(HWND window) override;
+  UINT GetDpiForPoint(POINT point) override;
+  WindowOcclusion QueryOcclusion(HWND window) override;
+  void SetTimer(HWND window, uintptr_t id,
+                std::chrono::milliseconds interval) override;
+  void KillTimer(HWND window, uintptr_t id) override;
+  void UpdateTheme(HWND window) override;
+  LRESULT SendWindowMessage(HWND window, UINT message, WPARAM wparam,
+                            LPARAM lparam) override;
+  LRESULT DefaultWindowProc(HWND window, UINT message, WPARAM wparam,
+                            LPARAM lparam) override;
+  void PostQuit(int exit_code) override;
+  bool PostTask(std::function<void()> task) override;
+
+private:
+  friend class WindowClassRegistrar;
+
+  // OS callback called by message pump. Handles the WM_NCCREATE message which
+  // is passed when the non-client area is being created and enables automatic
+  // non-client DPI scaling so that the non-client area automatically
+  // responds to changes in DPI. Forwards system setting changes to
+  // SystemSettings. All other messages are handled by
+  // Win32Window::MessageHandler.
+  static LRESULT CALLBACK WndProc(HWND window, UINT message, WPARAM wparam,
+                                  LPARAM lparam);
+
+  // Runs the tasks posted to the message-only task window.
+  static LRESULT CALLBACK TaskWndProc(HWND window, UINT message, WPARAM wparam,
+                                      LPARAM lparam);
+
+  // Message-only window owned by the platform thread, receiving PostTask's
+  // tasks. Unlike thread messages, its messages still run in modal loops.
+  HWND task_window_ = nullptr;
+};
+
+#endif // RUNNER_WIN32_WINDOW_BACKEND_H_
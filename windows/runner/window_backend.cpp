@@ -0,0 +1,52 @@
+#include "window_backend.h"
+
+#include "message_replay.h"
+#include "message_stats.h"
+#include "win32_window.h"
+
+#if defined(_WIN32)
+#include "win32_window_backend.h"
+#else
+#include "headless_window_backend.h"
+#endif
+
+namespace {
+
+std::unique_ptr<WindowBackend> &BackendStorage() {
+  static std::unique_ptr<WindowBackend> backend;
+  return backend;
+}
+
+} // namespace
+
+// static
+WindowBackend &WindowBackend::instance() {
+  auto &backend{BackendStorage()};
+  if (!backend) {
+#if defined(_WIN32)
+    backend = std::make_unique<Win32WindowBackend>();
+#else
+    backend = std::make_unique<HeadlessWindowBackend>();
+#endif
+  }
+  return *backend;
+}
+
+// static
+void WindowBackend::SetInstance(std::unique_ptr<WindowBackend> backend) {
+  BackendStorage() = std::move(backend);
+}
+
+// static
+void WindowBackend::AttachHandle(Win32Window *window, HWND handle) {
+  window->window_handle_ = handle;
+}
+
+// static
+LRESULT WindowBackend::Dispatch(Win32Window *window, HWND handle, UINT message,
+                                WPARAM wparam, LPARAM lparam) {
+  FLW_RECORD_MESSAGE(window, message, wparam, lparam);
+  ScopedMessageTimer const timer(static_cast<int>(window->archetype_), message,
+                                 MessageStats::Phase::dispatch);
+  return window->MessageHandler(handle, message, wparam, lparam);
+}
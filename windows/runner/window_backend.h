@@ -0,0 +1,154 @@
+#ifndef RUNNER_WINDOW_BACKEND_H_
+#define RUNNER_WINDOW_BACKEND_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+
+#include "platform_window_types.h"
+
+class Win32Window;
+
+// A new frame for a window, in screen coordinates for top-level windows and in
+// client coordinates of the parent for child windows.
+struct GeometryChange {
+  HWND window;
+  RECT frame;
+};
+
+// Whether a top-level window is hidden from the user while not minimized.
+struct WindowOcclusion {
+  // Hidden by the system, for example because it is on another virtual
+  // desktop.
+  bool cloaked;
+  // Entirely covered by other windows.
+  bool occluded;
+};
+
+// The native windowing operations Win32Window, FlutterWindow and
+// FlutterWindowManager rely on. Win32WindowBackend talks to the desktop;
+// HeadlessWindowBackend keeps windows in memory so that the window-management
+// logic (lifecycle, popup bookkeeping, quit-on-close, event emission) runs
+// without a display.
+//
+// All geometry is in physical pixels, in screen coordinates unless noted.
+class WindowBackend {
+public:
+  virtual ~WindowBackend() = default;
+
+  // Returns the backend in use. Defaults to the Win32 backend on Windows.
+  static WindowBackend &instance();
+
+  // Replaces the backend in use. Must be called before any window is created.
+  static void SetInstance(std::unique_ptr<WindowBackend> backend);
+
+  // Creates the native window backing |owner|, with |parent| as its owner
+  // window. The backend must attach the new handle to |owner| through
+  // AttachHandle before delivering any message to it. Returns nullptr on
+  // failure.
+  virtual HWND CreateNativeWindow(Win32Window *owner, std::wstring const &title,
+                                  DWORD style, DWORD ex_style,
+                                  RECT const &frame, HWND parent) = 0;
+
+  // Destroys |window| and the windows it owns, delivering WM_DESTROY.
+  virtual void DestroyNativeWindow(HWND window) = 0;
+
+  // Called once the last Win32Window has been destroyed.
+  virtual void OnLastWindowDestroyed() = 0;
+
+  // Returns the Win32Window attached to |window|, or nullptr.
+  virtual Win32Window *GetWindowFromHandle(HWND window) = 0;
+
+  // Returns the owner or parent of |window|, or nullptr.
+  virtual HWND GetParentHandle(HWND window) = 0;
+
+  // Makes |parent| the parent of the child window |child|.
+  virtual void SetParent(HWND child, HWND parent) = 0;
+
+  // Makes |owner| the owner of the top-level window |window|.
+  virtual void SetOwner(HWND window, HWND owner) = 0;
+
+  // Shows or hides |window|. Showing never activates it.
+  virtual void SetVisible(HWND window, bool visible) = 0;
+
+  // Moves and resizes the windows in |changes| as one batch, without changing
+  // their Z order or activating them. Changes that leave a window's frame as it
+  // is are skipped. Size and move messages are delivered once every window of
+  // the batch is in place.
+  virtual void CommitGeometry(std::span<GeometryChange const> changes) = 0;
+
+  // Returns the client area, in client coordinates, |window| would have with
+  // |frame| as its bounds at |dpi|.
+  virtual RECT GetClientRectForFrame(HWND window, RECT const &frame,
+                                     UINT dpi) = 0;
+
+  virtual void SetFocus(HWND window) = 0;
+
+  // Returns the client area of |window|, in client coordinates.
+  virtual RECT GetClientRect(HWND window) = 0;
+
+  // Returns the screen position of the top-left corner of the client area of
+  // |window|.
+  virtual POINT GetClientOrigin(HWND window) = 0;
+
+  // Returns the bounds of |window| including its non-client area.
+  virtual RECT GetWindowRect(HWND window) = 0;
+
+  // Returns the visible bounds of |window|, excluding any invisible resize
+  // borders, falling back to GetWindowRect.
+  virtual RECT GetExtendedFrameBounds(HWND window) = 0;
+
+  // Returns the bounds of the monitor nearest to |window|.
+  virtual RECT GetMonitorRect(HWND window) = 0;
+
+  // Returns the work area of the monitor nearest to |window|, without the
+  // taskbar and docked app bars.
+  virtual RECT GetWorkArea(HWND window) = 0;
+
+  virtual UINT GetDpiForWindow(HWND window) = 0;
+
+  // Returns the DPI of the monitor nearest to |point|.
+  virtual UINT GetDpiForPoint(POINT point) = 0;
+
+  // Returns whether |window| is cloaked or fully occluded.
+  virtual WindowOcclusion QueryOcclusion(HWND window) = 0;
+
+  // Sends WM_TIMER with |id| as its WPARAM to |window| every |interval|, until
+  // KillTimer is called or the window is destroyed.
+  virtual void SetTimer(HWND window, uintptr_t id,
+                        std::chrono::milliseconds interval) = 0;
+  virtual void KillTimer(HWND window, uintptr_t id) = 0;
+
+  // Matches the window frame's theme to the system theme.
+  virtual void UpdateTheme(HWND window) = 0;
+
+  // Synchronously delivers |message| to |window|.
+  virtual LRESULT SendWindowMessage(HWND window, UINT message, WPARAM wparam,
+                                    LPARAM lparam) = 0;
+
+  // Default processing for messages Win32Window does not handle.
+  virtual LRESULT DefaultWindowProc(HWND window, UINT message, WPARAM wparam,
+                                    LPARAM lparam) = 0;
+
+  // Asks the message loop to exit with |exit_code|.
+  virtual void PostQuit(int exit_code) = 0;
+
+  // Runs |task| on the platform thread, from its message loop. May be called
+  // from any thread once the backend exists. Returns false if |task| could not
+  // be posted, for example because the message queue is full, in which case
+  // it never runs.
+  virtual bool PostTask(std::function<void()> task) = 0;
+
+protected:
+  // Associates |handle| with |window|, before any message is delivered.
+  static void AttachHandle(Win32Window *window, HWND handle);
+
+  // Delivers |message| to |window|'s message handler.
+  static LRESULT Dispatch(Win32Window *window, HWND handle, UINT message,
+                          WPARAM wparam, LPARAM lparam);
+};
+
+#endif // RUNNER_WINDOW_BACKEND_H_
@@ -0,0 +1,108 @@
+#include "window_command_queue.h"
+
+#include "window_backend.h"
+
+WindowCommandQueue &WindowCommandQueue::instance() {
+  static WindowCommandQueue instance;
+  return instance;
+}
+
+void WindowCommandQueue::AttachToCurrentThread() {
+  platform_thread_ = std::this_thread::get_id();
+}
+
+template <typename T>
+auto WindowCommandQueue::Post(std::move_only_function<T()> command)
+    -> std::future<T> {
+  std::promise<T> promise;
+  auto future{promise.get_future()};
+  Enqueue([command = std::move(command),
+           promise = std::move(promise)]() mutable {
+    promise.set_value(command());
+  });
+  return future;
+}
+
+void WindowCommandQueue::Enqueue(Command command) {
+  if (std::this_thread::get_id() == platform_thread_) {
+    RunPending();
+    command();
+    return;
+  }
+
+  // Wait for room if kCapacity commands are pending.
+  auto pending{pending_.load(std::memory_order_acquire)};
+  for (;;) {
+    if (pending >= kCapacity) {
+      pending_.wait(pending, std::memory_order_acquire);
+      pending = pending_.load(std::memory_order_acquire);
+    } else if (pending_.compare_exchange_weak(pending, pending + 1,
+                                              std::memory_order_acq_rel)) {
+      break;
+    }
+  }
+
+  commands_.Push(std::move(command));
+  if (!wake_posted_.exchange(true, std::memory_order_acq_rel) &&
+      !WindowBackend::instance().PostTask([this] { RunPending(); })) {
+    // The next command posts another wake-up, and the message loop runs the
+    // commands on its next turn meanwhile.
+    wake_stalled_.store(true, std::memory_order_release);
+    wake_posted_.store(false, std::memory_order_release);
+  }
+}
+
+auto WindowCommandQueue::CreateRegularWindow(std::wstring title,
+                                             Win32Window::Point origin,
+                                             Win32Window::Size size,
+                                             EngineId engine)
+    -> std::future<CreateResult> {
+  return Post<CreateResult>([title = std::move(title), origin, size, engine] {
+    return FlutterWindowManager::instance().createRegularWindow(title, origin,
+                                                                size, engine);
+  });
+}
+
+auto WindowCommandQueue::CreatePopupWindow(
+    std::wstring title, Win32Window::Point origin, Win32Window::Size size,
+    std::optional<flutter::FlutterViewId> parent_view_id)
+    -> std::future<CreateResult> {
+  return Post<CreateResult>(
+      [title = std::move(title), origin, size, parent_view_id] {
+        return FlutterWindowManager::instance().createPopupWindow(
+            title, origin, size, parent_view_id);
+      });
+}
+
+auto WindowCommandQueue::DestroyWindow(flutter::FlutterViewId view_id)
+    -> std::future<bool> {
+  return Post<bool>([view_id] {
+    return FlutterWindowManager::instance().destroyWindow(view_id, true);
+  });
+}
+
+auto WindowCommandQueue::MoveWindow(flutter::FlutterViewId view_id,
+                                    Win32Window::Point origin,
+                                    Win32Window::Size size)
+    -> std::future<bool> {
+  return Post<bool>([view_id, origin, size] {
+    return FlutterWindowManager::instance().moveWindow(view_id, origin, size);
+  });
+}
+
+void WindowCommandQueue::RunPending() {
+  // Commands queued after this point post a new wake-up. Reading the flag
+  // makes those queued before it visible to Pop.
+  wake_posted_.exchange(false, std::memory_order_acq_rel);
+  while (auto command{commands_.Pop()}) {
+    (*command)();
+    pending_.fetch_sub(1, std::memory_order_release);
+    pending_.notify_all();
+  }
+}
+
+void WindowCommandQueue::RunStalled() {
+  if (wake_stalled_.exchange(false, std::memory_order_acq_rel)) {
+    RunPending();
+  }
+}
@@ -0,0 +1,82 @@
+#ifndef RUNNER_WINDOW_COMMAND_QUEUE_H_
+#define RUNNER_WINDOW_COMMAND_QUEUE_H_
+
+#include <atomic>
+#include <expected>
+#include <functional>
+#include <future>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "event_queue.h"
+#include "flutter_window_manager.h"
+
+// Lets plugins and background services create, destroy and reposition windows
+// from any thread. Windows belong to the thread running the message loop, so
+// commands are queued and run there, in the order they were posted, and their
+// results are delivered through futures. The platform thread is woken once per
+// batch of commands rather than once per command.
+//
+// At most kCapacity commands may be pending: posting more blocks the posting
+// thread until the platform thread catches up. Commands posted on the platform
+// thread itself run at once, after the pending ones, so that it never waits on
+// itself.
+class WindowCommandQueue {
+public:
+  using CreateResult =
+      std::expected<flutter::FlutterViewId, FlutterWindowManager::Error>;
+
+  static constexpr size_t kCapacity{64};
+
+  WindowCommandQueue(WindowCommandQueue const &) = delete;
+  WindowCommandQueue &operator=(WindowCommandQueue const &) = delete;
+
+  static WindowCommandQueue &instance();
+
+  // Makes the calling thread the platform thread that runs the commands. Must
+  // be called before any command is posted.
+  void AttachToCurrentThread();
+
+  auto CreateRegularWindow(std::wstring title, Win32Window::Point origin,
+                           Win32Window::Size size, EngineId engine = 0)
+      -> std::future<CreateResult>;
+  auto CreatePopupWindow(std::wstring title, Win32Window::Point origin,
+                         Win32Window::Size size,
+                         std::optional<flutter::FlutterViewId> parent_view_id)
+      -> std::future<CreateResult>;
+  // The futures of DestroyWindow and MoveWindow hold false if there is no
+  // window |view_id| by the time the command runs.
+  auto DestroyWindow(flutter::FlutterViewId view_id) -> std::future<bool>;
+  auto MoveWindow(flutter::FlutterViewId view_id, Win32Window::Point origin,
+                  Win32Window::Size size) -> std::future<bool>;
+
+  // Runs the pending commands. Must be called on the platform thread.
+  void RunPending();
+  // Runs the pending commands if the wake-up for them could not be posted.
+  // Called by the message loop on every turn, on the platform thread.
+  void RunStalled();
+
+private:
+  using Command = std::move_only_function<void()>;
+
+  WindowCommandQueue() = default;
+
+  // Queues |command|, whose result is delivered through the returned future.
+  template <typename T>
+  auto Post(std::move_only_function<T()> command) -> std::future<T>;
+
+  void Enqueue(Command command);
+
+  std::thread::id platform_thread_;
+  flw::MpscQueue<Command> commands_;
+  // The number of commands posted and not yet run, bounded by kCapacity.
+  std::atomic<size_t> pending_{0};
+  // Whether a RunPending task has been posted to the platform thread and has
+  // not started yet.
+  std::atomic<bool> wake_posted_{false};
+  // Whether posting a RunPending task failed, leaving commands to RunStalled.
+  std::atomic<bool> wake_stalled_{false};
+};
+
+#endif // RUNNER_WINDOW_COMMAND_QUEUE_H_
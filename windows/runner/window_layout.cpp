@@ -0,0 +1,229 @@
+#include "window_layout.h"
+
+#include "text_encoding.h"
+#include "win32_window.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace flw {
+
+struct WindowLayout::Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t capacity;
+  uint32_t slot_size;
+};
+
+namespace {
+
+constexpr uint32_t kMagic{0x4C574C46}; // "FLWL"
+constexpr uint32_t kVersion{2};
+
+constexpr auto kFileSize{sizeof(uint32_t) * 4 +
+                         sizeof(SavedWindow) * WindowLayout::kCapacity};
+
+// Maps |path| read-write, |kFileSize| bytes long. The handles are closed
+// right away; the view keeps the file mapped until unmapped.
+auto MapFile(std::filesystem::path const &path) -> void * {
+#if defined(_WIN32)
+  auto const file{CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr)};
+  if (file == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
+  // Grows the file to the mapping's size if it is smaller.
+  auto const mapping{CreateFileMappingW(file, nullptr, PAGE_READWRITE, 0,
+                                        static_cast<DWORD>(kFileSize),
+                                        nullptr)};
+  CloseHandle(file);
+  if (!mapping) {
+    return nullptr;
+  }
+  auto *const view{
+      MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, kFileSize)};
+  CloseHandle(mapping);
+  return view;
+#else
+  auto const file{open(path.c_str(), O_RDWR | O_CREAT, 0644)};
+  if (file < 0) {
+    return nullptr;
+  }
+  if (ftruncate(file, kFileSize) != 0) {
+    close(file);
+    return nullptr;
+  }
+  auto *const view{
+      mmap(nullptr, kFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0)};
+  close(file);
+  return view != MAP_FAILED ? view : nullptr;
+#endif
+}
+
+void UnmapFile(void *view) {
+#if defined(_WIN32)
+  UnmapViewOfFile(view);
+#else
+  munmap(view, kFileSize);
+#endif
+}
+
+auto IsSaved(Archetype archetype) -> bool {
+  return archetype == Archetype::regular || archetype == Archetype::satellite;
+}
+
+auto ToRect(RECT const &rect) -> SavedWindow::Rect {
+  return {static_cast<int32_t>(rect.left), static_cast<int32_t>(rect.top),
+          static_cast<int32_t>(rect.right), static_cast<int32_t>(rect.bottom)};
+}
+
+} // namespace
+
+// static
+auto WindowLayout::instance() -> WindowLayout & {
+  static WindowLayout layout;
+  return layout;
+}
+
+WindowLayout::~WindowLayout() { Close(); }
+
+auto WindowLayout::Open(std::filesystem::path const &path) -> bool {
+  static_assert(sizeof(Header) == sizeof(uint32_t) * 4);
+  Close();
+  header_ = static_cast<Header *>(MapFile(path));
+  if (!header_) {
+    return false;
+  }
+  slots_ = reinterpret_cast<SavedWindow *>(header_ + 1);
+  if (header_->magic != kMagic || header_->version != kVersion ||
+      header_->capacity != kCapacity ||
+      header_->slot_size != sizeof(SavedWindow)) {
+    std::memset(static_cast<void *>(header_), 0, kFileSize);
+    *header_ = {.magic = kMagic,
+                .version = kVersion,
+                .capacity = kCapacity,
+                .slot_size = sizeof(SavedWindow)};
+  }
+  return true;
+}
+
+void WindowLayout::Close() {
+  if (header_) {
+    UnmapFile(header_);
+  }
+  header_ = nullptr;
+  slots_ = nullptr;
+  slot_of_.clear();
+}
+
+auto WindowLayout::TakeSaved() -> std::vector<SavedWindow> {
+  std::vector<SavedWindow> saved;
+  if (!slots_) {
+    return saved;
+  }
+  // The index in |saved| of each slot.
+  std::vector<int32_t> index(kCapacity, -1);
+  for (uint32_t slot{0}; slot < kCapacity; ++slot) {
+    if (slots_[slot].flags & SavedWindow::kInUse) {
+      index[slot] = static_cast<int32_t>(saved.size());
+      saved.push_back(slots_[slot]);
+      slots_[slot].flags = 0;
+    }
+  }
+  for (auto &window : saved) {
+    window.parent = window.parent >= 0 && window.parent < int32_t{kCapacity}
+                        ? index[window.parent]
+                        : -1;
+  }
+  return saved;
+}
+
+void WindowLayout::Track(Win32Window const &window, Win32Window const *parent,
+                         std::wstring const &title) {
+  if (!slots_ || frozen_ || !IsSaved(window.archetype())) {
+    return;
+  }
+  auto *const free{
+      std::ranges::find_if(slots_, slots_ + kCapacity, [](auto const &slot) {
+        return (slot.flags & SavedWindow::kInUse) == 0;
+      })};
+  if (free == slots_ + kCapacity) {
+    return;
+  }
+  auto const slot{static_cast<uint32_t>(free - slots_)};
+  auto const parent_it{slot_of_.find(parent)};
+
+  SavedWindow saved{
+      .flags = SavedWindow::kInUse,
+      .archetype = 0,
+      .engine = 0,
+      .parent = parent_it != slot_of_.end()
+                    ? static_cast<int32_t>(parent_it->second)
+                    : -1,
+      .dpi = 0,
+      .frame = {},
+      .monitor = {},
+      .title = {},
+  };
+  auto const utf8{text::Utf8FromWide(title).value_or(std::string{})};
+  auto length{std::min(utf8.size(), sizeof(saved.title) - 1)};
+  // Back off to the start of a code point.
+  while (length > 0 && length < utf8.size() &&
+         (static_cast<unsigned char>(utf8[length]) & 0xC0) == 0x80) {
+    --length;
+  }
+  std::memcpy(saved.title, utf8.data(), length);
+  *free = saved;
+
+  slot_of_[&window] = slot;
+  Update(window);
+}
+
+void WindowLayout::Update(Win32Window const &window) {
+  if (frozen_) {
+    return;
+  }
+  auto const it{slot_of_.find(&window)};
+  if (it == slot_of_.end() ||
+      window.visibility_tracker().visibility() == Visibility::minimized) {
+    return;
+  }
+  auto &saved{slots_[it->second]};
+  auto const &geometry{window.geometry()};
+  saved.archetype = static_cast<uint32_t>(window.archetype());
+  saved.dpi = geometry.dpi;
+  saved.frame = ToRect(geometry.frame);
+  saved.monitor = ToRect(geometry.monitor);
+  saved.flags = SavedWindow::kInUse;
+  if (window.GetQuitOnClose()) {
+    saved.flags |= SavedWindow::kQuitOnClose;
+  }
+}
+
+void WindowLayout::SetEngine(Win32Window const &window, uint32_t engine) {
+  if (frozen_) {
+    return;
+  }
+  if (auto const it{slot_of_.find(&window)}; it != slot_of_.end()) {
+    slots_[it->second].engine = engine;
+  }
+}
+
+void WindowLayout::Forget(Win32Window const &window) {
+  if (frozen_) {
+    return;
+  }
+  if (auto const it{slot_of_.find(&window)}; it != slot_of_.end()) {
+    slots_[it->second].flags = 0;
+    slot_of_.erase(it);
+  }
+}
+
+} // namespace flw
@@ -0,0 +1,97 @@
+#ifndef RUNNER_WINDOW_LAYOUT_H_
+#define RUNNER_WINDOW_LAYOUT_H_
+
+#include "windowing_types.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Win32Window;
+
+namespace flw {
+
+// A window saved in the layout file. Geometry is in physical pixels.
+struct SavedWindow {
+  enum Flags : uint32_t { kInUse = 1, kQuitOnClose = 2 };
+
+  struct Rect {
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+  };
+
+  uint32_t flags;
+  uint32_t archetype;
+  // The engine a regular window ran on. Satellites run on their parent's.
+  uint32_t engine;
+  // The saved window this one is owned by, or -1.
+  int32_t parent;
+  uint32_t dpi;
+  Rect frame;
+  // The work area of the monitor the window was on.
+  Rect monitor;
+  // The title in UTF-8, NUL-terminated and cut at a code point boundary.
+  char title[64];
+};
+
+// Saves the regular windows and satellites to a memory-mapped file, so that
+// the next launch recreates them where they were.
+//
+// The file is a versioned header followed by a fixed array of SavedWindow
+// slots. Each tracked window owns a slot that is rewritten in place whenever
+// its geometry changes, so saving is a few stores to mapped memory and
+// restoring reads the slots as they are, without parsing. Popups and tips
+// are transient and not saved. Only used on the platform thread.
+class WindowLayout {
+public:
+  static constexpr uint32_t kCapacity{256};
+
+  static auto instance() -> WindowLayout &;
+
+  ~WindowLayout();
+
+  // Maps the layout file at |path|, creating it, or clearing it if it was
+  // written by another version. Returns false if the file cannot be mapped,
+  // in which case nothing is saved.
+  auto Open(std::filesystem::path const &path) -> bool;
+
+  // Returns the windows saved by the previous run and frees their slots for
+  // the windows recreated from them. SavedWindow::parent indexes the result.
+  auto TakeSaved() -> std::vector<SavedWindow>;
+
+  // Starts saving |window|, owned by |parent| and titled |title|, if its
+  // archetype is saved.
+  void Track(Win32Window const &window, Win32Window const *parent,
+             std::wstring const &title);
+  // Saves the current geometry of |window|, if tracked.
+  void Update(Win32Window const &window);
+  // Saves the engine |window| runs on, if tracked.
+  void SetEngine(Win32Window const &window, uint32_t engine);
+  // Stops saving |window| and frees its slot.
+  void Forget(Win32Window const &window);
+
+  // Stops all further changes, so that the windows closed while the
+  // application quits stay saved.
+  void Freeze() { frozen_ = true; }
+
+private:
+  struct Header;
+
+  WindowLayout() = default;
+
+  void Close();
+
+  // The start of the mapped file, which holds no other handle open.
+  Header *header_{nullptr};
+  SavedWindow *slots_{nullptr};
+  std::unordered_map<Win32Window const *, uint32_t> slot_of_;
+  bool frozen_{false};
+};
+
+} // namespace flw
+
+#endif // RUNNER_WINDOW_LAYOUT_H_
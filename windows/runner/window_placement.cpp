@@ -0,0 +1,211 @@
+#include "window_placement.h"
+
+#include "win32_window.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace flw {
+
+namespace {
+
+constexpr int64_t kGrid{WindowPlacement::kGridSize};
+
+// The offset between cascaded windows, in logical pixels.
+constexpr LONG kCascadeStep{32};
+
+auto Intersect(RECT const &a, RECT const &b) -> RECT {
+  return {std::max(a.left, b.left), std::max(a.top, b.top),
+          std::min(a.right, b.right), std::min(a.bottom, b.bottom)};
+}
+
+auto IsEmpty(RECT const &rect) -> bool {
+  return rect.left >= rect.right || rect.top >= rect.bottom;
+}
+
+auto operator==(RECT const &a, RECT const &b) -> bool {
+  return a.left == b.left && a.top == b.top && a.right == b.right &&
+         a.bottom == b.bottom;
+}
+
+// Returns the first cell at or after the physical offset |offset| into an
+// extent of |extent| pixels, rounding down or up.
+auto CellFloor(int64_t offset, int64_t extent) -> LONG {
+  return static_cast<LONG>(offset * kGrid / extent);
+}
+auto CellCeil(int64_t offset, int64_t extent) -> LONG {
+  return static_cast<LONG>((offset * kGrid + extent - 1) / extent);
+}
+
+// Returns the physical offset of the start of |cell|, rounded up so that it
+// falls in |cell|.
+auto CellStart(int64_t cell, int64_t extent) -> LONG {
+  return static_cast<LONG>((cell * extent + kGrid - 1) / kGrid);
+}
+
+// Returns the cells of |work_area| that |frame| covers.
+auto CoveredCells(RECT const &work_area, RECT const &frame) -> RECT {
+  auto const visible{Intersect(work_area, frame)};
+  if (IsEmpty(visible)) {
+    return {0, 0, 0, 0};
+  }
+  int64_t const width{work_area.right - work_area.left};
+  int64_t const height{work_area.bottom - work_area.top};
+  return {CellFloor(visible.left - work_area.left, width),
+          CellFloor(visible.top - work_area.top, height),
+          CellCeil(visible.right - work_area.left, width),
+          CellCeil(visible.bottom - work_area.top, height)};
+}
+
+} // namespace
+
+// static
+auto WindowPlacement::instance() -> WindowPlacement & {
+  static WindowPlacement placement;
+  return placement;
+}
+
+void WindowPlacement::Update(Win32Window const &window) {
+  if (window.archetype() != Archetype::regular) {
+    return;
+  }
+  auto const &geometry{window.geometry()};
+  if (IsEmpty(geometry.work_area)) {
+    return;
+  }
+  Entry const entry{.monitor = FindMonitor(geometry.work_area),
+                    .cells = CoveredCells(geometry.work_area,
+                                          geometry.extended_frame)};
+  auto const [it, inserted]{entries_.try_emplace(&window, entry)};
+  if (!inserted) {
+    // Moves within a cell change nothing.
+    if (it->second.monitor == entry.monitor &&
+        it->second.cells == entry.cells) {
+      return;
+    }
+    Cover(it->second, -1);
+    it->second = entry;
+  }
+  Cover(entry, 1);
+}
+
+void WindowPlacement::Forget(Win32Window const &window) {
+  if (auto const it{entries_.find(&window)}; it != entries_.end()) {
+    Cover(it->second, -1);
+    entries_.erase(it);
+  }
+}
+
+auto WindowPlacement::Place(RECT const &work_area, UINT dpi, SIZE size,
+                            Placement placement) -> POINT {
+  auto &monitor{monitors_[FindMonitor(work_area)]};
+  POINT origin;
+  if (placement == Placement::cascade) {
+    origin = Cascade(monitor, dpi, size);
+  } else {
+    auto const [tiled, coverage]{Tile(monitor, size)};
+    origin = coverage == 0 || placement == Placement::tile
+                 ? tiled
+                 : Cascade(monitor, dpi, size);
+  }
+  monitor.last_placed = origin;
+  return origin;
+}
+
+auto WindowPlacement::FindMonitor(RECT const &work_area) -> size_t {
+  auto const it{std::ranges::find_if(monitors_, [&work_area](auto const &m) {
+    return m.work_area == work_area;
+  })};
+  if (it != monitors_.end()) {
+    return static_cast<size_t>(it - monitors_.begin());
+  }
+  monitors_.push_back({.work_area = work_area,
+                       .coverage = std::vector<uint16_t>(kGrid * kGrid),
+                       .last_placed = std::nullopt});
+  return monitors_.size() - 1;
+}
+
+void WindowPlacement::Cover(Entry const &entry, int delta) {
+  auto &coverage{monitors_[entry.monitor].coverage};
+  for (auto y{entry.cells.top}; y < entry.cells.bottom; ++y) {
+    for (auto x{entry.cells.left}; x < entry.cells.right; ++x) {
+      auto &cell{coverage[y * kGrid + x]};
+      cell = static_cast<uint16_t>(cell + delta);
+    }
+  }
+}
+
+// Returns the origin of the block of cells of |size| covered by the fewest
+// windows, the top-most then left-most of equals, and how many cover it.
+auto WindowPlacement::Tile(Monitor const &monitor, SIZE size) const
+    -> std::pair<POINT, uint32_t> {
+  auto const &area{monitor.work_area};
+  int64_t const width{area.right - area.left};
+  int64_t const height{area.bottom - area.top};
+  POINT const top_left{area.left, area.top};
+  if (size.cx > width || size.cy > height) {
+    return {top_left, std::numeric_limits<uint32_t>::max()};
+  }
+  auto const block_width{
+      std::clamp<int64_t>(CellCeil(size.cx, width), 1, kGrid)};
+  auto const block_height{
+      std::clamp<int64_t>(CellCeil(size.cy, height), 1, kGrid)};
+
+  // sums[y][x] holds the coverage of the cells above and left of (x, y).
+  constexpr auto kStride{kGrid + 1};
+  std::vector<uint32_t> sums(kStride * kStride);
+  for (int64_t y{0}; y < kGrid; ++y) {
+    uint32_t row{0};
+    for (int64_t x{0}; x < kGrid; ++x) {
+      row += monitor.coverage[y * kGrid + x];
+      sums[(y + 1) * kStride + x + 1] = sums[y * kStride + x + 1] + row;
+    }
+  }
+
+  auto best{std::numeric_limits<uint32_t>::max()};
+  int64_t best_x{0};
+  int64_t best_y{0};
+  for (int64_t y{0}; y + block_height <= kGrid && best > 0; ++y) {
+    for (int64_t x{0}; x + block_width <= kGrid; ++x) {
+      auto const bottom{y + block_height};
+      auto const right{x + block_width};
+      auto const covered{sums[bottom * kStride + right] -
+                         sums[y * kStride + right] -
+                         sums[bottom * kStride + x] + sums[y * kStride + x]};
+      if (covered < best) {
+        best = covered;
+        best_x = x;
+        best_y = y;
+        if (best == 0) {
+          break;
+        }
+      }
+    }
+  }
+
+  // Cells are rounded out, so the window fits in its block but may reach past
+  // the work area by a pixel.
+  POINT const origin{std::min<LONG>(area.left + CellStart(best_x, width),
+                                    area.right - size.cx),
+                     std::min<LONG>(area.top + CellStart(best_y, height),
+                                    area.bottom - size.cy)};
+  return {origin, best};
+}
+
+// Returns the origin one step down and right of the last window placed,
+// starting over from the top-left of the work area where it would not fit.
+auto WindowPlacement::Cascade(Monitor const &monitor, UINT dpi,
+                              SIZE size) const -> POINT {
+  auto const &area{monitor.work_area};
+  auto const step{static_cast<LONG>(kCascadeStep * dpi / 96)};
+  if (monitor.last_placed) {
+    POINT const next{monitor.last_placed->x + step,
+                     monitor.last_placed->y + step};
+    if (next.x + size.cx <= area.right && next.y + size.cy <= area.bottom) {
+      return next;
+    }
+  }
+  return {area.left, area.top};
+}
+
+} // namespace flw
@@ -0,0 +1,73 @@
+#ifndef RUNNER_WINDOW_PLACEMENT_H_
+#define RUNNER_WINDOW_PLACEMENT_H_
+
+#include "platform_window_types.h"
+#include "windowing_types.h"
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Win32Window;
+
+namespace flw {
+
+// Places new regular windows where they overlap the existing ones the least.
+//
+// Each monitor work area is divided into a kGridSize x kGridSize grid whose
+// cells count the regular windows covering them. Windows update their cells
+// as their geometry changes, so the index is never rebuilt. Placing a window
+// sums the grid once and scans it for the least covered block of the window's
+// size, which costs the same however many windows there are. Geometry is in
+// physical pixels. Only used on the platform thread.
+class WindowPlacement {
+public:
+  static constexpr int kGridSize{128};
+
+  static auto instance() -> WindowPlacement &;
+
+  // Indexes the current frame of |window| if it is a regular window. A
+  // minimized window lies outside its work area and covers no cells.
+  void Update(Win32Window const &window);
+  // Removes |window| from the index.
+  void Forget(Win32Window const &window);
+
+  // Returns the origin for a window of |size| on the monitor with |work_area|
+  // and |dpi|, placed as |placement| says. Placement::centered is up to the
+  // caller and falls back to Placement::automatic.
+  auto Place(RECT const &work_area, UINT dpi, SIZE size, Placement placement)
+      -> POINT;
+
+private:
+  struct Monitor {
+    RECT work_area;
+    // Row-major, kGridSize * kGridSize.
+    std::vector<uint16_t> coverage;
+    // The origin of the last window placed, where cascading continues from.
+    std::optional<POINT> last_placed;
+  };
+
+  // The cells a window covers on a monitor, as [left, right) x [top, bottom).
+  struct Entry {
+    size_t monitor;
+    RECT cells;
+  };
+
+  WindowPlacement() = default;
+
+  auto FindMonitor(RECT const &work_area) -> size_t;
+  void Cover(Entry const &entry, int delta);
+  auto Tile(Monitor const &monitor, SIZE size) const
+      -> std::pair<POINT, uint32_t>;
+  auto Cascade(Monitor const &monitor, UINT dpi, SIZE size) const -> POINT;
+
+  // Monitors are few; looked up by work area.
+  std::vector<Monitor> monitors_;
+  std::unordered_map<Win32Window const *, Entry> entries_;
+};
+
+} // namespace flw
+
+#endif // RUNNER_WINDOW_PLACEMENT_H_
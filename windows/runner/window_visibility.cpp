@@ -0,0 +1,47 @@
+#include "window_visibility.h"
+
+namespace flw {
+
+bool VisibilityTracker::SetMinimized(bool minimized, Clock::time_point now) {
+  minimized_ = minimized;
+  return Update(now);
+}
+
+bool VisibilityTracker::SetCloaked(bool cloaked, Clock::time_point now) {
+  cloaked_ = cloaked;
+  return Update(now);
+}
+
+bool VisibilityTracker::SetOccluded(bool occluded, Clock::time_point now) {
+  occluded_ = occluded;
+  return Update(now);
+}
+
+bool VisibilityTracker::ShouldReleaseSurface(Clock::duration grace_period,
+                                             Clock::time_point now) const {
+  return visibility_ != Visibility::visible && !surface_released_ &&
+         now - hidden_since_ >= grace_period;
+}
+
+bool VisibilityTracker::ShouldRestoreSurface() const {
+  return visibility_ == Visibility::visible && surface_released_;
+}
+
+bool VisibilityTracker::Update(Clock::time_point now) {
+  auto const visibility{minimized_  ? Visibility::minimized
+                        : cloaked_  ? Visibility::cloaked
+                        : occluded_ ? Visibility::occluded
+                                    : Visibility::visible};
+  if (visibility == visibility_) {
+    return false;
+  }
+  // The grace period runs from the moment the window stopped being visible,
+  // not from changes between hidden states.
+  if (visibility_ == Visibility::visible) {
+    hidden_since_ = now;
+  }
+  visibility_ = visibility;
+  return true;
+}
+
+} // namespace flw
@@ -0,0 +1,56 @@
+#ifndef RUNNER_WINDOW_VISIBILITY_H_
+#define RUNNER_WINDOW_VISIBILITY_H_
+
+#include <chrono>
+
+#include "windowing_types.h"
+
+namespace flw {
+
+// Platform-neutral visibility state machine of a window.
+//
+// The window feeds it whether it is minimized, cloaked (for example on another
+// virtual desktop) and fully occluded by other windows; the tracker derives a
+// single Visibility from those, reports when it changes, and tells when the
+// window has been hidden long enough for its surface to be released.
+class VisibilityTracker {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Each setter returns whether visibility() changed.
+  bool SetMinimized(bool minimized, Clock::time_point now);
+  bool SetCloaked(bool cloaked, Clock::time_point now);
+  bool SetOccluded(bool occluded, Clock::time_point now);
+
+  auto visibility() const -> Visibility { return visibility_; }
+
+  // Returns when the window was last hidden. Only meaningful while it is.
+  auto hidden_since() const -> Clock::time_point { return hidden_since_; }
+
+  // Returns whether the window has been hidden for at least |grace_period| and
+  // its surface is still allocated.
+  bool ShouldReleaseSurface(Clock::duration grace_period,
+                            Clock::time_point now) const;
+
+  // Returns whether the surface is released and the window is visible again,
+  // so the surface should be restored.
+  bool ShouldRestoreSurface() const;
+
+  void OnSurfaceReleased() { surface_released_ = true; }
+  void OnSurfaceRestored() { surface_released_ = false; }
+  bool surface_released() const { return surface_released_; }
+
+private:
+  bool Update(Clock::time_point now);
+
+  bool minimized_ = false;
+  bool cloaked_ = false;
+  bool occluded_ = false;
+  Visibility visibility_ = Visibility::visible;
+  Clock::time_point hidden_since_;
+  bool surface_released_ = false;
+};
+
+} // namespace flw
+
+#endif // RUNNER_WINDOW_VISIBILITY_H_
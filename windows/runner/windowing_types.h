@@ -14,6 +14,26 @@ enum class Archetype {
   tip
 };
 
+// Whether a window can be seen, from most to least hidden cause.
+enum class Visibility {
+  visible,
+  minimized,
+  cloaked,
+  occluded
+};
+
+// Where a new regular window is placed on its monitor.
+enum class Placement {
+  // Tiled into free space if there is any, cascaded otherwise.
+  automatic,
+  // Where it overlaps the fewest windows.
+  tile,
+  // Offset from the last window placed.
+  cascade,
+  // Centered on the main window.
+  centered
+};
+
 struct Size {
   int32_t width;
   int32_t height;